@@ -0,0 +1,39 @@
+# - Try to find libdeflate
+#.rst
+# FindLibdeflate
+# --------------
+#
+# Find the libdeflate include directory and library. Invoke as::
+#
+#   find_package(Libdeflate [REQUIRED])
+#
+# This module will define the following variables::
+#
+#  LIBDEFLATE_FOUND        - True if the header and library were found
+#  LIBDEFLATE_INCLUDE_DIRS - libdeflate include directories
+#  LIBDEFLATE_LIBRARIES    - libdeflate libraries to be linked
+
+find_package(PkgConfig QUIET)
+pkg_check_modules(PC_LIBDEFLATE QUIET libdeflate)
+
+find_path(LIBDEFLATE_INCLUDE_DIR
+  NAMES libdeflate.h
+  HINTS ${PC_LIBDEFLATE_INCLUDE_DIRS}
+)
+
+find_library(LIBDEFLATE_LIBRARY
+  NAMES deflate libdeflate
+  HINTS ${PC_LIBDEFLATE_LIBRARY_DIRS}
+)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(Libdeflate REQUIRED_VARS
+                                  LIBDEFLATE_LIBRARY
+                                  LIBDEFLATE_INCLUDE_DIR)
+
+if(LIBDEFLATE_FOUND)
+  set(LIBDEFLATE_INCLUDE_DIRS ${LIBDEFLATE_INCLUDE_DIR})
+  set(LIBDEFLATE_LIBRARIES ${LIBDEFLATE_LIBRARY})
+endif()
+
+mark_as_advanced(LIBDEFLATE_INCLUDE_DIR LIBDEFLATE_LIBRARY)
@@ -0,0 +1,174 @@
+/*
+ *  Bench.h
+ *  Minimal micro-benchmark harness for libwsc_bench
+ *
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * \brief One measured case: time per operation and throughput.
+ */
+struct BenchResult {
+    std::string suite;
+    std::string name;
+    size_t bytes = 0;          ///< payload bytes processed per operation
+    uint64_t iterations = 0;
+    double ns_per_op = 0.0;
+    double mb_per_s = 0.0;     ///< 0 when bytes == 0
+    std::vector<std::pair<std::string, double>> extra;   ///< suite-specific metrics, emitted as extra keys
+};
+
+/**
+ * \brief Collects results and prints them as a table (stderr) and JSON (stdout).
+ */
+class BenchReport {
+public:
+    explicit BenchReport(double min_seconds = 0.2) : min_time(min_seconds) {}
+
+    double minSeconds() const { return min_time; }
+
+    /// Describe the build or machine, e.g. the mask kernel; emitted under "context"
+    void setContext(const std::string& key, const std::string& value) {
+        for (auto& kv : context) {
+            if (kv.first == key) {
+                kv.second = value;
+                return;
+            }
+        }
+        context.emplace_back(key, value);
+    }
+
+    /// A suite's correctness check failed; libwsc_bench then exits non-zero
+    void fail(const std::string& what) {
+        fprintf(stderr, "FAILED: %s\n", what.c_str());
+        failures.push_back(what);
+    }
+
+    bool failed() const { return !failures.empty(); }
+
+    void add(const BenchResult& r) {
+        fprintf(stderr, "%-10s %-36s %10zu B %12.1f ns/op %10.1f MB/s",
+                r.suite.c_str(), r.name.c_str(), r.bytes, r.ns_per_op, r.mb_per_s);
+        for (const auto& kv : r.extra) fprintf(stderr, " %s=%.1f", kv.first.c_str(), kv.second);
+        fprintf(stderr, "\n");
+        results.push_back(r);
+    }
+
+    void printJson(FILE* out) const {
+        fprintf(out, "{\n  \"timestamp\": %lld,\n  \"min_time\": %.3f,\n  \"context\": {",
+                static_cast<long long>(std::time(nullptr)), min_time);
+        for (size_t i = 0; i < context.size(); ++i) {
+            fprintf(out, "%s\"%s\": \"%s\"", i ? ", " : "", context[i].first.c_str(), context[i].second.c_str());
+        }
+        fprintf(out, "},\n  \"failures\": [");
+        for (size_t i = 0; i < failures.size(); ++i) {
+            fprintf(out, "%s\"%s\"", i ? ", " : "", failures[i].c_str());
+        }
+        fprintf(out, "],\n  \"results\": [\n");
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchResult& r = results[i];
+            fprintf(out,
+                    "    {\"suite\": \"%s\", \"name\": \"%s\", \"bytes\": %zu, "
+                    "\"iterations\": %llu, \"ns_per_op\": %.2f, \"mb_per_s\": %.2f",
+                    r.suite.c_str(), r.name.c_str(), r.bytes,
+                    static_cast<unsigned long long>(r.iterations),
+                    r.ns_per_op, r.mb_per_s);
+            for (const auto& kv : r.extra) fprintf(out, ", \"%s\": %.2f", kv.first.c_str(), kv.second);
+            fprintf(out, "}%s\n", (i + 1 < results.size()) ? "," : "");
+        }
+        fprintf(out, "  ]\n}\n");
+    }
+
+private:
+    double min_time;
+    std::vector<std::pair<std::string, std::string>> context;
+    std::vector<BenchResult> results;
+    std::vector<std::string> failures;
+};
+
+/**
+ * \brief Keep the optimizer from discarding a computed buffer.
+ */
+inline void benchClobber(const void* p) {
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(p) : "memory");
+#else
+    static const void* volatile sink;
+    sink = p;
+#endif
+}
+
+/**
+ * \brief Chat/market-data style JSON: small keys, repeated structure, varying numbers.
+ */
+inline std::vector<uint8_t> benchJson(size_t len, std::mt19937& rng) {
+    std::string s;
+    while (s.size() < len) {
+        s += "{\"type\":\"trade\",\"symbol\":\"BTC-USD\",\"price\":" + std::to_string(rng() % 100000) +
+             "." + std::to_string(rng() % 100) + ",\"size\":" + std::to_string(rng() % 1000) +
+             ",\"side\":\"" + (rng() & 1 ? "buy" : "sell") + "\",\"ts\":" + std::to_string(1700000000000ull + rng()) + "}\n";
+    }
+    s.resize(len);
+    return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+/**
+ * \brief Run fn repeatedly for at least min_seconds and report ns/op.
+ */
+template <typename Fn>
+BenchResult benchRun(BenchReport& report, const std::string& suite, const std::string& name,
+                     size_t bytes, Fn fn) {
+    using clock = std::chrono::steady_clock;
+
+    // Warm-up and calibration
+    uint64_t batch = 1;
+    for (;;) {
+        auto t0 = clock::now();
+        for (uint64_t i = 0; i < batch; ++i) fn();
+        double sec = std::chrono::duration<double>(clock::now() - t0).count();
+        if (sec > 0.01 || batch >= (1ull << 30)) break;
+        batch *= 2;
+    }
+
+    uint64_t iters = 0;
+    auto t0 = clock::now();
+    double sec = 0.0;
+    do {
+        for (uint64_t i = 0; i < batch; ++i) fn();
+        iters += batch;
+        sec = std::chrono::duration<double>(clock::now() - t0).count();
+    } while (sec < report.minSeconds());
+
+    BenchResult r;
+    r.suite = suite;
+    r.name = name;
+    r.bytes = bytes;
+    r.iterations = iters;
+    r.ns_per_op = sec * 1e9 / static_cast<double>(iters);
+    r.mb_per_s = bytes ? (static_cast<double>(bytes) * iters / sec) / (1024.0 * 1024.0) : 0.0;
+    report.add(r);
+    return r;
+}
+
+// Suites
+void benchMask(BenchReport& report);
+void benchUtf8(BenchReport& report);
+void benchCodec(BenchReport& report);
+void benchFrame(BenchReport& report);
+void benchParse(BenchReport& report);
+void benchDeflate(BenchReport& report);
+void benchHandshake(BenchReport& report);
+void benchEcho(BenchReport& report);
+void benchTimer(BenchReport& report);
@@ -0,0 +1,79 @@
+/*
+ *  bench_codec.cpp
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "Bench.h"
+#include "DeflateCodec.h"
+
+#include <random>
+
+namespace {
+
+// Already-compressed / encrypted payloads
+std::vector<uint8_t> makeRandom(size_t len, std::mt19937& rng) {
+    std::vector<uint8_t> v(len);
+    for (auto& b : v) b = static_cast<uint8_t>(rng());
+    return v;
+}
+
+} // namespace
+
+void benchCodec(BenchReport& report) {
+    const size_t sizes[] = { 1024, 64 * 1024, 1 << 20 };
+
+    DeflateCodecParams params;   // zlib level 6, 15-bit windows
+    std::vector<DeflateCodec::Backend> backends = { DeflateCodec::Backend::ZLIB };
+    if (DeflateCodec::compiledBackend() != DeflateCodec::Backend::ZLIB) {
+        backends.push_back(DeflateCodec::compiledBackend());
+    }
+
+    // zlib decodes everything the other backends produce, and vice versa
+    std::unique_ptr<DeflateCodec> reference = DeflateCodec::create(DeflateCodec::Backend::ZLIB, params);
+    if (!reference) {
+        fprintf(stderr, "codec: zlib codec unavailable\n");
+        return;
+    }
+
+    std::mt19937 rng(42);
+
+    for (DeflateCodec::Backend b : backends) {
+        std::unique_ptr<DeflateCodec> codec = DeflateCodec::create(b, params);
+        const char* name = DeflateCodec::backendName(b);
+        if (!codec) {
+            fprintf(stderr, "codec: %s unavailable\n", name);
+            continue;
+        }
+
+        for (int kind = 0; kind < 2; ++kind) {
+            const char* kind_name = kind ? "random" : "json";
+            for (size_t len : sizes) {
+                const std::vector<uint8_t> src = kind ? makeRandom(len, rng) : benchJson(len, rng);
+
+                std::vector<uint8_t> packed, ref_packed, unpacked;
+                size_t packed_len = 0, ref_len = 0;
+                if (!codec->compress(src.data(), src.size(), packed, packed_len) ||
+                    !reference->decompress(packed.data(), packed_len, unpacked) || unpacked != src ||
+                    !reference->compress(src.data(), src.size(), ref_packed, ref_len) ||
+                    !codec->decompress(ref_packed.data(), ref_len, unpacked) || unpacked != src) {
+                    fprintf(stderr, "codec: %s round trip failed (%s, %zu bytes)\n", name, kind_name, len);
+                    return;
+                }
+
+                const std::string id = std::string(name) + "/" + kind_name + "/" + std::to_string(len);
+                fprintf(stderr, "# %s ratio %.3f\n", id.c_str(), static_cast<double>(packed_len) / len);
+
+                benchRun(report, "codec", "deflate/" + id, len, [&]() {
+                    codec->compress(src.data(), src.size(), packed, packed_len);
+                    benchClobber(packed.data());
+                });
+                codec->compress(src.data(), src.size(), packed, packed_len);
+                benchRun(report, "codec", "inflate/" + id, len, [&]() {
+                    codec->decompress(packed.data(), packed_len, unpacked);
+                    benchClobber(unpacked.data());
+                });
+            }
+        }
+    }
+}
@@ -0,0 +1,425 @@
+/*
+ *  bench_echo.cpp
+ *  End-to-end messages/sec and round-trip latency against an in-process
+ *  echo server over loopback TCP.
+ *
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "Bench.h"
+#include "WebSocketClient.h"
+#include "WebSocketEventLoopPool.h"
+#include "WebSocketMask.h"
+#include "base64.h"
+#include "sha1.hpp"
+
+#include <event2/buffer.h>
+#include <event2/bufferevent.h>
+#include <event2/event.h>
+#include <event2/listener.h>
+#include <event2/thread.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+
+namespace {
+
+uint64_t nowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/**
+ * \brief Minimal RFC 6455 echo server: one thread, no extensions.
+ *
+ * Data frames go back unmasked with the same opcode, pings are answered
+ * and a close is echoed before the connection is dropped.
+ */
+class EchoServer {
+public:
+    ~EchoServer() { stop(); }
+
+    bool start() {
+        evthread_use_pthreads();
+        base = event_base_new();
+        if (!base) return false;
+
+        sockaddr_in sin;
+        std::memset(&sin, 0, sizeof(sin));
+        sin.sin_family = AF_INET;
+        sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        listener = evconnlistener_new_bind(base, &EchoServer::acceptCallback, this,
+                                           LEV_OPT_CLOSE_ON_FREE | LEV_OPT_REUSEABLE, 4096,
+                                           reinterpret_cast<sockaddr*>(&sin), sizeof(sin));
+        if (!listener) return false;
+
+        socklen_t len = sizeof(sin);
+        getsockname(evconnlistener_get_fd(listener), reinterpret_cast<sockaddr*>(&sin), &len);
+        listen_port = ntohs(sin.sin_port);
+
+        thread = std::thread([this]() { event_base_loop(base, EVLOOP_NO_EXIT_ON_EMPTY); });
+        return true;
+    }
+
+    void stop() {
+        if (thread.joinable()) {
+            event_base_loopbreak(base);
+            thread.join();
+        }
+        for (Peer* p : peers) {
+            bufferevent_free(p->bev);
+            delete p;
+        }
+        peers.clear();
+        if (listener) evconnlistener_free(listener);
+        if (base) event_base_free(base);
+        listener = nullptr;
+        base = nullptr;
+    }
+
+    unsigned short port() const { return listen_port; }
+
+private:
+    struct Peer {
+        EchoServer* server;
+        bufferevent* bev;
+        bool upgraded = false;
+        std::vector<uint8_t> scratch;
+    };
+
+    static void acceptCallback(evconnlistener*, evutil_socket_t fd, sockaddr*, int, void* arg) {
+        EchoServer* self = static_cast<EchoServer*>(arg);
+        const int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        bufferevent* bev = bufferevent_socket_new(self->base, fd, BEV_OPT_CLOSE_ON_FREE);
+        if (!bev) {
+            evutil_closesocket(fd);
+            return;
+        }
+        Peer* p = new Peer;
+        p->server = self;
+        p->bev = bev;
+        self->peers.insert(p);
+        bufferevent_setcb(bev, &EchoServer::readCallback, nullptr, &EchoServer::eventCallback, p);
+        bufferevent_enable(bev, EV_READ | EV_WRITE);
+    }
+
+    static void drop(Peer* p) {
+        p->server->peers.erase(p);
+        bufferevent_free(p->bev);
+        delete p;
+    }
+
+    static void eventCallback(bufferevent*, short events, void* arg) {
+        if (events & (BEV_EVENT_EOF | BEV_EVENT_ERROR)) drop(static_cast<Peer*>(arg));
+    }
+
+    // Close echoed: drop the connection once it has been written
+    static void closeWrittenCallback(bufferevent* bev, void* arg) {
+        if (evbuffer_get_length(bufferevent_get_output(bev)) == 0) drop(static_cast<Peer*>(arg));
+    }
+
+    static void readCallback(bufferevent* bev, void* arg) {
+        Peer* p = static_cast<Peer*>(arg);
+        evbuffer* in = bufferevent_get_input(bev);
+        evbuffer* out = bufferevent_get_output(bev);
+
+        if (!p->upgraded && !upgrade(p, in, out)) return;
+
+        for (;;) {
+            const size_t avail = evbuffer_get_length(in);
+            if (avail < 2) return;
+
+            uint8_t hdr[14];
+            evbuffer_copyout(in, hdr, std::min(avail, sizeof(hdr)));
+            const int opcode = hdr[0] & 0x0F;
+            uint64_t len = hdr[1] & 0x7F;
+            size_t hlen = 2;
+            if (len == 126) {
+                if (avail < 4) return;
+                len = (static_cast<uint64_t>(hdr[2]) << 8) | hdr[3];
+                hlen = 4;
+            } else if (len == 127) {
+                if (avail < 10) return;
+                len = 0;
+                for (int i = 0; i < 8; ++i) len = (len << 8) | hdr[2 + i];
+                hlen = 10;
+            }
+            if (!(hdr[1] & 0x80)) {   // clients must mask
+                drop(p);
+                return;
+            }
+            const size_t need = hlen + 4 + static_cast<size_t>(len);
+            if (avail < need) return;
+
+            const uint8_t* frame = evbuffer_pullup(in, static_cast<ev_ssize_t>(need));
+            p->scratch.resize(static_cast<size_t>(len));
+            WebSocketMask::apply(p->scratch.data(), frame + hlen + 4, static_cast<size_t>(len), frame + hlen);
+
+            uint8_t reply = hdr[0];
+            if (opcode == 0x09) reply = static_cast<uint8_t>((hdr[0] & 0xF0) | 0x0A);
+
+            if (opcode != 0x0A) {
+                uint8_t rh[10];
+                size_t rlen = 2;
+                rh[0] = reply;
+                if (len < 126) {
+                    rh[1] = static_cast<uint8_t>(len);
+                } else if (len <= 0xFFFF) {
+                    rh[1] = 126;
+                    rh[2] = static_cast<uint8_t>(len >> 8);
+                    rh[3] = static_cast<uint8_t>(len);
+                    rlen = 4;
+                } else {
+                    rh[1] = 127;
+                    for (int i = 0; i < 8; ++i) rh[2 + i] = static_cast<uint8_t>(len >> (56 - 8 * i));
+                    rlen = 10;
+                }
+                evbuffer_add(out, rh, rlen);
+                evbuffer_add(out, p->scratch.data(), p->scratch.size());
+            }
+            evbuffer_drain(in, need);
+
+            if (opcode == 0x08) {
+                bufferevent_disable(bev, EV_READ);
+                bufferevent_setcb(bev, nullptr, &EchoServer::closeWrittenCallback, &EchoServer::eventCallback, p);
+                return;
+            }
+        }
+    }
+
+    static bool upgrade(Peer* p, evbuffer* in, evbuffer* out) {
+        evbuffer_ptr end = evbuffer_search(in, "\r\n\r\n", 4, nullptr);
+        if (end.pos < 0) {
+            if (evbuffer_get_length(in) > 16 * 1024) drop(p);
+            return false;
+        }
+        const size_t hlen = static_cast<size_t>(end.pos) + 4;
+        const std::string req(reinterpret_cast<const char*>(evbuffer_pullup(in, static_cast<ev_ssize_t>(hlen))), hlen);
+        evbuffer_drain(in, hlen);
+
+        std::string lower(req);
+        std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        const size_t k = lower.find("\r\nsec-websocket-key:");
+        if (k == std::string::npos) {
+            drop(p);
+            return false;
+        }
+        size_t b = k + std::strlen("\r\nsec-websocket-key:");
+        while (b < req.size() && req[b] == ' ') ++b;
+        const std::string key = req.substr(b, req.find("\r\n", b) - b);
+
+        SHA1 sha;
+        sha.update(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11");
+        const std::string hex = sha.final();
+        unsigned char digest[20];
+        for (size_t i = 0; i < 20; ++i) digest[i] = static_cast<unsigned char>(std::stoi(hex.substr(2 * i, 2), nullptr, 16));
+
+        const std::string resp = "HTTP/1.1 101 Switching Protocols\r\n"
+                                 "Upgrade: websocket\r\n"
+                                 "Connection: Upgrade\r\n"
+                                 "Sec-WebSocket-Accept: " + base64_encode(digest, sizeof(digest)) + "\r\n\r\n";
+        evbuffer_add(out, resp.data(), resp.size());
+        p->upgraded = true;
+        return true;
+    }
+
+    event_base* base = nullptr;
+    evconnlistener* listener = nullptr;
+    std::thread thread;
+    unsigned short listen_port = 0;
+    std::unordered_set<Peer*> peers;   // loop thread only, until stop()
+};
+
+/**
+ * \brief One client that keeps `depth` messages in flight, each stamped
+ * with its send time and answered by sending the next.
+ */
+struct EchoConn {
+    std::unique_ptr<WebSocketClient> client;
+    std::vector<uint8_t> payload;
+    std::vector<uint64_t> samples;   // round trips in ns, event thread only
+};
+
+struct EchoShared {
+    std::atomic<size_t> opened{0};
+    std::atomic<size_t> failed{0};
+    std::atomic<size_t> in_flight{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> measure_from{UINT64_MAX};
+    std::atomic<uint64_t> measure_until{UINT64_MAX};
+    std::atomic<bool> stopping{false};
+};
+
+bool sendStamped(EchoConn& c, EchoShared& sh) {
+    const uint64_t t = nowNs();
+    std::memcpy(c.payload.data(), &t, sizeof(t));
+    if (c.client->sendBinary(c.payload.data(), c.payload.size())) return true;
+    sh.rejected.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void runEcho(BenchReport& report, unsigned short port, size_t conns, size_t depth, size_t msg_size,
+             const std::shared_ptr<WebSocketEventLoopPool>& pool) {
+    EchoShared sh;
+    std::vector<std::unique_ptr<EchoConn>> all;
+    all.reserve(conns);
+
+    const std::string url = "ws://127.0.0.1:" + std::to_string(port) + "/";
+    const uint64_t connect_start = nowNs();
+
+    for (size_t i = 0; i < conns; ++i) {
+        std::unique_ptr<EchoConn> c(new EchoConn);
+        EchoConn* cp = c.get();
+        cp->payload.assign(std::max<size_t>(msg_size, sizeof(uint64_t)), 'e');
+        cp->client.reset(new WebSocketClient);
+        cp->client->setUrl(url);
+        cp->client->enableCompression(false);
+        cp->client->setEventLoopPool(pool);
+        cp->client->setOpenCallback([&sh]() { sh.opened.fetch_add(1); });
+        cp->client->setErrorCallback([&sh](int, const std::string&) { sh.failed.fetch_add(1); });
+        cp->client->setConnectionTimeout(30);   // thousands of handshakes queue up behind each other
+        cp->client->setBinaryCallback([cp, &sh](const void* data, size_t len) {
+            const uint64_t now = nowNs();
+            uint64_t sent = 0;
+            if (len >= sizeof(sent)) std::memcpy(&sent, data, sizeof(sent));
+            if (sent >= sh.measure_from.load(std::memory_order_relaxed) &&
+                now < sh.measure_until.load(std::memory_order_relaxed)) {
+                cp->samples.push_back(now - sent);
+            }
+            if (sh.stopping.load(std::memory_order_relaxed) || !sendStamped(*cp, sh)) {
+                sh.in_flight.fetch_sub(1);
+            }
+        });
+        all.push_back(std::move(c));
+    }
+    for (auto& c : all) c->client->connect();
+
+    const uint64_t connect_deadline = connect_start + 60ull * 1000000000ull;
+    while (sh.opened.load() + sh.failed.load() < conns && nowNs() < connect_deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const double connect_ms = static_cast<double>(nowNs() - connect_start) / 1e6;
+    const std::string id = std::to_string(conns) + "conn/" + std::to_string(depth) + "deep/" + std::to_string(msg_size);
+
+    if (sh.opened.load() != conns) {
+        fprintf(stderr, "echo: %s: only %zu of %zu connections opened (%zu errors)\n", id.c_str(),
+                sh.opened.load(), conns, sh.failed.load());
+    } else {
+        // Warm up for a fifth of the run, then measure
+        const double seconds = std::max(1.0, report.minSeconds() * 5);
+        const uint64_t start = nowNs();
+        sh.measure_from.store(start + static_cast<uint64_t>(seconds * 0.2e9));
+        sh.measure_until.store(start + static_cast<uint64_t>(seconds * 1.2e9));
+
+        for (auto& c : all) {
+            for (size_t d = 0; d < depth; ++d) {
+                sh.in_flight.fetch_add(1);
+                if (!sendStamped(*c, sh)) sh.in_flight.fetch_sub(1);
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::nanoseconds(sh.measure_until.load() - start));
+        sh.stopping.store(true);
+
+        const uint64_t drain_deadline = nowNs() + 5ull * 1000000000ull;
+        while (sh.in_flight.load() > 0 && nowNs() < drain_deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    for (auto& c : all) c->client->disconnect();
+    std::vector<uint64_t> samples;
+    for (auto& c : all) {
+        c->client.reset();
+        samples.insert(samples.end(), c->samples.begin(), c->samples.end());
+    }
+    if (sh.opened.load() != conns) return;
+    if (samples.empty()) {
+        fprintf(stderr, "echo: %s: no messages came back\n", id.c_str());
+        return;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    auto pct = [&](double q) {
+        const size_t i = std::min(samples.size() - 1, static_cast<size_t>(q * static_cast<double>(samples.size())));
+        return static_cast<double>(samples[i]) / 1e3;
+    };
+    double sum = 0.0;
+    for (uint64_t s : samples) sum += static_cast<double>(s);
+
+    const double window = static_cast<double>(sh.measure_until.load() - sh.measure_from.load()) / 1e9;
+    const double rate = static_cast<double>(samples.size()) / window;
+
+    BenchResult r;
+    r.suite = "echo";
+    r.name = id;
+    r.bytes = msg_size;
+    r.iterations = samples.size();
+    r.ns_per_op = 1e9 / rate;
+    r.mb_per_s = rate * static_cast<double>(msg_size) / (1024.0 * 1024.0);
+    r.extra.emplace_back("connections", static_cast<double>(conns));
+    r.extra.emplace_back("msgs_per_s", rate);
+    r.extra.emplace_back("p50_us", pct(0.50));
+    r.extra.emplace_back("p99_us", pct(0.99));
+    r.extra.emplace_back("p999_us", pct(0.999));
+    r.extra.emplace_back("max_us", static_cast<double>(samples.back()) / 1e3);
+    r.extra.emplace_back("mean_us", sum / static_cast<double>(samples.size()) / 1e3);
+    r.extra.emplace_back("connect_ms", connect_ms);
+    r.extra.emplace_back("rejected", static_cast<double>(sh.rejected.load()));
+    report.add(r);
+}
+
+// Every connection costs two descriptors here, one per side
+size_t maxConnections() {
+    rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) != 0) return 500;
+    if (rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+        getrlimit(RLIMIT_NOFILE, &rl);
+    }
+    return rl.rlim_cur > 256 ? static_cast<size_t>((rl.rlim_cur - 128) / 2) : 64;
+}
+
+} // namespace
+
+void benchEcho(BenchReport& report) {
+    EchoServer server;
+    if (!server.start()) {
+        fprintf(stderr, "echo: cannot start the loopback server\n");
+        return;
+    }
+
+    // Leave a core to the server thread
+    const unsigned hw = std::thread::hardware_concurrency();
+    auto pool = std::make_shared<WebSocketEventLoopPool>(std::max(1u, hw / 2));
+    fprintf(stderr, "# echo: server on 127.0.0.1:%u, %zu client loops\n", server.port(), pool->size());
+
+    struct Case { size_t conns; size_t depth; size_t size; };
+    const Case cases[] = {
+        { 1, 1, 64 },
+        { 1, 64, 64 },
+        { 1, 1, 16 * 1024 },
+        { 100, 1, 64 },
+        { 10000, 1, 64 },
+    };
+
+    const size_t limit = maxConnections();
+    for (const Case& c : cases) {
+        size_t conns = c.conns;
+        if (conns > limit) {
+            fprintf(stderr, "# echo: descriptor limit allows %zu connections, not %zu\n", limit, conns);
+            conns = limit;
+        }
+        runEcho(report, server.port(), conns, c.depth, c.size, pool);
+    }
+}
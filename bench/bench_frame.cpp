@@ -0,0 +1,68 @@
+/*
+ *  bench_frame.cpp
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "Bench.h"
+#include "WebSocketFrame.h"
+
+#include <event2/buffer.h>
+
+// The framing half of WebSocketContext::send(): fresh mask key, header and
+// masked payload written into the output evbuffer. Draining stands in for
+// the socket write.
+void benchFrame(BenchReport& report) {
+    const size_t sizes[] = { 16, 125, 4096, 64 * 1024, 1 << 20 };
+    const uint8_t b1 = 0x80 | 0x02;   // FIN, binary
+
+    evbuffer* out = evbuffer_new();
+    if (!out) {
+        fprintf(stderr, "frame: evbuffer_new failed\n");
+        return;
+    }
+
+    for (size_t len : sizes) {
+        std::vector<uint8_t> payload(len);
+        for (size_t i = 0; i < len; ++i) payload[i] = static_cast<uint8_t>(i * 131u + 7u);
+
+        benchRun(report, "frame", "append/" + std::to_string(len), len, [&]() {
+            uint8_t key[4];
+            WebSocketFrame::nextMaskKey(key);
+            WebSocketFrame::append(out, b1, payload.data(), len, key);
+            evbuffer_drain(out, evbuffer_get_length(out));
+        });
+    }
+
+    // A burst of small messages, as flushed from the send queue or sendBatch()
+    const size_t burst_sizes[] = { 16, 256 };
+    const size_t burst = 64;
+    for (size_t len : burst_sizes) {
+        std::vector<uint8_t> payload(len, 'x');
+        const size_t hint = burst * (WebSocketFrame::headerSize(len) + len);
+        const std::string id = std::to_string(len) + "x" + std::to_string(burst);
+
+        benchRun(report, "frame", "append/" + id, len * burst, [&]() {
+            for (size_t i = 0; i < burst; ++i) {
+                uint8_t key[4];
+                WebSocketFrame::nextMaskKey(key);
+                WebSocketFrame::append(out, b1, payload.data(), len, key);
+            }
+            evbuffer_drain(out, evbuffer_get_length(out));
+        });
+        benchRun(report, "frame", "writer/" + id, len * burst, [&]() {
+            {
+                WebSocketFrameWriter writer(out, hint);
+                for (size_t i = 0; i < burst; ++i) {
+                    uint8_t key[4];
+                    WebSocketFrame::nextMaskKey(key);
+                    writer.add(b1, payload.data(), len, key);
+                }
+                writer.commit();
+            }
+            evbuffer_drain(out, evbuffer_get_length(out));
+        });
+    }
+
+    evbuffer_free(out);
+}
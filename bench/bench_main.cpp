@@ -0,0 +1,70 @@
+/*
+ *  bench_main.cpp
+ *  libwsc micro-benchmarks
+ *
+ *  Usage: libwsc_bench [--min-time <seconds>] [suite ...]
+ *  Human-readable results go to stderr, JSON to stdout, e.g.
+ *  libwsc_bench > results-$(git describe).json
+ *  Exits non-zero if a suite's correctness check fails.
+ *  Suites: mask utf8 codec frame parse deflate handshake echo timer
+ *
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "Bench.h"
+#include "DeflateCodec.h"
+#include "Utf8Validator.h"
+#include "WebSocketMask.h"
+
+#include <cstdlib>
+#include <cstring>
+
+struct BenchSuite {
+    const char* name;
+    void (*run)(BenchReport&);
+};
+
+static const BenchSuite suites[] = {
+    { "mask", &benchMask },
+    { "utf8", &benchUtf8 },
+    { "codec", &benchCodec },
+    { "frame", &benchFrame },
+    { "parse", &benchParse },
+    { "deflate", &benchDeflate },
+    { "handshake", &benchHandshake },
+    { "echo", &benchEcho },
+    { "timer", &benchTimer },
+};
+
+int main(int argc, char** argv) {
+    double min_time = 0.2;
+    std::vector<std::string> selected;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            min_time = std::atof(argv[++i]);
+        } else {
+            selected.push_back(argv[i]);
+        }
+    }
+
+    BenchReport report(min_time);
+#ifdef LIBWSC_VERSION
+    report.setContext("version", LIBWSC_VERSION);
+#endif
+    report.setContext("mask", WebSocketMask::implementation());
+    report.setContext("utf8", Utf8Validator::implementation());
+    report.setContext("deflate_backend", DeflateCodec::backendName(DeflateCodec::compiledBackend()));
+
+    for (const BenchSuite& s : suites) {
+        bool run = selected.empty();
+        for (const std::string& name : selected) {
+            if (name == s.name) run = true;
+        }
+        if (run) s.run(report);
+    }
+
+    report.printJson(stdout);
+    return report.failed() ? 1 : 0;
+}
@@ -0,0 +1,45 @@
+/*
+ *  bench_mask.cpp
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "Bench.h"
+#include "WebSocketMask.h"
+
+#include <cstring>
+
+void benchMask(BenchReport& report) {
+    const uint8_t key[4] = { 0x37, 0xfa, 0x21, 0x3d };
+    const size_t sizes[] = { 64, 4096, 1 << 20 };
+
+    fprintf(stderr, "# mask kernel: %s\n", WebSocketMask::implementation());
+
+    for (size_t len : sizes) {
+        std::vector<uint8_t> src(len), a(len), b(len);
+        for (size_t i = 0; i < len; ++i) src[i] = static_cast<uint8_t>(i * 131u + 7u);
+
+        // Sanity: every kernel must match the reference loop
+        WebSocketMask::applyBytewise(a.data(), src.data(), len, key);
+        WebSocketMask::apply(b.data(), src.data(), len, key);
+        if (a != b) {
+            fprintf(stderr, "mask: kernel mismatch at %zu bytes\n", len);
+            return;
+        }
+
+        const std::string sz = std::to_string(len);
+
+        benchRun(report, "mask", "bytewise/" + sz, len, [&]() {
+            WebSocketMask::applyBytewise(a.data(), src.data(), len, key);
+            benchClobber(a.data());
+        });
+        benchRun(report, "mask", "scalar64/" + sz, len, [&]() {
+            WebSocketMask::applyScalar(a.data(), src.data(), len, key);
+            benchClobber(a.data());
+        });
+        benchRun(report, "mask", std::string(WebSocketMask::implementation()) + "/" + sz, len, [&]() {
+            WebSocketMask::apply(a.data(), src.data(), len, key);
+            benchClobber(a.data());
+        });
+    }
+}
@@ -0,0 +1,310 @@
+/*
+ *  bench_receiver.cpp
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "Bench.h"
+#include "WebSocketReceiver.h"
+
+#include <event2/buffer.h>
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+namespace {
+
+// Counts deliveries and records protocol errors instead of closing anything
+struct BenchSinks : IWebSocketSinks {
+    bool compression = false;
+    bool chunks = false;
+    bool buffers = false;
+    uint64_t messages = 0;
+    uint64_t bytes = 0;
+    uint64_t errors = 0;
+
+    bool rxCompressionEnabled() const override { return compression; }
+    void onRxPong(std::vector<uint8_t>&&) override {}
+    void onRxPing(std::vector<uint8_t>&&) override {}
+    void onRxClose(uint16_t, std::string&&) override {}
+    void onRxProtocolError(uint16_t, std::string&&) override { ++errors; }
+    void onRxText(const uint8_t* data, size_t len) override { deliver(data, len); }
+    void onRxBinary(const uint8_t* data, size_t len) override { deliver(data, len); }
+    bool rxStreamChunks() const override { return chunks; }
+    void onRxChunk(const uint8_t* data, size_t len, bool, bool final) override {
+        bytes += len;
+        benchClobber(data);
+        if (final) ++messages;
+    }
+    bool rxTakesBuffers() const override { return buffers; }
+    void onRxBuffer(WebSocketBuffer&& buffer, bool) override {
+        deliver(buffer.data(), buffer.size());
+        buffer.release();
+    }
+    bool rxIsTerminating() const override { return false; }
+
+    void deliver(const uint8_t* data, size_t len) {
+        ++messages;
+        bytes += len;
+        benchClobber(data);
+    }
+};
+
+// Unmasked server frame
+void appendServerFrame(std::vector<uint8_t>& out, uint8_t b1, const uint8_t* payload, size_t len) {
+    out.push_back(b1);
+    if (len < 126) {
+        out.push_back(static_cast<uint8_t>(len));
+    } else if (len <= 0xFFFF) {
+        out.push_back(126);
+        const uint16_t n = htons(static_cast<uint16_t>(len));
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&n);
+        out.insert(out.end(), p, p + sizeof(n));
+    } else {
+        out.push_back(127);
+        const uint64_t n = htonll(static_cast<uint64_t>(len));
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&n);
+        out.insert(out.end(), p, p + sizeof(n));
+    }
+    out.insert(out.end(), payload, payload + len);
+}
+
+// permessage-deflate payload as a peer without context takeover would send it
+std::vector<uint8_t> deflatePayload(const std::vector<uint8_t>& src) {
+    BenchSinks sinks;
+    WebSocketReceiver peer(sinks);
+    PerMessageDeflateConfig cfg;
+    cfg.enabled = true;
+    cfg.client_no_context_takeover = true;
+    if (!peer.initializeCompression(cfg)) return std::vector<uint8_t>();
+
+    const uint8_t* p = nullptr;
+    size_t n = 0;
+    bool compressed = false;
+    peer.txPrepare(src.data(), src.size(), true, p, n, compressed);
+    if (!compressed) return std::vector<uint8_t>();
+    return std::vector<uint8_t>(p, p + n);
+}
+
+struct ParseCase {
+    std::string name;
+    std::vector<uint8_t> wire;
+    size_t payload_bytes;
+    size_t messages;
+    bool compressed;
+    bool chunks;
+    bool buffers;
+    size_t segment;   // wire added in pieces of this size (0: one piece)
+};
+
+ParseCase makeCase(const std::string& name, uint8_t opcode, const std::vector<uint8_t>& payload,
+                   size_t count, size_t fragments = 1) {
+    ParseCase c;
+    c.name = name;
+    c.payload_bytes = payload.size() * count;
+    c.messages = count;
+    c.compressed = false;
+    c.chunks = false;
+    c.buffers = false;
+    c.segment = 0;
+
+    const size_t step = (payload.size() + fragments - 1) / fragments;
+    for (size_t m = 0; m < count; ++m) {
+        for (size_t off = 0, f = 0; f < fragments; ++f, off += step) {
+            const size_t n = std::min(step, payload.size() - off);
+            const bool last = (f + 1 == fragments);
+            const uint8_t b1 = static_cast<uint8_t>((last ? 0x80 : 0x00) | (f == 0 ? opcode : 0x00));
+            appendServerFrame(c.wire, b1, payload.data() + off, n);
+        }
+    }
+    return c;
+}
+
+} // namespace
+
+// WebSocketReceiver::onData over a synthetic input buffer holding complete
+// frames. The wire bytes are added by reference, so the numbers cover header
+// parsing, pullup, UTF-8 validation and delivery but not a memcpy of the input.
+void benchParse(BenchReport& report) {
+    std::mt19937 rng(7);
+    std::vector<ParseCase> cases;
+
+    const std::vector<uint8_t> json16 = benchJson(16, rng);
+    const std::vector<uint8_t> json4k = benchJson(4096, rng);
+    const std::vector<uint8_t> json64k = benchJson(64 * 1024, rng);
+    std::vector<uint8_t> blob(1 << 20);
+    for (auto& b : blob) b = static_cast<uint8_t>(rng());
+
+    cases.push_back(makeCase("text/16x256", 0x01, json16, 256));
+    cases.push_back(makeCase("binary/125x256", 0x02, std::vector<uint8_t>(125, 0xA5), 256));
+    cases.push_back(makeCase("text/4096x16", 0x01, json4k, 16));
+    cases.push_back(makeCase("binary/4096x16", 0x02, std::vector<uint8_t>(blob.begin(), blob.begin() + 4096), 16));
+    cases.push_back(makeCase("text/65536", 0x01, json64k, 1));
+    cases.push_back(makeCase("binary/1048576", 0x02, blob, 1));
+    cases.push_back(makeCase("text/65536x4frag", 0x01, json64k, 1, 4));
+
+    ParseCase streamed = makeCase("text/65536x4frag/chunks", 0x01, json64k, 1, 4);
+    streamed.chunks = true;
+    cases.push_back(streamed);
+
+    // As read off a socket: the frame spans many evbuffer chains
+    ParseCase chained = makeCase("binary/1048576/chained", 0x02, blob, 1);
+    chained.segment = 16 * 1024;
+    cases.push_back(chained);
+    chained.name += "/chunks";
+    chained.chunks = true;
+    cases.push_back(chained);
+
+    ParseCase chainedText = makeCase("text/65536/chained", 0x01, json64k, 1);
+    chainedText.segment = 4096;
+    cases.push_back(chainedText);
+
+    ParseCase owned = makeCase("text/65536x4frag/buffers", 0x01, json64k, 1, 4);
+    owned.buffers = true;
+    cases.push_back(owned);
+
+    const std::vector<uint8_t> packed = deflatePayload(json4k);
+    if (!packed.empty()) {
+        ParseCase c;
+        c.name = "deflate/text/4096x16";
+        c.payload_bytes = json4k.size() * 16;
+        c.messages = 16;
+        c.compressed = true;
+        c.chunks = false;
+        c.buffers = false;
+        c.segment = 0;
+        for (int i = 0; i < 16; ++i) appendServerFrame(c.wire, 0x80 | 0x40 | 0x01, packed.data(), packed.size());
+        cases.push_back(c);
+
+        c.name += "/buffers";
+        c.buffers = true;
+        cases.push_back(c);
+    }
+
+    const std::vector<uint8_t> json1m = benchJson(1 << 20, rng);
+    const std::vector<uint8_t> packed1m = deflatePayload(json1m);
+    if (!packed1m.empty()) {
+        ParseCase c;
+        c.name = "deflate/text/1048576/chained";
+        c.payload_bytes = json1m.size();
+        c.messages = 1;
+        c.compressed = true;
+        c.chunks = false;
+        c.buffers = false;
+        c.segment = 16 * 1024;
+        appendServerFrame(c.wire, 0x80 | 0x40 | 0x01, packed1m.data(), packed1m.size());
+        cases.push_back(c);
+    }
+
+    evbuffer* in = evbuffer_new();
+    if (!in) {
+        fprintf(stderr, "parse: evbuffer_new failed\n");
+        return;
+    }
+
+    for (const ParseCase& c : cases) {
+        BenchSinks sinks;
+        sinks.compression = c.compressed;
+        sinks.chunks = c.chunks;
+        sinks.buffers = c.buffers;
+        WebSocketReceiver rx(sinks);
+        if (c.compressed) {
+            PerMessageDeflateConfig cfg;
+            cfg.enabled = true;
+            cfg.server_no_context_takeover = true;
+            if (!rx.initializeCompression(cfg)) {
+                fprintf(stderr, "parse: %s: compression setup failed\n", c.name.c_str());
+                continue;
+            }
+        }
+
+        auto feed = [&]() {
+            const size_t step = c.segment ? c.segment : c.wire.size();
+            for (size_t off = 0; off < c.wire.size(); off += step) {
+                evbuffer_add_reference(in, c.wire.data() + off, std::min(step, c.wire.size() - off), nullptr, nullptr);
+            }
+            rx.onData(in);
+        };
+
+        // Sanity: every message delivered, nothing left over
+        feed();
+        if (sinks.errors || sinks.messages != c.messages || sinks.bytes != c.payload_bytes ||
+            evbuffer_get_length(in) != 0) {
+            fprintf(stderr, "parse: %s: delivered %llu/%zu messages, %llu errors\n", c.name.c_str(),
+                    static_cast<unsigned long long>(sinks.messages), c.messages,
+                    static_cast<unsigned long long>(sinks.errors));
+            evbuffer_drain(in, evbuffer_get_length(in));
+            continue;
+        }
+
+        benchRun(report, "parse", c.name, c.payload_bytes, feed);
+    }
+
+    evbuffer_free(in);
+}
+
+// permessage-deflate as the receiver does it: txPrepare() (txDeflate plus the
+// size checks send() relies on) and rxInflate(), with and without context takeover.
+void benchDeflate(BenchReport& report) {
+    const size_t sizes[] = { 256, 4096, 64 * 1024 };
+    std::mt19937 rng(11);
+
+    for (size_t len : sizes) {
+        // With context takeover a repeated message would compress to a back
+        std::vector<std::vector<uint8_t>> msgs;
+        // reference, so the sender rotates through more than a window's worth
+        for (size_t i = 0; i < std::max<size_t>(8, 64 * 1024 / len); ++i) msgs.push_back(benchJson(len, rng));
+        const std::vector<uint8_t>& src = msgs[0];
+        const std::string sz = std::to_string(len);
+
+        for (int takeover = 1; takeover >= 0; --takeover) {
+            const std::string mode = takeover ? "takeover" : "no_takeover";
+
+            BenchSinks sinks;
+            WebSocketReceiver tx(sinks);
+            PerMessageDeflateConfig cfg;
+            cfg.enabled = true;
+            cfg.client_no_context_takeover = !takeover;
+            if (!tx.initializeCompression(cfg)) {
+                fprintf(stderr, "deflate: setup failed\n");
+                return;
+            }
+
+            size_t next = 0;
+            uint64_t in_total = 0, out_total = 0;
+            benchRun(report, "deflate", "txDeflate/" + mode + "/json/" + sz, len, [&]() {
+                const std::vector<uint8_t>& m = msgs[next++ % msgs.size()];
+                const uint8_t* p = nullptr;
+                size_t n = 0;
+                bool compressed = false;
+                tx.txPrepare(m.data(), m.size(), true, p, n, compressed);
+                benchClobber(p);
+                in_total += m.size();
+                out_total += n;
+            });
+            fprintf(stderr, "# deflate/%s/json/%s ratio %.3f\n", mode.c_str(), sz.c_str(),
+                    static_cast<double>(out_total) / static_cast<double>(in_total));
+        }
+
+        // Inflate replays one message, so the stream must forget it every time
+        const std::vector<uint8_t> packed = deflatePayload(src);
+        BenchSinks sinks;
+        sinks.compression = true;
+        WebSocketReceiver rx(sinks);
+        PerMessageDeflateConfig cfg;
+        cfg.enabled = true;
+        cfg.server_no_context_takeover = true;
+        std::vector<uint8_t> out;
+        if (packed.empty() || !rx.initializeCompression(cfg) ||
+            !rx.rxInflate(packed.data(), packed.size(), out) || out != src) {
+            fprintf(stderr, "deflate: round trip failed (%zu bytes)\n", len);
+            return;
+        }
+        benchRun(report, "deflate", "rxInflate/no_takeover/json/" + sz, len, [&]() {
+            rx.rxInflate(packed.data(), packed.size(), out);
+            benchClobber(out.data());
+        });
+    }
+}
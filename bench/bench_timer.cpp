@@ -0,0 +1,75 @@
+/*
+ *  bench_timer.cpp
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "Bench.h"
+#include "WebSocketTimerWheel.h"
+
+#include <event2/event.h>
+
+#include <memory>
+
+// Re-arming one of many per-connection timers, as every ping and every
+// connect or close timeout does: the loop's wheel against one libevent
+// timer per connection. Nothing fires; the timers are far out.
+void benchTimer(BenchReport& report) {
+    const size_t counts[] = { 1000, 10000, 100000 };
+    const uint64_t interval_ms = 30000;
+
+    for (size_t n : counts) {
+        const std::string sz = std::to_string(n);
+
+        event_base* base = event_base_new();
+        if (!base) {
+            fprintf(stderr, "timer: event_base_new failed\n");
+            return;
+        }
+
+        {
+            // Timers outlive the wheel, as connections do their loop's
+            std::unique_ptr<WebSocketTimer[]> timers(new WebSocketTimer[n]);
+            WebSocketTimerWheel wheel(base);
+            for (size_t i = 0; i < n; ++i) wheel.schedule(timers[i], interval_ms + wheel.jitter(interval_ms));
+
+            size_t next = 0;
+            benchRun(report, "timer", "rearm/wheel/" + sz, 0, [&]() {
+                wheel.schedule(timers[next], interval_ms);
+                if (++next == n) next = 0;
+            });
+            benchRun(report, "timer", "cancel+schedule/wheel/" + sz, 0, [&]() {
+                wheel.cancel(timers[next]);
+                wheel.schedule(timers[next], interval_ms);
+                if (++next == n) next = 0;
+            });
+        }
+
+        {
+            std::vector<event*> events(n);
+            std::mt19937 rng(1);
+            for (size_t i = 0; i < n; ++i) {
+                events[i] = evtimer_new(base, [](evutil_socket_t, short, void*) {}, nullptr);
+                const uint64_t ms = interval_ms + rng() % interval_ms;
+                timeval tv{ static_cast<long>(ms / 1000), static_cast<long>((ms % 1000) * 1000) };
+                evtimer_add(events[i], &tv);
+            }
+
+            const timeval tv{ static_cast<long>(interval_ms / 1000), 0 };
+            size_t next = 0;
+            benchRun(report, "timer", "rearm/libevent/" + sz, 0, [&]() {
+                evtimer_add(events[next], &tv);
+                if (++next == n) next = 0;
+            });
+            benchRun(report, "timer", "cancel+schedule/libevent/" + sz, 0, [&]() {
+                evtimer_del(events[next]);
+                evtimer_add(events[next], &tv);
+                if (++next == n) next = 0;
+            });
+
+            for (event* ev : events) event_free(ev);
+        }
+
+        event_base_free(base);
+    }
+}
@@ -0,0 +1,74 @@
+/*
+ *  bench_utf8.cpp
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "Bench.h"
+#include "Utf8Conformance.h"
+#include "Utf8Validator.h"
+
+#include <cstring>
+#include <random>
+
+namespace {
+
+std::vector<uint8_t> makeAsciiJson(size_t len) {
+    const char* rec = "{\"id\":12345,\"sym\":\"ABCD\",\"px\":101.25,\"qty\":300,\"side\":\"buy\"},";
+    std::vector<uint8_t> v;
+    while (v.size() < len) v.insert(v.end(), rec, rec + std::strlen(rec));
+    v.resize(len);
+    return v;
+}
+
+std::vector<uint8_t> makeMixed(size_t len) {
+    // Latin, Cyrillic, CJK and emoji, roughly what chat payloads look like
+    const char* rec = "price \xe2\x82\xac" "12, \xd0\xbf\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82 "
+                      "\xe4\xbd\xa0\xe5\xa5\xbd \xf0\x9f\x98\x80 ok; ";
+    std::vector<uint8_t> v;
+    while (v.size() + std::strlen(rec) <= len) v.insert(v.end(), rec, rec + std::strlen(rec));
+    while (v.size() < len) v.push_back('.');
+    return v;
+}
+
+} // namespace
+
+void benchUtf8(BenchReport& report) {
+    fprintf(stderr, "# utf8 kernel: %s\n", Utf8Validator::implementation());
+
+    if (!utf8CheckConformance()) {
+        report.fail("utf8 conformance");
+        return;
+    }
+    fprintf(stderr, "# utf8 conformance: %zu Autobahn 6.x cases ok\n", utf8ConformanceCases());
+
+    const size_t sizes[] = { 64, 4096, 1 << 20 };
+    const std::string impl = Utf8Validator::implementation();
+
+    for (size_t len : sizes) {
+        const std::string sz = std::to_string(len);
+        const std::vector<uint8_t> ascii = makeAsciiJson(len);
+        const std::vector<uint8_t> mixed = makeMixed(len);
+
+        benchRun(report, "utf8", "scalar/ascii/" + sz, len, [&]() {
+            Utf8Validator u;
+            bool ok = u.validateChunkScalar(ascii.data(), ascii.size());
+            benchClobber(&ok);
+        });
+        benchRun(report, "utf8", impl + "/ascii/" + sz, len, [&]() {
+            Utf8Validator u;
+            bool ok = u.validateChunk(ascii.data(), ascii.size());
+            benchClobber(&ok);
+        });
+        benchRun(report, "utf8", "scalar/mixed/" + sz, len, [&]() {
+            Utf8Validator u;
+            bool ok = u.validateChunkScalar(mixed.data(), mixed.size());
+            benchClobber(&ok);
+        });
+        benchRun(report, "utf8", impl + "/mixed/" + sz, len, [&]() {
+            Utf8Validator u;
+            bool ok = u.validateChunk(mixed.data(), mixed.size());
+            benchClobber(&ok);
+        });
+    }
+}
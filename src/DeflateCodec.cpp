@@ -0,0 +1,165 @@
+/*
+ *  DeflateCodec.cpp
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "DeflateCodec.h"
+
+#include <zlib.h>
+#include <algorithm>
+#include <cstring>
+
+#include "Logger.h"
+
+namespace {
+
+const uint8_t kSyncTail[4] = { 0x00, 0x00, 0xFF, 0xFF };
+
+class ZlibCodec : public DeflateCodec {
+public:
+    ~ZlibCodec() override {
+        if (deflate_ok) deflateEnd(&dzs);
+        if (inflate_ok) inflateEnd(&izs);
+    }
+
+    bool init(const DeflateCodecParams& p) {
+        std::memset(&dzs, 0, sizeof(dzs));
+        std::memset(&izs, 0, sizeof(izs));
+        deflate_ok = deflateInit2(&dzs, p.level, Z_DEFLATED, -p.tx_window_bits, p.mem_level, p.strategy) == Z_OK;
+        inflate_ok = inflateInit2(&izs, -p.rx_window_bits) == Z_OK;
+        return deflate_ok && inflate_ok;
+    }
+
+    Backend backend() const override { return Backend::ZLIB; }
+
+    bool compress(const uint8_t* in, size_t in_len, std::vector<uint8_t>& out, size_t& out_len) override {
+        deflateReset(&dzs);
+
+        size_t cap = deflateBound(&dzs, static_cast<uLong>(in_len)) + 16;
+        if (out.size() < cap) out.resize(cap);
+        cap = out.size();
+
+        dzs.next_in   = const_cast<Bytef*>(in);
+        dzs.avail_in  = static_cast<uInt>(in_len);
+        dzs.next_out  = out.data();
+        dzs.avail_out = static_cast<uInt>(cap);
+
+        size_t produced = 0;
+        for (;;) {
+            const int ret = deflate(&dzs, Z_SYNC_FLUSH);
+            produced = cap - dzs.avail_out;
+            if (ret != Z_OK && ret != Z_BUF_ERROR) return false;
+            if (dzs.avail_out != 0) break;
+
+            cap *= 2;
+            out.resize(cap);
+            dzs.next_out  = out.data() + produced;
+            dzs.avail_out = static_cast<uInt>(cap - produced);
+        }
+
+        if (produced < 4 || std::memcmp(out.data() + produced - 4, kSyncTail, 4) != 0) return false;
+        out_len = produced - 4;
+        return true;
+    }
+
+    bool decompress(const uint8_t* in, size_t in_len, std::vector<uint8_t>& out) override {
+        inflateReset(&izs);
+
+        size_t cap = 0;
+        auto grow = [&]() {
+            const size_t produced = cap - izs.avail_out;
+            cap = cap ? cap * 2 : std::max<size_t>(in_len * 4, 1024);
+            out.resize(cap);
+            izs.next_out  = out.data() + produced;
+            izs.avail_out = static_cast<uInt>(cap - produced);
+        };
+
+        const uint8_t* pieces[2] = { in, kSyncTail };
+        const size_t   sizes[2]  = { in_len, sizeof(kSyncTail) };
+        izs.avail_out = 0;
+
+        for (int i = 0; i < 2; ++i) {
+            izs.next_in  = const_cast<Bytef*>(pieces[i]);
+            izs.avail_in = static_cast<uInt>(sizes[i]);
+
+            while (izs.avail_in > 0) {
+                if (izs.avail_out == 0) grow();
+                const int ret = inflate(&izs, Z_SYNC_FLUSH);
+                if (ret == Z_STREAM_END) {
+                    // BFINAL message; the appended tail is surplus
+                    out.resize(cap - izs.avail_out);
+                    return true;
+                }
+                if (ret == Z_BUF_ERROR && izs.avail_out == 0) continue;
+                if (ret != Z_OK) {
+                    out.clear();
+                    return false;
+                }
+            }
+        }
+
+        // Drain output zlib could not place in a full buffer
+        while (izs.avail_out == 0) {
+            grow();
+            const int ret = inflate(&izs, Z_SYNC_FLUSH);
+            if (ret != Z_OK && ret != Z_BUF_ERROR && ret != Z_STREAM_END) {
+                out.clear();
+                return false;
+            }
+        }
+
+        out.resize(cap - izs.avail_out);
+        return true;
+    }
+
+private:
+    z_stream dzs;
+    z_stream izs;
+    bool deflate_ok = false;
+    bool inflate_ok = false;
+};
+
+} // namespace
+
+DeflateCodec::Backend DeflateCodec::compiledBackend() {
+#if defined(LIBWSC_CODEC_LIBDEFLATE)
+    return Backend::LIBDEFLATE;
+#elif defined(LIBWSC_CODEC_ZLIB_NG)
+    return Backend::ZLIB_NG;
+#else
+    return Backend::ZLIB;
+#endif
+}
+
+const char* DeflateCodec::backendName(Backend b) {
+    switch (b) {
+        case Backend::ZLIB:       return "zlib";
+        case Backend::ZLIB_NG:    return "zlib-ng";
+        case Backend::LIBDEFLATE: return "libdeflate";
+    }
+    return "unknown";
+}
+
+std::unique_ptr<DeflateCodec> DeflateCodec::create(Backend b, const DeflateCodecParams& p) {
+    switch (b) {
+        case Backend::ZLIB: {
+            std::unique_ptr<ZlibCodec> c(new ZlibCodec);
+            if (!c->init(p)) {
+                log_error("Failed to initialize zlib codec");
+                return nullptr;
+            }
+            return std::unique_ptr<DeflateCodec>(c.release());
+        }
+#ifdef LIBWSC_CODEC_ZLIB_NG
+        case Backend::ZLIB_NG:
+            return createZlibNgCodec(p);
+#endif
+#ifdef LIBWSC_CODEC_LIBDEFLATE
+        case Backend::LIBDEFLATE:
+            return createLibdeflateCodec(p);
+#endif
+        default:
+            return nullptr;
+    }
+}
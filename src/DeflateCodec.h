@@ -0,0 +1,75 @@
+/*
+ *  DeflateCodec.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * \brief Parameters for a whole-message codec (zlib numbering for level and strategy).
+ */
+struct DeflateCodecParams {
+    int level = 6;
+    int tx_window_bits = 15;
+    int rx_window_bits = 15;
+    int mem_level = 8;
+    int strategy = 0;
+};
+
+/**
+ * \brief Whole-message raw deflate codec producing permessage-deflate payloads.
+ *
+ * Every call stands alone (no context takeover), so the receiver only hands
+ * directions that negotiated no_context_takeover to a codec; everything else,
+ * including streaming inflate, stays on the resident zlib streams.
+ * The backend is chosen at build time with LIBWSC_DEFLATE_BACKEND.
+ */
+class DeflateCodec {
+public:
+    enum class Backend { ZLIB, ZLIB_NG, LIBDEFLATE };
+
+    virtual ~DeflateCodec() = default;
+
+    virtual Backend backend() const = 0;
+
+    /**
+     * \brief Compress one message; the SYNC_FLUSH tail is already stripped.
+     *
+     * \param out Grown as needed, never shrunk.
+     * \param out_len Payload bytes written to out.
+     */
+    virtual bool compress(const uint8_t* in, size_t in_len, std::vector<uint8_t>& out, size_t& out_len) = 0;
+
+    /**
+     * \brief Inflate one complete message payload (without the tail).
+     *
+     * \param out Resized to the decompressed message.
+     */
+    virtual bool decompress(const uint8_t* in, size_t in_len, std::vector<uint8_t>& out) = 0;
+
+    /**
+     * \brief Backend selected at build time.
+     */
+    static Backend compiledBackend();
+
+    static const char* backendName(Backend b);
+
+    /**
+     * \brief Create a codec for b.
+     * \return nullptr if b was not compiled in or fails to initialize.
+     */
+    static std::unique_ptr<DeflateCodec> create(Backend b, const DeflateCodecParams& p);
+};
+
+#ifdef LIBWSC_CODEC_ZLIB_NG
+std::unique_ptr<DeflateCodec> createZlibNgCodec(const DeflateCodecParams& p);
+#endif
+
+#ifdef LIBWSC_CODEC_LIBDEFLATE
+std::unique_ptr<DeflateCodec> createLibdeflateCodec(const DeflateCodecParams& p);
+#endif
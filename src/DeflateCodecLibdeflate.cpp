@@ -0,0 +1,92 @@
+/*
+ *  DeflateCodecLibdeflate.cpp
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+// libdeflate whole-buffer codec; built only with LIBWSC_DEFLATE_BACKEND=libdeflate.
+//
+// libdeflate always ends its output with a BFINAL block, which RFC 7692
+// (7.2.3.3) allows; it is sent as is. For input, the stripped SYNC_FLUSH
+// tail is put back and an empty final stored block appended so libdeflate
+// sees a terminated stream.
+
+#include "DeflateCodec.h"
+
+#include <libdeflate.h>
+#include <algorithm>
+#include <cstring>
+
+#include "Logger.h"
+
+namespace {
+
+// 00 00 FF FF (the stripped empty stored block) + 01 00 00 FF FF (empty final stored block)
+const uint8_t kTerminator[9] = { 0x00, 0x00, 0xFF, 0xFF, 0x01, 0x00, 0x00, 0xFF, 0xFF };
+
+class LibdeflateCodec : public DeflateCodec {
+public:
+    ~LibdeflateCodec() override {
+        if (compressor) libdeflate_free_compressor(compressor);
+        if (decompressor) libdeflate_free_decompressor(decompressor);
+    }
+
+    bool init(const DeflateCodecParams& p) {
+        // zlib's -1 is its level 6; libdeflate goes up to 12
+        compressor = libdeflate_alloc_compressor(p.level < 0 ? 6 : p.level);
+        decompressor = libdeflate_alloc_decompressor();
+        return compressor && decompressor;
+    }
+
+    Backend backend() const override { return Backend::LIBDEFLATE; }
+
+    bool compress(const uint8_t* in, size_t in_len, std::vector<uint8_t>& out, size_t& out_len) override {
+        const size_t cap = libdeflate_deflate_compress_bound(compressor, in_len);
+        if (out.size() < cap) out.resize(cap);
+
+        const size_t n = libdeflate_deflate_compress(compressor, in, in_len, out.data(), out.size());
+        if (n == 0) return false;
+        out_len = n;
+        return true;
+    }
+
+    bool decompress(const uint8_t* in, size_t in_len, std::vector<uint8_t>& out) override {
+        scratch.resize(in_len + sizeof(kTerminator));
+        if (in_len) std::memcpy(scratch.data(), in, in_len);
+        std::memcpy(scratch.data() + in_len, kTerminator, sizeof(kTerminator));
+
+        size_t cap = std::max<size_t>(in_len * 4, 1024);
+        for (;;) {
+            out.resize(cap);
+            size_t in_used = 0, out_used = 0;
+            const libdeflate_result r = libdeflate_deflate_decompress_ex(
+                decompressor, scratch.data(), scratch.size(), out.data(), cap, &in_used, &out_used);
+
+            if (r == LIBDEFLATE_SUCCESS) {
+                out.resize(out_used);
+                return true;
+            }
+            if (r != LIBDEFLATE_INSUFFICIENT_SPACE || cap >= (size_t(1) << 31)) {
+                out.clear();
+                return false;
+            }
+            cap *= 2;
+        }
+    }
+
+private:
+    libdeflate_compressor* compressor = nullptr;
+    libdeflate_decompressor* decompressor = nullptr;
+    std::vector<uint8_t> scratch;
+};
+
+} // namespace
+
+std::unique_ptr<DeflateCodec> createLibdeflateCodec(const DeflateCodecParams& p) {
+    std::unique_ptr<LibdeflateCodec> c(new LibdeflateCodec);
+    if (!c->init(p)) {
+        log_error("Failed to initialize libdeflate codec");
+        return nullptr;
+    }
+    return std::unique_ptr<DeflateCodec>(c.release());
+}
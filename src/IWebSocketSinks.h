@@ -4,10 +4,13 @@
  *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
  */
 #pragma once
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
 
+#include "WebSocketBuffer.h"
+
 struct IWebSocketSinks {
     virtual ~IWebSocketSinks() = default;
     virtual bool rxCompressionEnabled() const = 0;
@@ -15,7 +18,16 @@ struct IWebSocketSinks {
     virtual void onRxPing(std::vector<uint8_t>&& payload) = 0;
     virtual void onRxClose(uint16_t code, std::string&& reason) = 0;
     virtual void onRxProtocolError(uint16_t closeCode, std::string&& why) = 0;
-    virtual void onRxText(std::string&& msg) = 0;
-    virtual void onRxBinary(std::vector<uint8_t>&& msg) = 0;
+    // data is only valid for the duration of the call
+    virtual void onRxText(const uint8_t* data, size_t len) = 0;
+    virtual void onRxBinary(const uint8_t* data, size_t len) = 0;
+    // Streaming delivery: when rxStreamChunks() is true data messages arrive
+    // as a sequence of onRxChunk calls, the last one with final set
+    virtual bool rxStreamChunks() const = 0;
+    virtual void onRxChunk(const uint8_t* data, size_t len, bool binary, bool final) = 0;
+    // Ownership delivery: when rxTakesBuffers() is true (and chunks are not
+    // streamed) every complete data message arrives as a pooled buffer
+    virtual bool rxTakesBuffers() const = 0;
+    virtual void onRxBuffer(WebSocketBuffer&& buffer, bool binary) = 0;
     virtual bool rxIsTerminating() const = 0;
 };
\ No newline at end of file
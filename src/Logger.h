@@ -1,6 +1,6 @@
 /*
  *  Logger.h
- *  Dual-mode logger: console or syslog
+ *  Logging macros for the library; output goes through WebSocketLog
  * 
  *  Author: Milan M.
  *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
@@ -9,101 +9,64 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
-#include <syslog.h>
-#include <unistd.h>
-#include <sys/time.h>
-#include <ctime>
 
-/**
- * \brief Determines if logs should go to syslog (non-interactive) or console.
- */
-inline bool logger_use_syslog() {
-    static bool initialized = false;
-    static bool use_syslog = false;
-    if (!initialized) {
-        initialized = true;
-        use_syslog = !isatty(STDOUT_FILENO);
-        if (use_syslog) openlog(nullptr, LOG_PID, LOG_DAEMON);
-    }
-    return use_syslog;
-}
-
-/**
- * \brief Fill buf with current timestamp "YYYY-MM-DD HH:MM:SS.mmm".
- */
-inline void current_timestamp(char* buf, size_t len) {
-    struct timeval tv;
-    gettimeofday(&tv, nullptr);
-    struct tm tm_info;
-    localtime_r(&tv.tv_sec, &tm_info);
-    int ms = tv.tv_usec / 1000;
-    strftime(buf, len, "%Y-%m-%d %H:%M:%S", &tm_info);
-    size_t sl = strlen(buf);
-    snprintf(buf + sl, len - sl, ".%03d", ms);
-}
+#include "WebSocketLog.h"
 
-/**
- * \brief Internal debug logger: writes to stdout or syslog.
- */
-inline void log_debug_impl(const char* message) {
-#ifdef LIBWSC_USE_DEBUG
-    char ts[32]; current_timestamp(ts, sizeof(ts));
-    if (logger_use_syslog()) {
-        syslog(LOG_DEBUG, "%s", message);
-    } else {
-        fprintf(stdout, "[DEBUG %s] %s\n", ts, message);
-        fflush(stdout);
-    }
-#else
-    (void)message;
+// Levels compiled in: 0 none, 1 errors, 2 errors and debug
+#ifndef LIBWSC_LOG_LEVEL
+    #ifdef LIBWSC_USE_DEBUG
+        #define LIBWSC_LOG_LEVEL 2
+    #else
+        #define LIBWSC_LOG_LEVEL 1
+    #endif
 #endif
-}
 
-/**
- * \brief Internal error logger: writes to stderr or syslog.
- */
-inline void log_error_impl(const char* message) {
-    char ts[32]; current_timestamp(ts, sizeof(ts));
-    if (logger_use_syslog()) {
-        syslog(LOG_ERR, "%s", message);
-    } else {
-        fprintf(stderr, "[ERROR %s] %s\n", ts, message);
-        fflush(stderr);
-    }
-}
+// Longest message passed to the sink; longer ones are truncated
+#define LOG_MESSAGE_MAX 256
 
-// Zero-arg overloads to avoid format-security warnings
-inline void log_debug_fmt_impl(const char* fmt) {
-    log_debug_impl(fmt);
-}
-inline void log_error_fmt_impl(const char* fmt) {
-    log_error_impl(fmt);
+// Zero-arg overload to avoid format-security warnings
+inline void log_write_impl(WebSocketLog::Site& site, WebSocketLog::Level level, const char* fmt) {
+    unsigned suppressed = 0;
+    if (!WebSocketLog::admit(level, site, suppressed)) return;
+    WebSocketLog::write(level, suppressed, fmt, std::min<size_t>(strlen(fmt), LOG_MESSAGE_MAX - 1));
 }
 
-// Templated overloads for formatting
+// Formats only once the level and rate limit let the message through
 template<typename... Args>
-inline void log_debug_fmt_impl(const char* fmt, Args... args) {
-    char buf[256];
-    snprintf(buf, sizeof(buf), fmt, args...);
-    log_debug_impl(buf);
+inline void log_write_impl(WebSocketLog::Site& site, WebSocketLog::Level level, const char* fmt, Args... args) {
+    unsigned suppressed = 0;
+    if (!WebSocketLog::admit(level, site, suppressed)) return;
+    char buf[LOG_MESSAGE_MAX];
+    const int n = snprintf(buf, sizeof(buf), fmt, args...);
+    if (n < 0) return;
+    WebSocketLog::write(level, suppressed, buf, std::min<size_t>(static_cast<size_t>(n), sizeof(buf) - 1));
 }
 
+// Compiled-out statements: arguments are still type-checked, never evaluated
 template<typename... Args>
-inline void log_error_fmt_impl(const char* fmt, Args... args) {
-    char buf[256];
-    snprintf(buf, sizeof(buf), fmt, args...);
-    log_error_impl(buf);
-}
+inline void log_discard_impl(const char*, Args...) {}
+
+// Each statement gets its own rate limit state
+#define LIBWSC_LOG(level, ...) \
+    do { \
+        static WebSocketLog::Site libwsc_log_site; \
+        log_write_impl(libwsc_log_site, level, __VA_ARGS__); \
+    } while (0)
 
 // Public macros
-#ifdef LIBWSC_USE_DEBUG
-    #define log_debug(...)   log_debug_fmt_impl(__VA_ARGS__)
+#if LIBWSC_LOG_LEVEL >= 2
+    #define log_debug(...)   LIBWSC_LOG(WebSocketLog::Level::Debug, __VA_ARGS__)
 #else
-    #define log_debug(...)   ((void)0)
+    #define log_debug(...)   do { if (false) log_discard_impl(__VA_ARGS__); } while (0)
 #endif
 
-#define log_error(...)     log_error_fmt_impl(__VA_ARGS__)
+#if LIBWSC_LOG_LEVEL >= 1
+    #define log_error(...)   LIBWSC_LOG(WebSocketLog::Level::Error, __VA_ARGS__)
+#else
+    #define log_error(...)   do { if (false) log_discard_impl(__VA_ARGS__); } while (0)
+#endif
 
-#endif // LOGGER_H
\ No newline at end of file
+#endif // LOGGER_H
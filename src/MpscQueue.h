@@ -0,0 +1,178 @@
+/*
+ *  MpscQueue.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/**
+ * \brief Bounded lock-free multi-producer / single-consumer ring.
+ *
+ * Based on Dmitry Vyukov's bounded queue: every cell carries a sequence
+ * number, producers claim a slot with one CAS on the enqueue index and
+ * publish it with a release store, the single consumer never contends.
+ *
+ * Cells are allocated on the first push, so idle queues cost nothing.
+ *
+ * \tparam T default-constructible, move-assignable element type.
+ */
+template <typename T>
+class MpscQueue {
+public:
+    /**
+     * \param capacity Maximum number of queued elements (rounded up to a power of two).
+     */
+    explicit MpscQueue(size_t capacity) {
+        size_t n = 2;
+        while (n < capacity) n <<= 1;
+        mask = n - 1;
+    }
+
+    ~MpscQueue() {
+        delete[] cells.load(std::memory_order_acquire);
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    /**
+     * \brief Enqueue from any thread.
+     * \return false if the queue is full; value is left untouched.
+     */
+    bool push(T&& value) {
+        Cell* ring = ensureCells();
+
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &ring[pos & mask];
+            const size_t seq = cell->seq.load(std::memory_order_acquire);
+            const intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (dif == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (dif < 0) {
+                return false;   // full
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = std::move(value);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * \brief Enqueue n elements as one contiguous run with a single CAS.
+     *
+     * The consumer frees cells in order, so if the run's last cell is free
+     * all earlier ones are as well.
+     *
+     * \return false if the run does not fit; values are left untouched.
+     */
+    bool pushBatch(T* values, size_t n) {
+        if (n == 0) return true;
+        if (n > mask + 1) return false;
+
+        Cell* ring = ensureCells();
+
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            const size_t last = pos + n - 1;
+            const size_t seq = ring[last & mask].seq.load(std::memory_order_acquire);
+            const intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(last);
+            if (dif == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed)) break;
+            } else if (dif < 0) {
+                return false;   // not enough room
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        // Publish in order; the consumer stops at the first unpublished cell
+        for (size_t i = 0; i < n; ++i) {
+            Cell& cell = ring[(pos + i) & mask];
+            cell.value = std::move(values[i]);
+            cell.seq.store(pos + i + 1, std::memory_order_release);
+        }
+        return true;
+    }
+
+    /**
+     * \brief Dequeue; consumer thread only.
+     * \return false if the queue is empty (or the oldest slot is not yet published).
+     */
+    bool pop(T& out) {
+        Cell* ring = cells.load(std::memory_order_acquire);
+        if (!ring) return false;
+
+        const size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        Cell& cell = ring[pos & mask];
+        const size_t seq = cell.seq.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0) {
+            return false;
+        }
+
+        out = std::move(cell.value);
+        cell.value = T();
+        cell.seq.store(pos + mask + 1, std::memory_order_release);
+        dequeue_pos.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * \brief Drop every queued element; consumer thread only.
+     */
+    void clear() {
+        T tmp;
+        while (pop(tmp)) {}
+    }
+
+    /**
+     * \brief Number of claimed slots (approximate while producers are active).
+     */
+    size_t sizeApprox() const {
+        const size_t head = dequeue_pos.load(std::memory_order_relaxed);
+        const size_t tail = enqueue_pos.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    Cell* ensureCells() {
+        Cell* ring = cells.load(std::memory_order_acquire);
+        if (ring) return ring;
+
+        Cell* fresh = new Cell[mask + 1];
+        for (size_t i = 0; i <= mask; ++i) {
+            fresh[i].seq.store(i, std::memory_order_relaxed);
+        }
+        if (cells.compare_exchange_strong(ring, fresh, std::memory_order_acq_rel)) {
+            return fresh;
+        }
+        delete[] fresh;   // another producer won
+        return ring;
+    }
+
+    size_t mask = 0;
+    std::atomic<Cell*> cells{nullptr};
+
+    // Producer and consumer indices on separate cache lines
+    char pad0[64];
+    std::atomic<size_t> enqueue_pos{0};
+    char pad1[64];
+    std::atomic<size_t> dequeue_pos{0};
+};
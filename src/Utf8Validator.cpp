@@ -6,14 +6,363 @@
 
 #include "Utf8Validator.h"
 
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define LIBWSC_UTF8_SSE2 1
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #include <immintrin.h>
+    #define LIBWSC_UTF8_LOOKUP 1
+#endif
+
+#if defined(__aarch64__) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+    #include <arm_neon.h>
+    #define LIBWSC_UTF8_NEON 1
+#endif
+
+using Utf8Fn = bool (*)(const uint8_t*, size_t);
+
 Utf8Validator::Utf8Validator()
         : expectedContinuation(0),
             seenE0(false), seenED(false),
             seenF0(false), seenF4(false) {};
 
+// Length of the leading run of ASCII bytes
+static inline size_t asciiPrefix(const uint8_t* s, size_t n) {
+    size_t i = 0;
+#if defined(LIBWSC_UTF8_SSE2)
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        if (_mm_movemask_epi8(v) != 0) break;
+    }
+#elif defined(LIBWSC_UTF8_NEON)
+    for (; i + 16 <= n; i += 16) {
+        if (vmaxvq_u8(vld1q_u8(s + i)) >= 0x80) break;
+    }
+#endif
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, s + i, sizeof(w));
+        if (w & 0x8080808080808080ull) break;
+    }
+    while (i < n && s[i] < 0x80) ++i;
+    return i;
+}
+
+// Complete-buffer decoder: every sequence must end inside [s, s + n)
+static bool validateScalarComplete(const uint8_t* s, size_t n) {
+    size_t i = 0;
+    while (i < n) {
+        if (s[i] < 0x80) {
+            i += asciiPrefix(s + i, n - i);
+            if (i >= n) break;
+        }
+
+        const uint8_t b = s[i];
+        if (b < 0xC2) return false;   // stray continuation or overlong 2-byte lead
+
+        if (b < 0xE0) {
+            if (i + 1 >= n || (s[i + 1] & 0xC0) != 0x80) return false;
+            i += 2;
+            continue;
+        }
+
+        if (b < 0xF0) {
+            if (i + 2 >= n) return false;
+            const uint8_t b1 = s[i + 1];
+            if ((b1 & 0xC0) != 0x80 || (s[i + 2] & 0xC0) != 0x80) return false;
+            if (b == 0xE0 && b1 < 0xA0) return false;   // overlong
+            if (b == 0xED && b1 > 0x9F) return false;   // surrogate
+            i += 3;
+            continue;
+        }
+
+        if (b < 0xF5) {
+            if (i + 3 >= n) return false;
+            const uint8_t b1 = s[i + 1];
+            if ((b1 & 0xC0) != 0x80 || (s[i + 2] & 0xC0) != 0x80 || (s[i + 3] & 0xC0) != 0x80) return false;
+            if (b == 0xF0 && b1 < 0x90) return false;   // overlong
+            if (b == 0xF4 && b1 > 0x8F) return false;   // > U+10FFFF
+            i += 4;
+            continue;
+        }
+
+        return false;
+    }
+    return true;
+}
+
+#ifdef LIBWSC_UTF8_LOOKUP
+/*
+ * Range-lookup validation (Keiser & Lemire, "Validating UTF-8 In Less Than
+ * One Instruction Per Byte", 2021). Each byte pair (previous byte, current
+ * byte) is classified by three 16-entry nibble tables; an error bit
+ * survives the AND only for an invalid pair. Third and fourth bytes of
+ * 3/4-byte sequences are checked separately against the lead two or three
+ * positions back.
+ */
+enum : uint8_t {
+    TOO_SHORT      = 1 << 0,   // 11______ 0_______ / 11______ 11______
+    TOO_LONG       = 1 << 1,   // 0_______ 10______
+    OVERLONG_3     = 1 << 2,   // 11100000 100_____
+    TOO_LARGE      = 1 << 3,   // 11110100 1001____ / 11110100 101_____ / 11110101..
+    SURROGATE      = 1 << 4,   // 11101101 101_____
+    OVERLONG_2     = 1 << 5,   // 1100000_ ________
+    TOO_LARGE_1000 = 1 << 6,   // 11110101 1000____ / 1111011_ 1000____ / 11111___ 1000____
+    OVERLONG_4     = 1 << 6,   // 11110000 1000____
+    TWO_CONTS      = 1 << 7,   // 10______ 10______
+    CARRY          = TOO_SHORT | TOO_LONG | TWO_CONTS
+};
+
+alignas(16) static const uint8_t kByte1High[16] = {
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+    TOO_SHORT | OVERLONG_2,
+    TOO_SHORT,
+    TOO_SHORT | OVERLONG_3 | SURROGATE,
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4
+};
+
+alignas(16) static const uint8_t kByte1Low[16] = {
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+    CARRY | OVERLONG_2,
+    CARRY,
+    CARRY,
+    CARRY | TOO_LARGE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000
+};
+
+alignas(16) static const uint8_t kByte2High[16] = {
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE  | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE  | TOO_LARGE,
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT
+};
+
+// Last three bytes of a block may not start a sequence that needs more bytes
+alignas(32) static const uint8_t kIncompleteMax[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xF0 - 1, 0xE0 - 1, 0xC0 - 1
+};
+
+struct Ssse3State {
+    __m128i prev_input;
+    __m128i prev_incomplete;
+    __m128i error;
+};
+
+__attribute__((target("ssse3")))
+static inline void utf8BlockSsse3(Ssse3State& st, __m128i input) {
+    if (_mm_movemask_epi8(input) == 0) {
+        // ASCII block: only a sequence left open by the previous block can fail
+        st.error = _mm_or_si128(st.error, st.prev_incomplete);
+    } else {
+        const __m128i nib = _mm_set1_epi8(0x0F);
+        const __m128i t1 = _mm_load_si128(reinterpret_cast<const __m128i*>(kByte1High));
+        const __m128i t2 = _mm_load_si128(reinterpret_cast<const __m128i*>(kByte1Low));
+        const __m128i t3 = _mm_load_si128(reinterpret_cast<const __m128i*>(kByte2High));
+
+        const __m128i prev1 = _mm_alignr_epi8(input, st.prev_input, 15);
+        const __m128i prev2 = _mm_alignr_epi8(input, st.prev_input, 14);
+        const __m128i prev3 = _mm_alignr_epi8(input, st.prev_input, 13);
+
+        const __m128i b1h = _mm_shuffle_epi8(t1, _mm_and_si128(_mm_srli_epi16(prev1, 4), nib));
+        const __m128i b1l = _mm_shuffle_epi8(t2, _mm_and_si128(prev1, nib));
+        const __m128i b2h = _mm_shuffle_epi8(t3, _mm_and_si128(_mm_srli_epi16(input, 4), nib));
+        const __m128i sc  = _mm_and_si128(_mm_and_si128(b1h, b1l), b2h);
+
+        const __m128i is3 = _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+        const __m128i is4 = _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+        const __m128i must23_80 = _mm_and_si128(_mm_or_si128(is3, is4), _mm_set1_epi8(static_cast<char>(0x80)));
+
+        st.error = _mm_or_si128(st.error, _mm_xor_si128(must23_80, sc));
+        st.prev_incomplete = _mm_subs_epu8(input,
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(kIncompleteMax + 16)));
+    }
+    st.prev_input = input;
+}
+
+__attribute__((target("ssse3")))
+static bool validateSsse3(const uint8_t* s, size_t n) {
+    Ssse3State st;
+    st.prev_input = st.prev_incomplete = st.error = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        utf8BlockSsse3(st, _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i)));
+    }
+    if (i < n) {
+        uint8_t tail[16] = {};
+        std::memcpy(tail, s + i, n - i);
+        utf8BlockSsse3(st, _mm_loadu_si128(reinterpret_cast<const __m128i*>(tail)));
+    }
+
+    const __m128i err = _mm_or_si128(st.error, st.prev_incomplete);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(err, _mm_setzero_si128())) == 0xFFFF;
+}
+
+struct Avx2State {
+    __m256i prev_input;
+    __m256i prev_incomplete;
+    __m256i error;
+};
+
+__attribute__((target("avx2")))
+static inline void utf8BlockAvx2(Avx2State& st, __m256i input) {
+    if (_mm256_movemask_epi8(input) == 0) {
+        st.error = _mm256_or_si256(st.error, st.prev_incomplete);
+    } else {
+        const __m256i nib = _mm256_set1_epi8(0x0F);
+        const __m256i t1 = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(kByte1High)));
+        const __m256i t2 = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(kByte1Low)));
+        const __m256i t3 = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(kByte2High)));
+
+        // alignr works per 128-bit lane; splice in the high lane of the previous block
+        const __m256i carry = _mm256_permute2x128_si256(st.prev_input, input, 0x21);
+        const __m256i prev1 = _mm256_alignr_epi8(input, carry, 15);
+        const __m256i prev2 = _mm256_alignr_epi8(input, carry, 14);
+        const __m256i prev3 = _mm256_alignr_epi8(input, carry, 13);
+
+        const __m256i b1h = _mm256_shuffle_epi8(t1, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nib));
+        const __m256i b1l = _mm256_shuffle_epi8(t2, _mm256_and_si256(prev1, nib));
+        const __m256i b2h = _mm256_shuffle_epi8(t3, _mm256_and_si256(_mm256_srli_epi16(input, 4), nib));
+        const __m256i sc  = _mm256_and_si256(_mm256_and_si256(b1h, b1l), b2h);
+
+        const __m256i is3 = _mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+        const __m256i is4 = _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+        const __m256i must23_80 = _mm256_and_si256(_mm256_or_si256(is3, is4), _mm256_set1_epi8(static_cast<char>(0x80)));
+
+        st.error = _mm256_or_si256(st.error, _mm256_xor_si256(must23_80, sc));
+        st.prev_incomplete = _mm256_subs_epu8(input,
+            _mm256_load_si256(reinterpret_cast<const __m256i*>(kIncompleteMax)));
+    }
+    st.prev_input = input;
+}
+
+__attribute__((target("avx2")))
+static bool validateAvx2(const uint8_t* s, size_t n) {
+    Avx2State st;
+    st.prev_input = st.prev_incomplete = st.error = _mm256_setzero_si256();
+
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i + 32));
+        // 64-byte ASCII fast path
+        if (_mm256_movemask_epi8(_mm256_or_si256(a, b)) == 0) {
+            st.error = _mm256_or_si256(st.error, st.prev_incomplete);
+            st.prev_incomplete = _mm256_setzero_si256();
+            st.prev_input = b;
+            continue;
+        }
+        utf8BlockAvx2(st, a);
+        utf8BlockAvx2(st, b);
+    }
+    for (; i + 32 <= n; i += 32) {
+        utf8BlockAvx2(st, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i)));
+    }
+    if (i < n) {
+        uint8_t tail[32] = {};
+        std::memcpy(tail, s + i, n - i);
+        utf8BlockAvx2(st, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tail)));
+    }
+
+    const __m256i err = _mm256_or_si256(st.error, st.prev_incomplete);
+    return _mm256_testz_si256(err, err) != 0;
+}
+#endif
+
+struct Utf8Kernel {
+    Utf8Fn fn;
+    const char* name;
+};
+
+static Utf8Kernel selectKernel() {
+#ifdef LIBWSC_UTF8_LOOKUP
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return { &validateAvx2, "avx2" };
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        return { &validateSsse3, "ssse3" };
+    }
+#endif
+#if defined(LIBWSC_UTF8_SSE2)
+    return { &validateScalarComplete, "sse2" };
+#elif defined(LIBWSC_UTF8_NEON)
+    return { &validateScalarComplete, "neon" };
+#else
+    return { &validateScalarComplete, "scalar" };
+#endif
+}
+
+static const Utf8Kernel& kernel() {
+    static const Utf8Kernel k = selectKernel();
+    return k;
+}
+
+bool Utf8Validator::validate(const uint8_t* data, size_t len) {
+    // Short strings are not worth the setup of a vector kernel
+    if (len < 16) return validateScalarComplete(data, len);
+    return kernel().fn(data, len);
+}
+
+const char* Utf8Validator::implementation() {
+    return kernel().name;
+}
+
 /**
  * \brief Validate a chunk of UTF-8 encoded data.
  *
+ * Same contract as validateChunkScalar(). A sequence left open by the
+ * previous chunk is finished byte by byte, the longest prefix that ends on
+ * a sequence boundary goes through the vector kernel, and a sequence cut
+ * off at the end of the chunk is carried over by the scalar state machine.
+ */
+bool Utf8Validator::validateChunk(const uint8_t* data, size_t len) {
+    size_t i = 0;
+
+    if (expectedContinuation > 0) {
+        i = std::min(len, static_cast<size_t>(expectedContinuation));
+        if (!validateChunkScalar(data, i)) return false;
+        if (i == len) return true;
+    }
+
+    // Back off from an incomplete sequence at the end (at most 3 bytes)
+    size_t end = len;
+    for (size_t back = 1; back <= 3 && back <= len - i; ++back) {
+        const uint8_t b = data[len - back];
+        if ((b & 0xC0) == 0x80) continue;
+
+        const size_t need = (b >= 0xF0) ? 4 : (b >= 0xE0) ? 3 : (b >= 0xC0) ? 2 : 1;
+        if (need > back) end = len - back;
+        break;
+    }
+
+    if (!validate(data + i, end - i)) return false;
+    return validateChunkScalar(data + end, len - end);
+}
+
+/**
+ * \brief Reference byte-at-a-time UTF-8 state machine.
+ *
  * Processes input bytes in a streaming fashion, maintaining state between chunks.
  * Validates UTF-8 sequences according to RFC 3629, checking for:
  * - Proper byte sequences
@@ -47,7 +396,7 @@ Utf8Validator::Utf8Validator()
  *    - Decrement continuation count
  *    - Clear flags when sequence completes
  */
-bool Utf8Validator::validateChunk(const uint8_t* data, size_t len) {
+bool Utf8Validator::validateChunkScalar(const uint8_t* data, size_t len) {
     for (size_t i = 0; i < len; ++i) {
         uint8_t b = data[i];
         if (expectedContinuation == 0) {
@@ -8,6 +8,15 @@
 #include <cstdint>
 #include <cstddef>
 
+/**
+ * \brief Streaming UTF-8 validator (RFC 3629).
+ *
+ * validateChunk() may be called any number of times per message; sequences
+ * split across chunks are carried over. The bulk of each chunk is checked
+ * with the widest kernel the CPU supports, picked on first use:
+ * AVX2 or SSSE3 range lookup (runtime-detected, x86), or a scalar decoder
+ * with a 16-byte ASCII fast path (SSE2/NEON) or 8-byte word fallback.
+ */
 class Utf8Validator {
 public:
     Utf8Validator();
@@ -15,6 +24,21 @@ public:
     bool validateFinal() const;
     void reset();
 
+    /**
+     * \brief Reference byte-at-a-time state machine; same contract as validateChunk().
+     */
+    bool validateChunkScalar(const uint8_t* data, size_t len);
+
+    /**
+     * \brief Validate a complete buffer (no carried-over state).
+     */
+    static bool validate(const uint8_t* data, size_t len);
+
+    /**
+     * \brief Name of the bulk kernel ("avx2", "ssse3", "sse2", "neon" or "scalar").
+     */
+    static const char* implementation();
+
 private:
     int  expectedContinuation;
     bool seenE0;
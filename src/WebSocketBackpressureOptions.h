@@ -0,0 +1,43 @@
+/*
+ *  WebSocketBackpressureOptions.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+#include <cstddef>
+
+/**
+ * \struct WebSocketBackpressureOptions
+ * \brief Send-side flow control limits for a WebSocket connection
+ *
+ * \details The buffered amount is every payload byte accepted for sending
+ * but not yet written to the socket: the pending send queue plus the
+ * connection's output buffer. Once it would exceed highWatermark, new
+ * sends are handled according to policy. When the buffered amount falls
+ * back to lowWatermark the writable callback fires.
+ */
+struct WebSocketBackpressureOptions {
+    /**
+     * \brief What a send does when the connection is over its limits
+     */
+    enum class Policy {
+        DROP,   ///< Discard the message, log it and return false
+        REJECT, ///< Return false without logging; retry from the writable callback
+        BLOCK   ///< Wait up to blockTimeoutMs for room, then behave like REJECT
+    };
+
+    size_t highWatermark = 0;      ///< Buffered bytes above which sends are refused (0 = no byte limit)
+    size_t lowWatermark = 0;       ///< Buffered bytes at which the writable callback fires (0 = highWatermark / 2)
+    size_t maxQueuedMessages = 1024; ///< Capacity of the pending send queue, in messages
+    Policy policy = Policy::DROP;  ///< Overflow behaviour
+    unsigned int blockTimeoutMs = 1000; ///< Longest a BLOCK send waits for room
+
+    /**
+     * \brief Effective low watermark
+     * \return lowWatermark, or half the high watermark when unset
+     */
+    size_t effectiveLowWatermark() const {
+        return lowWatermark ? lowWatermark : highWatermark / 2;
+    }
+};
@@ -0,0 +1,66 @@
+/*
+ *  WebSocketBuffer.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class WebSocketBufferPool;
+
+/**
+ * \class WebSocketBuffer
+ * \brief Owning handle to a received message held in a recycled buffer
+ *
+ * \details Delivered by the message buffer callback. The handle may be kept
+ * and moved to another thread; destroying it or calling release() hands the
+ * memory back to the connection's pool, from any thread, so steady-state
+ * receiving does not allocate. A buffer stays valid after its connection
+ * has closed.
+ */
+class WebSocketBuffer {
+public:
+    WebSocketBuffer() = default;
+    ~WebSocketBuffer() { release(); }
+
+    WebSocketBuffer(WebSocketBuffer&& other) noexcept
+        : pool(std::move(other.pool)), storage(other.storage) {
+        other.storage = nullptr;
+    }
+
+    WebSocketBuffer& operator=(WebSocketBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            pool = std::move(other.pool);
+            storage = other.storage;
+            other.storage = nullptr;
+        }
+        return *this;
+    }
+
+    WebSocketBuffer(const WebSocketBuffer&) = delete;
+    WebSocketBuffer& operator=(const WebSocketBuffer&) = delete;
+
+    uint8_t* data() { return storage ? storage->data() : nullptr; }
+    const uint8_t* data() const { return storage ? storage->data() : nullptr; }
+    size_t size() const { return storage ? storage->size() : 0; }
+    bool empty() const { return size() == 0; }
+    explicit operator bool() const { return storage != nullptr; }
+
+    /**
+     * \brief Return the memory to the pool now; the handle becomes empty.
+     */
+    void release();
+
+private:
+    friend class WebSocketBufferPool;
+    WebSocketBuffer(std::shared_ptr<WebSocketBufferPool> p, std::vector<uint8_t>* s)
+        : pool(std::move(p)), storage(s) {}
+
+    std::shared_ptr<WebSocketBufferPool> pool;
+    std::vector<uint8_t>* storage = nullptr;
+};
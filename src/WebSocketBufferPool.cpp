@@ -0,0 +1,69 @@
+/*
+ *  WebSocketBufferPool.cpp
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "WebSocketBufferPool.h"
+
+const size_t WebSocketBufferPool::MAX_IDLE;
+const size_t WebSocketBufferPool::MAX_RETAINED_CAPACITY;
+
+void WebSocketBuffer::release() {
+    if (!storage) return;
+    pool->giveBack(storage);
+    storage = nullptr;
+    pool.reset();
+}
+
+WebSocketBufferPool::WebSocketBufferPool() : returned(MAX_IDLE * 4) {
+    idle.reserve(MAX_IDLE);
+}
+
+std::shared_ptr<WebSocketBufferPool> WebSocketBufferPool::create() {
+    return std::shared_ptr<WebSocketBufferPool>(new WebSocketBufferPool);
+}
+
+WebSocketBufferPool::~WebSocketBufferPool() {
+    // Last reference: no handle or event thread can touch the queue any more
+    for (Storage* s : idle) delete s;
+    Storage* s = nullptr;
+    while (returned.pop(s)) delete s;
+}
+
+bool WebSocketBufferPool::retain(Storage* s) const {
+    return s->capacity() <= MAX_RETAINED_CAPACITY;
+}
+
+WebSocketBufferPool::Storage* WebSocketBufferPool::acquire(size_t reserve) {
+    Storage* s = nullptr;
+    while (idle.size() < MAX_IDLE && returned.pop(s)) idle.push_back(s);
+
+    if (!idle.empty()) {
+        s = idle.back();
+        idle.pop_back();
+        s->clear();
+    } else {
+        s = new Storage;
+        ++allocated;
+    }
+    if (s->capacity() < reserve) s->reserve(reserve);
+    return s;
+}
+
+void WebSocketBufferPool::recycle(Storage* s) {
+    if (!s) return;
+    if (idle.size() < MAX_IDLE && retain(s)) {
+        idle.push_back(s);
+    } else {
+        delete s;
+    }
+}
+
+WebSocketBuffer WebSocketBufferPool::wrap(Storage* s) {
+    return WebSocketBuffer(shared_from_this(), s);
+}
+
+void WebSocketBufferPool::giveBack(Storage* s) {
+    if (!retain(s) || !returned.push(std::move(s))) delete s;
+}
@@ -0,0 +1,71 @@
+/*
+ *  WebSocketBufferPool.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "MpscQueue.h"
+#include "WebSocketBuffer.h"
+
+/**
+ * \brief Per-connection free list of message buffers.
+ *
+ * Reassembled and inflated messages are built in buffers taken from here,
+ * and given back once delivered, so their capacity carries over from one
+ * message to the next. acquire() and recycle() belong to the event thread.
+ * Buffers handed to the application as WebSocketBuffer come back through
+ * a lock-free queue from whatever thread releases them. The next acquire()
+ * picks them up.
+ *
+ * Idle buffers are capped in number, and a buffer that grew past
+ * MAX_RETAINED_CAPACITY is freed instead of kept. That way one huge
+ * message does not pin its memory for the life of the connection.
+ */
+class WebSocketBufferPool : public std::enable_shared_from_this<WebSocketBufferPool> {
+public:
+    using Storage = std::vector<uint8_t>;
+
+    static const size_t MAX_IDLE = 16;
+    static const size_t MAX_RETAINED_CAPACITY = 4 << 20;
+
+    static std::shared_ptr<WebSocketBufferPool> create();
+    ~WebSocketBufferPool();
+
+    WebSocketBufferPool(const WebSocketBufferPool&) = delete;
+    WebSocketBufferPool& operator=(const WebSocketBufferPool&) = delete;
+
+    /**
+     * \brief An empty buffer with at least reserve bytes of capacity; event thread only.
+     */
+    Storage* acquire(size_t reserve = 0);
+
+    /**
+     * \brief Take a buffer back from the event thread.
+     */
+    void recycle(Storage* s);
+
+    /**
+     * \brief Hand a buffer to the application; it comes back when the handle is released.
+     */
+    WebSocketBuffer wrap(Storage* s);
+
+    /// Buffers allocated so far (steady state: stops growing)
+    uint64_t allocations() const { return allocated; }
+
+private:
+    friend class WebSocketBuffer;
+    WebSocketBufferPool();
+
+    void giveBack(Storage* s);   // any thread
+    bool retain(Storage* s) const;
+
+    std::vector<Storage*> idle;          // event thread only
+    MpscQueue<Storage*> returned;        // released handles, any thread
+    uint64_t allocated = 0;
+};
@@ -24,6 +24,8 @@ bool WebSocketClient::isConnected() {
 }
 
 void WebSocketClient::setUrl(const std::string& url) {
+    handshake.reset();
+
     const std::string ws_scheme = "ws://";
     const std::string wss_scheme = "wss://";
 
@@ -86,6 +88,7 @@ bool WebSocketClient::isHostIPAddress(const std::string& host) {
 
 void WebSocketClient::setHeaders(const WebSocketHeaders& headers) {
     extra_headers = headers;
+    handshake.reset();
 }
 
 void WebSocketClient::setTLSOptions(const WebSocketTLSOptions& options) {
@@ -96,12 +99,57 @@ void WebSocketClient::setPingInterval(int interval) {
     ping_interval = interval;
 }
 
+void WebSocketClient::setPongTimeout(int seconds) {
+    pong_timeout = seconds;
+}
+
 void WebSocketClient::setConnectionTimeout(int timeout) {
     connection_timeout = timeout;
 }
 
 void WebSocketClient::enableCompression(bool enable) {
     compression_requested = enable;
+    handshake.reset();
+}
+
+void WebSocketClient::setCompressionOptions(const WebSocketCompressionOptions& options) {
+    compression_options = options;
+    compression_requested = true;
+    handshake.reset();
+}
+
+void WebSocketClient::setEventLoopPool(std::shared_ptr<WebSocketEventLoopPool> pool) {
+    loop_pool = std::move(pool);
+}
+
+void WebSocketClient::setSingleThreadedIO(bool enable) {
+    single_threaded_io = enable;
+}
+
+void WebSocketClient::setBackpressureOptions(const WebSocketBackpressureOptions& options) {
+    backpressure_options = options;
+}
+
+void WebSocketClient::setSocketOptions(const WebSocketSocketOptions& options) {
+    socket_options = options;
+}
+
+void WebSocketClient::setConnectOptions(const WebSocketConnectOptions& options) {
+    connect_options = options;
+}
+
+void WebSocketClient::setReconnectOptions(const WebSocketReconnectOptions& options) {
+    reconnect_options = options;
+}
+
+void WebSocketClient::clearDnsCache() {
+    WebSocketDnsCache::instance().clear();
+}
+
+void WebSocketClient::clearTlsCache() {
+#ifdef USE_TLS
+    WebSocketTLSContext::clearCache();
+#endif
 }
 
 void WebSocketClient::setOpenCallback(OpenCallback callback) {
@@ -124,21 +172,122 @@ void WebSocketClient::setMessageCallback(MessageCallback callback) {
     if (_ctx) _ctx->setMessageCallback(message_callback);
 }
 
+void WebSocketClient::setMessageViewCallback(MessageViewCallback callback) {
+    message_view_callback = std::move(callback);
+    if (_ctx) _ctx->setMessageViewCallback(message_view_callback);
+}
+
 void WebSocketClient::setBinaryCallback(BinaryCallback callback) {
     binary_callback = std::move(callback);
     if (_ctx) _ctx->setBinaryCallback(binary_callback);
 }
 
-bool WebSocketClient::sendMessage(const std::string& message) {
-    return _ctx && _ctx->sendData(message.data(), message.size(), MessageType::TEXT);
+void WebSocketClient::setMessageChunkCallback(MessageChunkCallback callback) {
+    message_chunk_callback = std::move(callback);
+    if (_ctx) _ctx->setMessageChunkCallback(message_chunk_callback);
+}
+
+void WebSocketClient::setMessageBufferCallback(MessageBufferCallback callback) {
+    message_buffer_callback = std::move(callback);
+    if (_ctx) _ctx->setMessageBufferCallback(message_buffer_callback);
+}
+
+void WebSocketClient::setWritableCallback(WritableCallback callback) {
+    writable_callback = std::move(callback);
+    if (_ctx) _ctx->setWritableCallback(writable_callback);
+}
+
+void WebSocketClient::setListenerTable(const WebSocketListenerTable& table) {
+    listener = table;
+    if (_ctx) _ctx->setListener(listener);
+}
+
+size_t WebSocketClient::bufferedAmount() const {
+    return _ctx ? _ctx->bufferedAmount() : 0;
+}
+
+WebSocketStats WebSocketClient::getStats() const {
+    if (_ctx) return _ctx->stats();
+
+    WebSocketStats s;
+    if (counters) counters->snapshot(s);
+    return s;
 }
 
-bool WebSocketClient::sendMessage(const char* msg, size_t len) {
-    return _ctx && _ctx->sendData(msg, len, MessageType::TEXT);
+WebSocketStats WebSocketClient::getGlobalStats() {
+    WebSocketStats s;
+    WebSocketCounters::global(s);
+    return s;
 }
 
-bool WebSocketClient::sendBinary(const void* data, size_t length) {
-    return _ctx && _ctx->sendData(data, length, MessageType::BINARY);
+void WebSocketClient::setSendLatencyTracking(bool enable) {
+    send_latency_tracking = enable;
+}
+
+void WebSocketClient::setStatsCallback(StatsCallback callback, unsigned int interval_ms) {
+    stats_callback = std::move(callback);
+    stats_interval_ms = stats_callback ? interval_ms : 0;
+}
+
+static bool wantsCompression(WebSocketClient::SendFlags flags) {
+    return (static_cast<unsigned>(flags) & static_cast<unsigned>(WebSocketClient::SendFlags::NO_COMPRESS)) == 0;
+}
+
+bool WebSocketClient::sendMessage(const std::string& message, SendFlags flags) {
+    return _ctx && _ctx->sendData(message.data(), message.size(), MessageType::TEXT, wantsCompression(flags));
+}
+
+bool WebSocketClient::sendMessage(const char* msg, size_t len, SendFlags flags) {
+    return _ctx && _ctx->sendData(msg, len, MessageType::TEXT, wantsCompression(flags));
+}
+
+bool WebSocketClient::sendMessage(std::string&& message, SendFlags flags) {
+    return _ctx && _ctx->sendData(std::move(message), wantsCompression(flags));
+}
+
+bool WebSocketClient::sendMessage(std::shared_ptr<const std::string> message, SendFlags flags) {
+    if (!_ctx || !message) return false;
+    const std::string& m = *message;
+    return _ctx->sendShared(std::move(message), m.data(), m.size(), MessageType::TEXT, wantsCompression(flags));
+}
+
+bool WebSocketClient::sendBinary(const void* data, size_t length, SendFlags flags) {
+    return _ctx && _ctx->sendData(data, length, MessageType::BINARY, wantsCompression(flags));
+}
+
+bool WebSocketClient::sendBinary(std::vector<uint8_t>&& data, SendFlags flags) {
+    return _ctx && _ctx->sendData(std::move(data), wantsCompression(flags));
+}
+
+bool WebSocketClient::sendBinary(std::shared_ptr<const std::vector<uint8_t>> data, SendFlags flags) {
+    if (!_ctx || !data) return false;
+    const std::vector<uint8_t>& d = *data;
+    return _ctx->sendShared(std::move(data), d.data(), d.size(), MessageType::BINARY, wantsCompression(flags));
+}
+
+bool WebSocketClient::sendBatch(const BatchItem* items, size_t count, SendFlags flags) {
+    return _ctx && _ctx->sendBatch(items, count, wantsCompression(flags));
+}
+
+bool WebSocketClient::sendBatch(const std::vector<std::string>& messages, SendFlags flags) {
+    if (!_ctx) return false;
+
+    std::vector<BatchItem> items;
+    items.reserve(messages.size());
+    for (const std::string& m : messages) {
+        items.push_back(BatchItem{ m.data(), m.size(), MessageType::TEXT });
+    }
+    return _ctx->sendBatch(items.data(), items.size(), wantsCompression(flags));
+}
+
+void WebSocketClient::cork() {
+    corked = true;
+    if (_ctx) _ctx->setCorked(true);
+}
+
+void WebSocketClient::uncork() {
+    corked = false;
+    if (_ctx) _ctx->setCorked(false);
 }
 
 void WebSocketClient::connect() {
@@ -153,18 +302,48 @@ void WebSocketClient::connect() {
     cfg.secure = secure;
     cfg.is_ip_address = is_ip_address;
     cfg.ping_interval = ping_interval;
+    cfg.pong_timeout = pong_timeout;
     cfg.connection_timeout = connection_timeout;
     cfg.headers = extra_headers;
     cfg.tls = tls_options;
     cfg.compression_requested = compression_requested;
+    cfg.single_threaded_io = single_threaded_io;
+    cfg.compression = compression_options;
+    cfg.backpressure = backpressure_options;
+    cfg.socket = socket_options;
+    cfg.connect = connect_options;
+    cfg.reconnect = reconnect_options;
+    cfg.stats_interval_ms = stats_interval_ms;
+    cfg.send_latency_tracking = send_latency_tracking;
 
     try {
+        if (!handshake) {
+            handshake = std::make_shared<WebSocketHandshake>(host, port, uri, extra_headers,
+                                                             compression_requested, compression_options);
+        }
+        cfg.handshake = handshake;
+
+        if (!counters) counters = std::make_shared<WebSocketCounters>();
+        cfg.counters = counters;
+
+        if (loop_pool) cfg.loop = loop_pool->acquire();
+
         auto ctx = std::make_shared<WebSocketContext>(cfg);
-        if (open_callback) ctx->setOpenCallback(open_callback);
-        if (close_callback) ctx->setCloseCallback(close_callback);
-        if (error_callback) ctx->setErrorCallback(error_callback);
-        if (message_callback) ctx->setMessageCallback(message_callback);
-        if (binary_callback) ctx->setBinaryCallback(binary_callback);
+
+        WebSocketContext::Callbacks cbs;
+        cbs.on_open = open_callback;
+        cbs.on_close = close_callback;
+        cbs.on_error = error_callback;
+        cbs.on_message = message_callback;
+        cbs.on_message_view = message_view_callback;
+        cbs.on_binary = binary_callback;
+        cbs.on_writable = writable_callback;
+        cbs.on_chunk = message_chunk_callback;
+        cbs.on_buffer = message_buffer_callback;
+        cbs.on_stats = stats_callback;
+        cbs.listener = listener;
+        ctx->setCallbacks(cbs);
+        if (corked) ctx->setCorked(true);
 
         _ctx = ctx;
         _ctx->start();
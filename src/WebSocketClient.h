@@ -9,11 +9,24 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 #include <cstring>
 #include "WebSocketHeaders.h"
 #include "WebSocketTLSOptions.h"
+#include "WebSocketBackpressureOptions.h"
+#include "WebSocketSocketOptions.h"
+#include "WebSocketConnectOptions.h"
+#include "WebSocketReconnectOptions.h"
+#include "WebSocketCompressionOptions.h"
+#include "WebSocketStats.h"
+#include "WebSocketEventLoopPool.h"
+#include "WebSocketListener.h"
+#include "WebSocketBuffer.h"
+#include "WebSocketLog.h"
 
 class WebSocketContext;
+class WebSocketHandshake;
+struct WebSocketCounters;
 
 /**
  * \brief Asynchronous WebSocket client.
@@ -32,6 +45,23 @@ public:
         CLOSE
     };
 
+    /**
+     * \brief Per-message send options, combined with operator|.
+     */
+    enum class SendFlags : unsigned {
+        NONE        = 0,
+        NO_COMPRESS = 1u << 0   ///< Send raw even when permessage-deflate is negotiated
+    };
+
+    /**
+     * \brief One message of a sendBatch() call; the data is copied.
+     */
+    struct BatchItem {
+        const void* data;
+        size_t length;
+        MessageType type;   ///< TEXT or BINARY
+    };
+
     enum class ConnectionState {
         DISCONNECTED,
         DISCONNECTING,
@@ -78,7 +108,12 @@ public:
     using CloseCallback = std::function<void(int code, const std::string& reason)>;
     using ErrorCallback = std::function<void(int error_code, const std::string& error_message)>;
     using MessageCallback = std::function<void(const std::string&)>;
+    using MessageViewCallback = std::function<void(const char* data, size_t len)>;
     using BinaryCallback = std::function<void(const void*, size_t)>;
+    using WritableCallback = std::function<void()>;
+    using MessageChunkCallback = std::function<void(const void* data, size_t len, MessageType type, bool final)>;
+    using MessageBufferCallback = std::function<void(WebSocketBuffer&& buffer, MessageType type)>;
+    using StatsCallback = std::function<void(const WebSocketStats& stats)>;
 
     /**
      * \brief Construct a new WebSocket client instance.
@@ -124,10 +159,11 @@ public:
      * The message is queued if the connection is not yet established.
      *
      * \param message Text message to send.
+     * \param flags SendFlags, e.g. NO_COMPRESS for already-compressed payloads.
      * \return true if the message was accepted for sending,
      *         false if the client is not usable.
      */
-    bool sendMessage(const std::string& message);
+    bool sendMessage(const std::string& message, SendFlags flags = SendFlags::NONE);
 
     /**
      * \brief Send a text message from a raw character buffer.
@@ -136,20 +172,109 @@ public:
      *
      * \param msg Pointer to the message buffer.
      * \param len Length of the message in bytes.
+     * \param flags SendFlags, e.g. NO_COMPRESS for already-compressed payloads.
      * \return true if the message was accepted for sending,
      *         false if the client is not usable.
      */
-    bool sendMessage(const char* msg, size_t len);
+    bool sendMessage(const char* msg, size_t len, SendFlags flags = SendFlags::NONE);
+
+    /**
+     * \brief Send a text message, taking ownership of the string.
+     *
+     * The string buffer is moved into the send queue instead of copied.
+     *
+     * \param message Text message to send; left in a valid but unspecified state.
+     * \param flags SendFlags, e.g. NO_COMPRESS for already-compressed payloads.
+     * \return true if the message was accepted for sending,
+     *         false if the client is not usable.
+     */
+    bool sendMessage(std::string&& message, SendFlags flags = SendFlags::NONE);
+
+    /**
+     * \brief Send a shared, immutable text message.
+     *
+     * The payload is referenced rather than copied, so one buffer can be
+     * fanned out to many clients. It must not be modified afterwards.
+     *
+     * \param message Shared text message to send.
+     * \param flags SendFlags, e.g. NO_COMPRESS for already-compressed payloads.
+     * \return true if the message was accepted for sending,
+     *         false if the client is not usable.
+     */
+    bool sendMessage(std::shared_ptr<const std::string> message, SendFlags flags = SendFlags::NONE);
 
     /**
      * \brief Send a binary message.
      *
      * \param data Pointer to binary data buffer.
      * \param length Size of the binary data in bytes.
+     * \param flags SendFlags, e.g. NO_COMPRESS for already-compressed payloads.
+     * \return true if the message was accepted for sending,
+     *         false if the client is not usable.
+     */
+    bool sendBinary(const void* data, size_t length, SendFlags flags = SendFlags::NONE);
+
+    /**
+     * \brief Send a binary message, taking ownership of the buffer.
+     *
+     * \param data Binary payload; moved into the send queue instead of copied.
+     * \param flags SendFlags, e.g. NO_COMPRESS for already-compressed payloads.
+     * \return true if the message was accepted for sending,
+     *         false if the client is not usable.
+     */
+    bool sendBinary(std::vector<uint8_t>&& data, SendFlags flags = SendFlags::NONE);
+
+    /**
+     * \brief Send a shared, immutable binary message.
+     *
+     * The payload is referenced rather than copied, so one buffer can be
+     * fanned out to many clients. It must not be modified afterwards.
+     *
+     * \param data Shared binary payload.
+     * \param flags SendFlags, e.g. NO_COMPRESS for already-compressed payloads.
      * \return true if the message was accepted for sending,
      *         false if the client is not usable.
      */
-    bool sendBinary(const void* data, size_t length);
+    bool sendBinary(std::shared_ptr<const std::vector<uint8_t>> data, SendFlags flags = SendFlags::NONE);
+
+    /**
+     * \brief Send several messages with one enqueue and one flush.
+     *
+     * The messages are framed back to back into one region of the output
+     * buffer and handed to the socket together. The batch is accepted or
+     * rejected as a whole.
+     *
+     * \param items Messages to send, in order.
+     * \param count Number of items.
+     * \param flags SendFlags, applied to every message.
+     * \return true if all messages were accepted for sending,
+     *         false if none were.
+     */
+    bool sendBatch(const BatchItem* items, size_t count, SendFlags flags = SendFlags::NONE);
+
+    /**
+     * \brief Send several text messages with one enqueue and one flush.
+     *
+     * \param messages Text messages to send, in order.
+     * \param flags SendFlags, applied to every message.
+     * \return true if all messages were accepted for sending,
+     *         false if none were.
+     */
+    bool sendBatch(const std::vector<std::string>& messages, SendFlags flags = SendFlags::NONE);
+
+    /**
+     * \brief Hold outgoing messages until uncork().
+     *
+     * Sends keep queueing (subject to backpressure) but nothing is written
+     * to the socket, so a burst can be released as one write. Control
+     * frames and close() are not held.
+     */
+    void cork();
+
+    /**
+     * \brief Release messages held by cork() in a single flush.
+     */
+    void uncork();
 
     /**
      * \brief Set the WebSocket server URL.
@@ -186,13 +311,76 @@ public:
      */
     void setMessageCallback(MessageCallback callback);
 
+    /**
+     * \brief Set zero-copy callback invoked when a text message is received.
+     *
+     * When set, it replaces the message callback. Unfragmented, uncompressed
+     * frames are delivered straight from the receive buffer without copying.
+     * The data pointer is only valid until the callback returns.
+     *
+     * \param callback User callback function receiving a pointer and length.
+     */
+    void setMessageViewCallback(MessageViewCallback callback);
+
     /**
      * \brief Set callback invoked when a binary message is received.
      *
+     * Unfragmented, uncompressed frames are delivered straight from the
+     * receive buffer. The data pointer is only valid until the callback returns.
+     *
      * \param callback User callback function receiving the binary payload.
      */
     void setBinaryCallback(BinaryCallback callback);
 
+    /**
+     * \brief Set streaming callback invoked with message data as it is decoded.
+     *
+     * When set, it replaces the message, view and binary callbacks for all
+     * data messages. Fragmented messages are delivered fragment by fragment
+     * and compressed data is inflated in bounded chunks as it arrives, so
+     * the whole message is never buffered. Each message ends with a call
+     * where final is true
+     * (its chunk may be empty). The data pointer is only valid until the
+     * callback returns. If the connection fails with a protocol error,
+     * the partially delivered message must be discarded.
+     *
+     * \param callback User callback function receiving each chunk.
+     */
+    void setMessageChunkCallback(MessageChunkCallback callback);
+
+    /**
+     * \brief Set callback that takes ownership of each received message.
+     *
+     * When set, it replaces the message, view and binary callbacks and the
+     * listener for data messages; the chunk callback still takes precedence.
+     * The buffer comes from a per-connection pool and may be kept or moved
+     * to another thread. Releasing it, from any thread, returns the memory
+     * to the pool, so a steady stream of messages does not allocate.
+     *
+     * \param callback User callback function receiving the message buffer.
+     */
+    void setMessageBufferCallback(MessageBufferCallback callback);
+
+    /**
+     * \brief Deliver events to a listener object instead of the callbacks.
+     *
+     * While a listener is set it receives open, text (in place), binary,
+     * close, error and writable events, and the corresponding std::function
+     * callbacks are not called. The chunk and stats callbacks still apply.
+     * The listener must outlive the connection; see WebSocketListener.
+     *
+     * \param listener Object deriving from WebSocketListener<Listener>.
+     */
+    template <typename Listener>
+    void setListener(Listener& listener) {
+        setListenerTable(WebSocketListener<Listener>::table(listener));
+    }
+
+    /**
+     * \brief Detach the listener and go back to the std::function callbacks.
+     */
+    void clearListener() { setListenerTable(WebSocketListenerTable()); }
+
     /**
      * \brief Set custom WebSocket handshake headers.
      *
@@ -221,6 +409,17 @@ public:
      */
     void setPingInterval(int interval);
 
+    /**
+     * \brief Fail the connection when a ping goes unanswered.
+     *
+     * \param seconds Time allowed for the pong; a later pong also counts.
+     *                A value of 0 (default) never gives up on the peer.
+     *
+     * \details On expiry the error callback gets ErrorCode::TIMEOUT and the
+     * connection is torn down without a close handshake. Needs setPingInterval().
+     */
+    void setPongTimeout(int seconds);
+
     /**
      * \brief Set the connection timout.
      *
@@ -236,6 +435,153 @@ public:
      */
     void enableCompression(bool enable = true);
 
+    /**
+     * \brief Tune permessage-deflate negotiation and zlib parameters.
+     *
+     * Also enables compression. This method must be called before connect().
+     *
+     * \param options Offer and deflate settings, see WebSocketCompressionOptions.
+     */
+    void setCompressionOptions(const WebSocketCompressionOptions& options);
+
+    /**
+     * \brief Run this client on a shared event loop pool.
+     *
+     * Without a pool every client starts its own event thread.
+     * With a pool the client is assigned one of the pool's loops on connect().
+     * The client keeps a reference to the pool.
+     * This method must be called before connect().
+     *
+     * \param pool Shared pool, or nullptr to go back to a private event thread.
+     */
+    void setEventLoopPool(std::shared_ptr<WebSocketEventLoopPool> pool);
+
+    /**
+     * \brief Create the connection's bufferevent without libevent locking.
+     *
+     * Only the event thread ever touches the bufferevent: sends from other
+     * threads go through the send queue and a wakeup. This drops the
+     * per-operation bufferevent lock and runs read, write and event
+     * callbacks inline instead of deferring them through the loop.
+     * This method must be called before connect().
+     *
+     * \param enable Set to true for single-threaded I/O, false for the
+     *        thread-safe, deferred-callback bufferevent (default).
+     */
+    void setSingleThreadedIO(bool enable = true);
+
+    /**
+     * \brief Set send-side watermarks and the overflow policy.
+     *
+     * This method must be called before connect().
+     *
+     * \param options Backpressure limits, see WebSocketBackpressureOptions.
+     */
+    void setBackpressureOptions(const WebSocketBackpressureOptions& options);
+
+    /**
+     * \brief Set TCP socket options and libevent read/write sizing.
+     *
+     * This method must be called before connect().
+     *
+     * \param options Socket options, see WebSocketSocketOptions.
+     */
+    void setSocketOptions(const WebSocketSocketOptions& options);
+
+    /**
+     * \brief Set address family, Happy Eyeballs and DNS cache behaviour.
+     *
+     * This method must be called before connect().
+     *
+     * \param options Connection setup, see WebSocketConnectOptions.
+     */
+    void setConnectOptions(const WebSocketConnectOptions& options);
+
+    /**
+     * \brief Reconnect automatically, with backoff, after the connection is lost.
+     *
+     * Only disconnect() ends a reconnecting client. Messages sent meanwhile
+     * are queued, subject to the backpressure limits, and go out once the
+     * next connection is open. getStats() counts every attempt.
+     *
+     * This method must be called before connect().
+     *
+     * \param options Backoff and queueing, see WebSocketReconnectOptions.
+     */
+    void setReconnectOptions(const WebSocketReconnectOptions& options);
+
+    /**
+     * \brief Drop every entry of the process-wide DNS cache.
+     */
+    static void clearDnsCache();
+
+    /**
+     * \brief Drop the shared TLS contexts and cached TLS sessions.
+     *
+     * Call after rotating certificate, key or CA files on disk; the
+     * next connect() loads them again.
+     */
+    static void clearTlsCache();
+
+    /**
+     * \brief Set callback invoked when a congested connection drains.
+     *
+     * Fires on the event thread once a send has been refused and the
+     * buffered amount has fallen back to the low watermark.
+     *
+     * \param callback User callback function.
+     */
+    void setWritableCallback(WritableCallback callback);
+
+    /**
+     * \brief Bytes accepted for sending but not yet written to the socket.
+     *
+     * Covers the pending send queue and the connection's output buffer.
+     *
+     * \return Buffered byte count, 0 when not connected.
+     */
+    size_t bufferedAmount() const;
+
+    /**
+     * \brief Snapshot of this client's counters, accumulated across reconnects.
+     *
+     * Lock-free and safe to call from any thread.
+     *
+     * \return Counters and current queue gauges; all zero before the first connect().
+     */
+    WebSocketStats getStats() const;
+
+    /**
+     * \brief Totals over every client in the process, past and present.
+     *
+     * Queue depth and buffered amount are per connection and stay zero here.
+     */
+    static WebSocketStats getGlobalStats();
+
+    /**
+     * \brief Export a snapshot periodically.
+     *
+     * The callback runs on the event thread every interval_ms while
+     * connected; keep it short. This method must be called before connect().
+     *
+     * \param callback User callback, or nullptr to stop exporting.
+     * \param interval_ms Export period in milliseconds.
+     */
+    void setStatsCallback(StatsCallback callback, unsigned int interval_ms = 1000);
+
+    /**
+     * \brief Record how long messages wait before they are framed.
+     *
+     * Each queued message is timestamped when sent and measured when the
+     * event thread writes it into the output buffer; the distribution is
+     * reported as WebSocketStats::sendLatency. Messages sent inline from
+     * the event thread count as zero. This method must be called before
+     * connect().
+     *
+     * \param enable Set to true to track send latency (off by default).
+     */
+    void setSendLatencyTracking(bool enable = true);
+
 private:
     // Connection properties
     std::string host;
@@ -244,19 +590,48 @@ private:
     bool secure;
     bool is_ip_address;
     unsigned int ping_interval = 0;
+    unsigned int pong_timeout = 0;
     unsigned int connection_timeout = 1;
     bool compression_requested = true;
+    bool corked = false;
+    bool single_threaded_io = false;
+    bool send_latency_tracking = false;
 
     static bool isHostIPAddress(const std::string& host);
+    void setListenerTable(const WebSocketListenerTable& table);
 
     OpenCallback open_callback;
     CloseCallback close_callback;
     ErrorCallback error_callback;
     MessageCallback message_callback;
+    MessageViewCallback message_view_callback;
     BinaryCallback binary_callback;
+    WritableCallback writable_callback;
+    MessageChunkCallback message_chunk_callback;
+    MessageBufferCallback message_buffer_callback;
+    StatsCallback stats_callback;
+    WebSocketListenerTable listener;
+    unsigned int stats_interval_ms = 0;
+
+    // Created on first connect() and handed to every connection after it
+    std::shared_ptr<WebSocketCounters> counters;
 
     std::shared_ptr<WebSocketContext> _ctx;
 
+    // Handshake request rendered for the current URL, headers and compression
+    // settings; reused across reconnects, dropped when any of them change
+    std::shared_ptr<const WebSocketHandshake> handshake;
+    std::shared_ptr<WebSocketEventLoopPool> loop_pool;
+
     WebSocketHeaders extra_headers;
     WebSocketTLSOptions tls_options;
+    WebSocketBackpressureOptions backpressure_options;
+    WebSocketSocketOptions socket_options;
+    WebSocketConnectOptions connect_options;
+    WebSocketReconnectOptions reconnect_options;
+    WebSocketCompressionOptions compression_options;
 };
+
+inline WebSocketClient::SendFlags operator|(WebSocketClient::SendFlags a, WebSocketClient::SendFlags b) {
+    return static_cast<WebSocketClient::SendFlags>(static_cast<unsigned>(a) | static_cast<unsigned>(b));
+}
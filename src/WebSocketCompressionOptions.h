@@ -0,0 +1,49 @@
+/*
+ *  WebSocketCompressionOptions.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * \struct WebSocketCompressionOptions
+ * \brief permessage-deflate (RFC 7692) negotiation and zlib tuning
+ *
+ * \details The context takeover and window size fields shape the extension
+ * offer sent in the handshake; the server may tighten them further and the
+ * negotiated values always win. Level, memLevel and strategy only affect
+ * our own deflate stream. Defaults keep context takeover in both directions
+ * with full 32 KB windows, which gives the best ratio on repetitive streams.
+ * minSize and the adaptive fields decide per message whether deflate runs
+ * at all; a message can also opt out with SendFlags::NO_COMPRESS.
+ */
+struct WebSocketCompressionOptions {
+    /**
+     * \brief zlib deflate strategy (see deflateInit2)
+     */
+    enum class Strategy {
+        DEFAULT,      ///< Z_DEFAULT_STRATEGY
+        FILTERED,     ///< Z_FILTERED
+        HUFFMAN_ONLY, ///< Z_HUFFMAN_ONLY
+        RLE,          ///< Z_RLE
+        FIXED         ///< Z_FIXED
+    };
+
+    bool clientNoContextTakeover = false; ///< Reset our compressor after every message
+    bool serverNoContextTakeover = false; ///< Ask the server to reset its compressor after every message
+    int clientMaxWindowBits = 15;         ///< Our LZ77 window, 9..15 (zlib cannot produce 8-bit raw streams)
+    int serverMaxWindowBits = 15;         ///< Window we ask the server to limit itself to, 8..15
+    int level = 6;                        ///< Compression level, 0 (store) .. 9 (best), -1 for zlib default
+    int memLevel = 8;                     ///< zlib memory level, 1..9
+    Strategy strategy = Strategy::DEFAULT; ///< zlib strategy
+
+    size_t minSize = 0;                   ///< Messages shorter than this are sent uncompressed
+    bool adaptive = false;                ///< Stop compressing while recent messages don't shrink
+    double adaptiveMaxRatio = 0.9;        ///< Average compressed/original ratio above which compression backs off
+    unsigned adaptiveProbeInterval = 64;  ///< Messages sent raw before compression is tried again
+
+    bool sharedStreams = false;           ///< Directions without context takeover borrow zlib state per message from a process-wide pool
+};
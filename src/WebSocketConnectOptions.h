@@ -0,0 +1,48 @@
+/*
+ *  WebSocketConnectOptions.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+
+/**
+ * \struct WebSocketConnectOptions
+ * \brief Name resolution and TCP connection establishment
+ *
+ * \details Hostnames are resolved for IPv6 and IPv4 in parallel and the
+ * addresses raced as described in RFC 8305 (Happy Eyeballs v2): IPv6 is
+ * tried first, and every attemptDelayMs another address (alternating
+ * families) is tried alongside until one connects. Answers are kept in a
+ * process-wide cache for their DNS TTL, shared by every client.
+ */
+struct WebSocketConnectOptions {
+    /**
+     * \brief Address families to use
+     */
+    enum class Family {
+        ANY,   ///< IPv6 and IPv4
+        IPV4,  ///< IPv4 only
+        IPV6   ///< IPv6 only
+    };
+
+    Family family = Family::ANY;          ///< Address families to resolve and connect to
+    bool happyEyeballs = true;            ///< Race addresses; false tries them one after another
+    unsigned int attemptDelayMs = 250;    ///< Head start of each attempt before the next one starts
+    unsigned int resolutionDelayMs = 50;  ///< Wait for AAAA after an early A answer before connecting
+
+    bool dnsCache = true;                 ///< Use and fill the process-wide resolver cache
+    unsigned int dnsCacheMinTtl = 0;      ///< Lower bound for cached TTLs, in seconds
+    unsigned int dnsCacheMaxTtl = 300;    ///< Upper bound for cached TTLs (also used for hosts-file answers)
+
+    /**
+     * \brief Pre-resolved IP addresses ("192.0.2.1", "2001:db8::1")
+     *
+     * When set, DNS is skipped and these are connected to instead. The
+     * URL's host is still used for the Host header, SNI and certificate
+     * verification.
+     */
+    std::vector<std::string> addresses;
+};
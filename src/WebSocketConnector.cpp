@@ -0,0 +1,594 @@
+/*
+ *  WebSocketConnector.cpp
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "WebSocketConnector.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+#include "Logger.h"
+
+// A query's callback always runs, also after evdns cancellation, so it
+// gets its own object; owner is cleared when the connector gives up on it.
+struct WebSocketConnector::Query {
+    WebSocketConnector* owner;
+    int family;       // AF_INET6, AF_INET, or AF_UNSPEC for the getaddrinfo fallback
+    Flight* flight;   // the shared DNS request, until it completes
+};
+
+// One evdns request and every query waiting on it. A resolver belongs to
+// one loop, so a flight is only touched from that loop's thread; the lock
+// guards the table, which all loops share.
+struct WebSocketConnector::Flight {
+    evdns_base* dns;
+    std::string host;
+    int family;
+    evdns_request* req;   // null once cancelled or answered
+    std::vector<Query*> waiters;
+};
+
+struct WebSocketConnector::Flights {
+    using Key = std::tuple<evdns_base*, std::string, int>;
+
+    std::mutex mtx;
+    std::map<Key, Flight*> map;   // requests new queries may still join
+
+    void forget(Flight* f) {
+        std::lock_guard<std::mutex> lk(mtx);
+        auto it = map.find(Key(f->dns, f->host, f->family));
+        if (it != map.end() && it->second == f) map.erase(it);
+    }
+};
+
+const unsigned int WebSocketConnector::NEGATIVE_TTL;
+
+WebSocketConnector::Flights& WebSocketConnector::flights() {
+    static Flights* f = new Flights;   // never destroyed: loops may outlive static teardown
+    return *f;
+}
+
+void WebSocketConnector::releaseResolver(evdns_base* dns) {
+    Flights& fl = flights();
+    std::lock_guard<std::mutex> lk(fl.mtx);
+    for (auto it = fl.map.begin(); it != fl.map.end();) {
+        if (std::get<0>(it->first) != dns) {
+            ++it;
+            continue;
+        }
+        for (Query* q : it->second->waiters) delete q;
+        delete it->second;
+        it = fl.map.erase(it);
+    }
+}
+
+struct WebSocketConnector::Attempt {
+    WebSocketConnector* owner;
+    evutil_socket_t fd;
+    event* ev;
+};
+
+WebSocketConnector::WebSocketConnector(event_base* base_, evdns_base* dns_, const WebSocketConnectOptions& options,
+                                       SocketSetup setup_)
+    : base(base_), dns(dns_), opts(options), setup(std::move(setup_)) {
+    timer = evtimer_new(base, &WebSocketConnector::timerCallback, this);
+}
+
+WebSocketConnector::~WebSocketConnector() {
+    cancelAll();
+    if (timer) event_free(timer);
+}
+
+bool WebSocketConnector::parseAddress(const std::string& ip, WebSocketAddress& out) {
+    std::string s = ip;
+    if (s.size() >= 2 && s.front() == '[' && s.back() == ']') s = s.substr(1, s.size() - 2);
+
+    std::memset(&out, 0, sizeof(out));
+
+    sockaddr_in* sin = reinterpret_cast<sockaddr_in*>(&out.addr);
+    if (inet_pton(AF_INET, s.c_str(), &sin->sin_addr) == 1) {
+        sin->sin_family = AF_INET;
+        out.len = sizeof(sockaddr_in);
+        return true;
+    }
+
+    sockaddr_in6* sin6 = reinterpret_cast<sockaddr_in6*>(&out.addr);
+    if (inet_pton(AF_INET6, s.c_str(), &sin6->sin6_addr) == 1) {
+        sin6->sin6_family = AF_INET6;
+        out.len = sizeof(sockaddr_in6);
+        return true;
+    }
+    return false;
+}
+
+bool WebSocketConnector::isLocalhost(const std::string& name) {
+    std::string s(name);
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (!s.empty() && s.back() == '.') s.pop_back();
+
+    static const std::string suffix = ".localhost";
+    return s == "localhost" ||
+           (s.size() > suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0);
+}
+
+bool WebSocketConnector::wants(int family) const {
+    switch (opts.family) {
+        case WebSocketConnectOptions::Family::IPV4: return family == AF_INET;
+        case WebSocketConnectOptions::Family::IPV6: return family == AF_INET6;
+        default:                                    return family == AF_INET || family == AF_INET6;
+    }
+}
+
+void WebSocketConnector::start(const std::string& host_, unsigned short port_, DoneCallback done) {
+    host = host_;
+    port = port_;
+    done_cb = std::move(done);
+
+    // Pre-resolved addresses, or an IP literal: nothing to look up
+    std::vector<WebSocketAddress> given;
+    WebSocketAddress a;
+    if (!opts.addresses.empty()) {
+        for (const std::string& ip : opts.addresses) {
+            if (parseAddress(ip, a) && wants(a.family())) given.push_back(a);
+            else log_error("Ignoring pre-resolved address '%s'", ip.c_str());
+        }
+    } else if (parseAddress(host, a)) {
+        if (wants(a.family())) given.push_back(a);
+    } else if (isLocalhost(host)) {
+        // RFC 6761 section 6.3: never sent to DNS
+        if (wants(AF_INET6) && parseAddress("::1", a)) given.push_back(a);
+        if (wants(AF_INET) && parseAddress("127.0.0.1", a)) given.push_back(a);
+    } else {
+        if (!dns) {
+            fail("No DNS resolver");
+            return;
+        }
+        if (evdns_base_count_nameservers(dns) == 0) {
+            // Hosts file only
+            resolveFallback();
+            return;
+        }
+        if (wants(AF_INET6)) resolve(AF_INET6);
+        if (!finished && wants(AF_INET)) resolve(AF_INET);
+
+        // Every family cached as empty: only the hosts file is left
+        if (!finished && !connecting && !pending6 && !pending4 && v6.empty() && v4.empty()) {
+            resolveFallback();
+        }
+        return;
+    }
+
+    if (given.empty()) {
+        fail("No usable address for " + host);
+        return;
+    }
+    addAddresses(std::move(given));
+    beginConnecting();
+}
+
+void WebSocketConnector::resolve(int family) {
+    if (opts.dnsCache) {
+        std::vector<WebSocketAddress> hit;
+        if (WebSocketDnsCache::instance().lookup(host, family, hit)) {
+            if (hit.empty()) {
+                // Known NODATA: not pending, so the other family does not wait for it
+                log_debug("DNS cache: no %s records for %s", family == AF_INET6 ? "AAAA" : "A", host.c_str());
+                return;
+            }
+            log_debug("DNS cache hit for %s (%s)", host.c_str(), family == AF_INET6 ? "AAAA" : "A");
+            onResolved(family, std::move(hit), 0);
+            return;
+        }
+    }
+
+    Query* q = new Query{ this, family, nullptr };
+    if (family == AF_INET6) { q6 = q; pending6 = true; }
+    else                    { q4 = q; pending4 = true; }
+
+    // Join a request other connectors on this loop already have in flight
+    Flights& fl = flights();
+    {
+        std::lock_guard<std::mutex> lk(fl.mtx);
+        Flight*& slot = fl.map[Flights::Key(dns, host, family)];
+        if (slot) {
+            log_debug("Joining %s query in flight for %s", family == AF_INET6 ? "AAAA" : "A", host.c_str());
+            q->flight = slot;
+            slot->waiters.push_back(q);
+            return;
+        }
+        slot = new Flight{ dns, host, family, nullptr, { q } };
+        q->flight = slot;
+    }
+
+    Flight* f = q->flight;
+    f->req = family == AF_INET6
+        ? evdns_base_resolve_ipv6(dns, host.c_str(), 0, &WebSocketConnector::dnsCallback, f)
+        : evdns_base_resolve_ipv4(dns, host.c_str(), 0, &WebSocketConnector::dnsCallback, f);
+
+    if (!f->req) {
+        // Not submitted, so its callback will never run
+        fl.forget(f);
+        delete f;
+        delete q;
+        if (family == AF_INET6) { q6 = nullptr; pending6 = false; }
+        else                    { q4 = nullptr; pending4 = false; }
+        onResolveFailed(family);
+    }
+}
+
+void WebSocketConnector::storeNegative(int family) {
+    if (!opts.dnsCache) return;
+    const unsigned int ttl = std::min(std::max(NEGATIVE_TTL, opts.dnsCacheMinTtl), opts.dnsCacheMaxTtl);
+    WebSocketDnsCache::instance().store(host, family, std::vector<WebSocketAddress>(), ttl);
+}
+
+void WebSocketConnector::dnsCallback(int result, char type, int count, int ttl, void* addresses, void* arg) {
+    Flight* f = static_cast<Flight*>(arg);
+    flights().forget(f);
+
+    const int family = f->family;
+    std::vector<Query*> waiters;
+    waiters.swap(f->waiters);
+    for (Query* q : waiters) q->flight = nullptr;
+    const std::string host = f->host;
+    delete f;
+
+    std::vector<WebSocketAddress> addrs;
+    if (result == DNS_ERR_NONE && count > 0 && addresses) {
+        addrs.resize(static_cast<size_t>(count));
+        for (int i = 0; i < count; ++i) {
+            WebSocketAddress& a = addrs[i];
+            std::memset(&a, 0, sizeof(a));
+            if (type == DNS_IPv6_AAAA) {
+                sockaddr_in6* sin6 = reinterpret_cast<sockaddr_in6*>(&a.addr);
+                sin6->sin6_family = AF_INET6;
+                std::memcpy(&sin6->sin6_addr, static_cast<const in6_addr*>(addresses) + i, sizeof(in6_addr));
+                a.len = sizeof(sockaddr_in6);
+            } else {
+                sockaddr_in* sin = reinterpret_cast<sockaddr_in*>(&a.addr);
+                sin->sin_family = AF_INET;
+                std::memcpy(&sin->sin_addr, static_cast<const in_addr*>(addresses) + i, sizeof(in_addr));
+                a.len = sizeof(sockaddr_in);
+            }
+        }
+    }
+
+    // The name exists but has no records of this family; failures are not cached
+    const bool nodata = addrs.empty() && (result == DNS_ERR_NONE || result == DNS_ERR_NODATA);
+    if (addrs.empty() && result != DNS_ERR_CANCEL) {
+        log_debug("No %s records for %s (%s)", family == AF_INET6 ? "AAAA" : "A", host.c_str(),
+                  evdns_err_to_string(result));
+    }
+
+    // Each waiter is looked at only when its turn comes: an earlier
+    // waiter's callbacks may cancel or destroy later ones
+    for (Query* q : waiters) {
+        WebSocketConnector* self = q->owner;
+        delete q;
+        if (!self) continue;   // cancelled
+
+        if (family == AF_INET6) { self->q6 = nullptr; self->pending6 = false; }
+        else                    { self->q4 = nullptr; self->pending4 = false; }
+
+        if (addrs.empty()) {
+            if (nodata) self->storeNegative(family);
+            self->onResolveFailed(family);
+        } else {
+            self->onResolved(family, std::vector<WebSocketAddress>(addrs), ttl > 0 ? static_cast<unsigned int>(ttl) : 0);
+        }
+    }
+}
+
+void WebSocketConnector::onResolved(int family, std::vector<WebSocketAddress>&& addrs, unsigned int ttl) {
+    if (ttl && opts.dnsCache) {
+        ttl = std::min(std::max(ttl, opts.dnsCacheMinTtl), opts.dnsCacheMaxTtl);
+        WebSocketDnsCache::instance().store(host, family, addrs, ttl);
+    }
+
+    addAddresses(std::move(addrs));
+    if (finished) return;
+
+    if (connecting) {
+        // Late answer: join the race unless an attempt is about to start anyway
+        if (attempts.empty() || (opts.happyEyeballs && timer_kind == Timer::NONE)) startNextAttempt();
+        return;
+    }
+
+    if (family == AF_INET6 || !pending6) {
+        beginConnecting();
+        return;
+    }
+
+    // A answered first; give AAAA a short head start (RFC 8305 section 3)
+    armTimer(Timer::RESOLUTION_DELAY, opts.resolutionDelayMs);
+}
+
+void WebSocketConnector::onResolveFailed(int family) {
+    if (finished) return;
+
+    if (connecting) {
+        if (attempts.empty()) startNextAttempt();
+        return;
+    }
+
+    if (!v6.empty() || !v4.empty()) {
+        // IPv4 was waiting on this AAAA query
+        if (family == AF_INET6 || !pending6) beginConnecting();
+        return;
+    }
+
+    if (pending6 || pending4) return;
+
+    resolveFallback();
+}
+
+void WebSocketConnector::resolveFallback() {
+    if (fallback_tried) {
+        fail("Failed to resolve " + host);
+        return;
+    }
+    fallback_tried = true;
+
+    evutil_addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = opts.family == WebSocketConnectOptions::Family::IPV4 ? AF_INET :
+                      opts.family == WebSocketConnectOptions::Family::IPV6 ? AF_INET6 : AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+
+    qgai = new Query{ this, AF_UNSPEC, nullptr };
+    evdns_getaddrinfo_request* r = evdns_getaddrinfo(dns, host.c_str(), nullptr, &hints,
+                                                     &WebSocketConnector::gaiCallback, qgai);
+    // Answered from the hosts file, the callback has already run
+    if (qgai) req_gai = r;
+}
+
+void WebSocketConnector::gaiCallback(int result, evutil_addrinfo* res, void* arg) {
+    Query* q = static_cast<Query*>(arg);
+    WebSocketConnector* self = q->owner;
+    delete q;
+
+    std::vector<WebSocketAddress> addrs;
+    if (self && result == 0) {
+        for (evutil_addrinfo* ai = res; ai; ai = ai->ai_next) {
+            if (!self->wants(ai->ai_family) || ai->ai_addrlen > sizeof(sockaddr_storage)) continue;
+            WebSocketAddress a;
+            std::memset(&a, 0, sizeof(a));
+            std::memcpy(&a.addr, ai->ai_addr, ai->ai_addrlen);
+            a.len = static_cast<socklen_t>(ai->ai_addrlen);
+            addrs.push_back(a);
+        }
+    }
+    if (res) evutil_freeaddrinfo(res);
+    if (!self) return;   // cancelled
+
+    self->qgai = nullptr;
+    self->req_gai = nullptr;
+    self->onFallbackResolved(std::move(addrs));
+}
+
+void WebSocketConnector::onFallbackResolved(std::vector<WebSocketAddress>&& addrs) {
+    if (finished) return;
+    if (addrs.empty()) {
+        fail("Failed to resolve " + host);
+        return;
+    }
+
+    // No TTL here (hosts file or system resolver), so cache for the upper
+    // bound; a family missing from an unrestricted answer is cached as empty
+    if (opts.dnsCache) {
+        std::vector<WebSocketAddress> a6, a4;
+        for (const WebSocketAddress& a : addrs) (a.family() == AF_INET6 ? a6 : a4).push_back(a);
+        for (const std::vector<WebSocketAddress>* found : { &a6, &a4 }) {
+            const int family = found == &a6 ? AF_INET6 : AF_INET;
+            if (!found->empty()) WebSocketDnsCache::instance().store(host, family, *found, opts.dnsCacheMaxTtl);
+            else if (opts.family == WebSocketConnectOptions::Family::ANY) storeNegative(family);
+        }
+    }
+
+    addAddresses(std::move(addrs));
+    beginConnecting();
+}
+
+void WebSocketConnector::addAddresses(std::vector<WebSocketAddress>&& addrs) {
+    for (WebSocketAddress& a : addrs) {
+        if (a.family() == AF_INET6) {
+            reinterpret_cast<sockaddr_in6*>(&a.addr)->sin6_port = htons(port);
+            v6.push_back(a);
+        } else {
+            reinterpret_cast<sockaddr_in*>(&a.addr)->sin_port = htons(port);
+            v4.push_back(a);
+        }
+    }
+}
+
+void WebSocketConnector::beginConnecting() {
+    if (connecting || finished) return;
+    connecting = true;
+    startNextAttempt();
+}
+
+void WebSocketConnector::startNextAttempt() {
+    if (finished) return;
+
+    // Starting now supersedes whatever delay was pending
+    if (timer) evtimer_del(timer);
+    timer_kind = Timer::NONE;
+
+    for (;;) {
+        // Alternate families, IPv6 first
+        std::deque<WebSocketAddress>* list = nullptr;
+        if (last_family != AF_INET6 && !v6.empty()) list = &v6;
+        else if (!v4.empty()) list = &v4;
+        else if (!v6.empty()) list = &v6;
+
+        if (!list) {
+            if (attempts.empty() && !pending6 && !pending4) {
+                fail(last_error ? std::string(evutil_socket_error_to_string(last_error)) +
+                                      " (system error " + std::to_string(last_error) + ")"
+                                : "No address to connect to");
+            }
+            return;
+        }
+
+        WebSocketAddress a = list->front();
+        list->pop_front();
+        last_family = a.family();
+
+        char ip[INET6_ADDRSTRLEN] = "?";
+        const void* raw = a.family() == AF_INET6
+            ? static_cast<const void*>(&reinterpret_cast<const sockaddr_in6*>(&a.addr)->sin6_addr)
+            : static_cast<const void*>(&reinterpret_cast<const sockaddr_in*>(&a.addr)->sin_addr);
+        evutil_inet_ntop(a.family(), raw, ip, sizeof(ip));
+        log_debug("Connecting to %s port %u (%zu attempt(s) in flight)", ip, port, attempts.size());
+
+        const evutil_socket_t fd = socket(a.family(), SOCK_STREAM, 0);
+        if (fd < 0) {
+            last_error = EVUTIL_SOCKET_ERROR();
+            continue;
+        }
+        evutil_make_socket_nonblocking(fd);
+        evutil_make_socket_closeonexec(fd);
+        if (setup) setup(fd, a.family());
+
+        if (connect(fd, reinterpret_cast<const sockaddr*>(&a.addr), a.len) == 0) {
+            succeed(fd);
+            return;
+        }
+
+        const int err = EVUTIL_SOCKET_ERROR();
+        if (err != EINPROGRESS && err != EINTR) {
+            // e.g. no IPv6 route: move on at once
+            log_debug("Connect to %s failed immediately: %s", ip, evutil_socket_error_to_string(err));
+            last_error = err;
+            evutil_closesocket(fd);
+            continue;
+        }
+
+        Attempt* at = new Attempt{ this, fd, nullptr };
+        at->ev = event_new(base, fd, EV_WRITE, &WebSocketConnector::attemptCallback, at);
+        if (!at->ev || event_add(at->ev, nullptr) != 0) {
+            if (at->ev) event_free(at->ev);
+            evutil_closesocket(fd);
+            delete at;
+            continue;
+        }
+        attempts.push_back(at);
+
+        if (opts.happyEyeballs) armTimer(Timer::ATTEMPT_DELAY, opts.attemptDelayMs);
+        return;
+    }
+}
+
+void WebSocketConnector::attemptCallback(evutil_socket_t fd, short /*events*/, void* arg) {
+    Attempt* a = static_cast<Attempt*>(arg);
+
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) != 0) err = EVUTIL_SOCKET_ERROR();
+
+    a->owner->onAttemptDone(a, err);
+}
+
+void WebSocketConnector::onAttemptDone(Attempt* a, int error) {
+    attempts.erase(std::remove(attempts.begin(), attempts.end(), a), attempts.end());
+    event_free(a->ev);
+    const evutil_socket_t fd = a->fd;
+    delete a;
+
+    if (error == 0) {
+        succeed(fd);
+        return;
+    }
+
+    log_debug("Connect attempt failed: %s", evutil_socket_error_to_string(error));
+    last_error = error;
+    evutil_closesocket(fd);
+
+    // A failure starts the next attempt without waiting out the delay
+    startNextAttempt();
+}
+
+void WebSocketConnector::armTimer(Timer kind, unsigned int ms) {
+    if (!timer) return;
+    timer_kind = kind;
+    timeval tv;
+    tv.tv_sec = ms / 1000;
+    tv.tv_usec = (ms % 1000) * 1000;
+    evtimer_add(timer, &tv);
+}
+
+void WebSocketConnector::timerCallback(evutil_socket_t /*fd*/, short /*events*/, void* arg) {
+    WebSocketConnector* self = static_cast<WebSocketConnector*>(arg);
+    const Timer kind = self->timer_kind;
+    self->timer_kind = Timer::NONE;
+
+    if (kind == Timer::RESOLUTION_DELAY) self->beginConnecting();
+    else if (kind == Timer::ATTEMPT_DELAY) self->startNextAttempt();
+}
+
+void WebSocketConnector::succeed(evutil_socket_t fd) {
+    finished = true;
+    cancelAll();
+
+    DoneCallback cb = std::move(done_cb);
+    if (cb) cb(fd, std::string());
+    else evutil_closesocket(fd);
+}
+
+void WebSocketConnector::fail(const std::string& error) {
+    finished = true;
+    cancelAll();
+
+    DoneCallback cb = std::move(done_cb);
+    if (cb) cb(-1, error);
+}
+
+void WebSocketConnector::cancelAll() {
+    if (timer) evtimer_del(timer);
+    timer_kind = Timer::NONE;
+
+    // Detach before cancelling: evdns may run the callback right away or later
+    Query* d6 = q6;
+    Query* d4 = q4;
+    q6 = q4 = nullptr;
+    if (qgai) { qgai->owner = nullptr; qgai = nullptr; }
+    pending6 = pending4 = false;
+
+    if (d6) dropQuery(d6);
+    if (d4) dropQuery(d4);
+    if (req_gai) { evdns_getaddrinfo_request* r = req_gai; req_gai = nullptr; evdns_getaddrinfo_cancel(r); }
+
+    for (Attempt* a : attempts) {
+        event_free(a->ev);
+        evutil_closesocket(a->fd);
+        delete a;
+    }
+    attempts.clear();
+}
+
+void WebSocketConnector::dropQuery(Query* q) {
+    q->owner = nullptr;
+
+    // A shared request goes on while any other connector still waits for it
+    Flight* f = q->flight;
+    if (!f || !f->req) return;
+    for (const Query* w : f->waiters) {
+        if (w->owner) return;
+    }
+
+    // Nobody left; the callback still runs and frees the flight
+    flights().forget(f);
+    evdns_request* r = f->req;
+    f->req = nullptr;
+    evdns_cancel_request(f->dns, r);
+}
@@ -0,0 +1,132 @@
+/*
+ *  WebSocketConnector.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+#include <event2/event.h>
+#include <event2/dns.h>
+#include <event2/util.h>
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "WebSocketConnectOptions.h"
+#include "WebSocketDnsCache.h"
+
+/**
+ * \brief Resolves a host and races TCP connects to it (RFC 8305).
+ *
+ * AAAA and A queries go out together. Connecting starts as soon as IPv6
+ * addresses are known, or resolutionDelayMs after IPv4 ones if AAAA is
+ * still outstanding. Attempts alternate families and are staggered by
+ * attemptDelayMs; a failed attempt starts the next one right away. The
+ * first socket to connect wins and every other attempt is dropped.
+ *
+ * Answers come from and go to WebSocketDnsCache, including NODATA ones,
+ * so a family known to be empty costs neither a query nor the resolution
+ * delay. Connectors on one loop that miss the cache for the same name and
+ * family share a single query. Names the DNS server cannot answer are
+ * retried through evdns_getaddrinfo, which also consults the hosts file;
+ * "localhost" never leaves the process.
+ *
+ * Event thread only. Destroying the connector cancels whatever is still
+ * in flight; the done callback is not invoked afterwards.
+ */
+class WebSocketConnector {
+public:
+    /// fd of the connected socket (caller owns it), or -1 with an error
+    using DoneCallback = std::function<void(evutil_socket_t fd, const std::string& error)>;
+    /// Called on every socket before connect(), e.g. to set buffer sizes
+    using SocketSetup = std::function<void(evutil_socket_t fd, int family)>;
+
+    WebSocketConnector(event_base* base, evdns_base* dns, const WebSocketConnectOptions& options,
+                       SocketSetup setup);
+    ~WebSocketConnector();
+
+    WebSocketConnector(const WebSocketConnector&) = delete;
+    WebSocketConnector& operator=(const WebSocketConnector&) = delete;
+
+    /**
+     * \brief Start resolving and connecting; done is invoked exactly once.
+     */
+    void start(const std::string& host, unsigned short port, DoneCallback done);
+
+    /**
+     * \brief Parse an IPv4 or IPv6 literal (brackets allowed).
+     */
+    static bool parseAddress(const std::string& ip, WebSocketAddress& out);
+
+    /**
+     * \brief Forget queries in flight on dns before it is freed without
+     * failing them; no connector may still be using it.
+     */
+    static void releaseResolver(evdns_base* dns);
+
+private:
+    struct Query;
+    struct Flight;
+    struct Flights;
+    struct Attempt;
+
+    // How long a NODATA answer is cached, before the TTL bounds apply
+    static const unsigned int NEGATIVE_TTL = 30;
+
+    enum class Timer { NONE, RESOLUTION_DELAY, ATTEMPT_DELAY };
+
+    void resolve(int family);
+    void resolveFallback();
+    void onResolved(int family, std::vector<WebSocketAddress>&& addrs, unsigned int ttl);
+    void onResolveFailed(int family);
+    void storeNegative(int family);
+    void onFallbackResolved(std::vector<WebSocketAddress>&& addrs);
+
+    void addAddresses(std::vector<WebSocketAddress>&& addrs);
+    void beginConnecting();
+    void startNextAttempt();
+    void onAttemptDone(Attempt* a, int error);
+    void armTimer(Timer kind, unsigned int ms);
+    void succeed(evutil_socket_t fd);
+    void fail(const std::string& error);
+    void cancelAll();
+    void dropQuery(Query* q);
+    static Flights& flights();
+    bool wants(int family) const;
+    static bool isLocalhost(const std::string& name);
+
+    static void dnsCallback(int result, char type, int count, int ttl, void* addresses, void* arg);
+    static void gaiCallback(int result, evutil_addrinfo* res, void* arg);
+    static void attemptCallback(evutil_socket_t fd, short events, void* arg);
+    static void timerCallback(evutil_socket_t fd, short events, void* arg);
+
+    event_base* base;
+    evdns_base* dns;
+    WebSocketConnectOptions opts;
+    SocketSetup setup;
+    DoneCallback done_cb;
+
+    std::string host;
+    unsigned short port = 0;
+
+    // In-flight queries; each Query outlives cancellation until its callback runs
+    Query* q6 = nullptr;
+    Query* q4 = nullptr;
+    Query* qgai = nullptr;
+    evdns_getaddrinfo_request* req_gai = nullptr;
+    bool pending6 = false;
+    bool pending4 = false;
+    bool fallback_tried = false;
+
+    std::deque<WebSocketAddress> v6, v4;
+    int last_family = 0;
+    bool connecting = false;
+    bool finished = false;
+
+    std::vector<Attempt*> attempts;
+    event* timer = nullptr;
+    Timer timer_kind = Timer::NONE;
+    int last_error = 0;
+};
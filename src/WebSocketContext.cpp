@@ -5,74 +5,60 @@
  */
 #include "WebSocketContext.h"
 #include "Logger.h"
+#include "WebSocketFrame.h"
 #ifdef USE_TLS
   #include <openssl/ssl.h>
   #include <openssl/sha.h>
   #include <openssl/err.h>
 #endif
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/tcp.h>
+#include <cerrno>
+#include <cmath>
 //#include <sstream>
 
-static std::once_flag g_evthread_once;
+const size_t WebSocketContext::MAX_FLUSH_EXTENT;
+const size_t WebSocketContext::PING_PAYLOAD_SIZE;
 
-WebSocketContext::WebSocketContext(const Config& cfg) : _cfg(cfg), receiver(*this) {
-    key = getWebSocketKey();
-    accept = computeAccept(key);
-}
+static const char PING_MAGIC[4] = { 'L', 'W', 'S', 'C' };
 
-WebSocketContext::~WebSocketContext() {
-    stop();
-}
+WebSocketContext::WebSocketContext(const Config& cfg)
+    : _cfg(cfg), receiver(*this), send_queue(cfg.backpressure.maxQueuedMessages), counters(cfg.counters) {
+    // Seeded once; every attempt draws its handshake key from here
+    key_rng.seed(std::random_device{}());
 
-void WebSocketContext::cleanup() {
-    if (close_timer) {
-        evtimer_del(close_timer);
-        event_free(close_timer);
-        close_timer = nullptr;
-    }
+    callback_sets.emplace_back(new Callbacks);
+    callbacks.store(callback_sets.back().get(), std::memory_order_release);
 
-    if (ping_event) {
-        event_del(ping_event);
-        event_free(ping_event);
-        ping_event = nullptr;
-    }
+    if (!counters) counters = std::make_shared<WebSocketCounters>();
+    receiver.setCounters(counters.get());
 
-    if (timeout_event) {
-        event_del(timeout_event);
-        event_free(timeout_event);
-        timeout_event = nullptr;
-    }
+    if (_cfg.ping_interval > 0) rtt_histogram = counters->rttHistogram(true);
+    if (_cfg.send_latency_tracking) send_latency = counters->sendLatencyHistogram(true);
 
-    if (_bev) {
-        if (_cfg.secure) {
-#ifdef USE_TLS
-            // Internally handled by libevent
-            SSL* ssl = bufferevent_openssl_get_ssl(_bev);
-            if (ssl) {
-                SSL_set_shutdown(ssl, SSL_RECEIVED_SHUTDOWN);
-                SSL_shutdown(ssl);
-            }
-#endif
-        }
-        bufferevent_disable(_bev, EV_READ | EV_WRITE);
-        bufferevent_setcb(_bev, nullptr, nullptr, nullptr, nullptr);
-        bufferevent_free(_bev);
-        _bev = nullptr;
+    if (!_cfg.handshake) {
+        _cfg.handshake = std::make_shared<WebSocketHandshake>(_cfg.host, _cfg.port, _cfg.uri, _cfg.headers,
+                                                              _cfg.compression_requested, _cfg.compression);
     }
+}
 
-    if (dns_base) {
-        evdns_base_free(dns_base, 0);
-        dns_base = nullptr;
-    }
+WebSocketContext::~WebSocketContext() {
+    stop();
+}
+
+void WebSocketContext::cleanup() {
+    closeTransport();
+    if (timers) timers->cancel(reconnect_timer);
 
     event* wev = nullptr;
     event* sev = nullptr;
-    event_base* b = nullptr;
 
     {
         std::lock_guard<std::mutex> lk(base_mutex);
         wev = wakeup_event;
         sev = send_event;
-        b = base;
 
         wakeup_event = nullptr;
         send_event = nullptr;
@@ -89,59 +75,137 @@ void WebSocketContext::cleanup() {
         event_free(sev);
     }
 
-    if (b) {
-        event_base_free(b);
+    // event_base and resolver belong to the loop
+}
+
+void WebSocketContext::closeTransport() {
+    // event-thread only; what one connection attempt owns
+    if (timers) {
+        timers->cancel(close_timer);
+        timers->cancel(ping_timer);
+        timers->cancel(pong_timer);
+        timers->cancel(stats_timer);
+        timers->cancel(timeout_timer);
+    }
+
+    // Closes any socket still connecting
+    connector.reset();
+
+    if (_bev) {
+        if (_cfg.secure) {
+#ifdef USE_TLS
+            // Internally handled by libevent
+            SSL* ssl = bufferevent_openssl_get_ssl(_bev);
+            if (ssl) {
+                SSL_set_shutdown(ssl, SSL_RECEIVED_SHUTDOWN);
+                SSL_shutdown(ssl);
+            }
+#endif
+        }
+        bufferevent_disable(_bev, EV_READ | EV_WRITE);
+        bufferevent_setcb(_bev, nullptr, nullptr, nullptr, nullptr);
+        bufferevent_free(_bev);
+        _bev = nullptr;
+        output_bytes.store(0, std::memory_order_relaxed);
+        counters->output_bytes.store(0, std::memory_order_relaxed);
     }
 }
 
-void WebSocketContext::setOpenCallback(OpenCallback cb) {
+template <typename Edit>
+void WebSocketContext::updateCallbacks(Edit&& edit) {
     std::lock_guard<std::mutex> lk(cb_mutex);
-    on_open = std::move(cb);
+    std::unique_ptr<Callbacks> next(new Callbacks(*callbacks.load(std::memory_order_relaxed)));
+    edit(*next);
+    const Callbacks* published = next.get();
+    callback_sets.emplace_back(std::move(next));
+    callbacks.store(published, std::memory_order_release);
+}
+
+void WebSocketContext::setCallbacks(const Callbacks& cbs) {
+    updateCallbacks([&](Callbacks& c) { c = cbs; });
+}
+
+void WebSocketContext::setListener(const WebSocketListenerTable& listener) {
+    updateCallbacks([&](Callbacks& c) { c.listener = listener; });
+}
+
+void WebSocketContext::setOpenCallback(OpenCallback cb) {
+    updateCallbacks([&](Callbacks& c) { c.on_open = std::move(cb); });
 }
 
 void WebSocketContext::setErrorCallback(ErrorCallback cb) {
-    std::lock_guard<std::mutex> lk(cb_mutex);
-    on_error = std::move(cb);
+    updateCallbacks([&](Callbacks& c) { c.on_error = std::move(cb); });
 }
 
 void WebSocketContext::setCloseCallback(CloseCallback cb) {
-    std::lock_guard<std::mutex> lk(cb_mutex);
-    on_close = std::move(cb);
+    updateCallbacks([&](Callbacks& c) { c.on_close = std::move(cb); });
 }
 
 void WebSocketContext::setMessageCallback(MessageCallback cb) {
-    std::lock_guard<std::mutex> lk(cb_mutex);
-    on_message = std::move(cb);
+    updateCallbacks([&](Callbacks& c) { c.on_message = std::move(cb); });
+}
+
+void WebSocketContext::setMessageViewCallback(MessageViewCallback cb) {
+    updateCallbacks([&](Callbacks& c) { c.on_message_view = std::move(cb); });
 }
 
 void WebSocketContext::setBinaryCallback(BinaryCallback cb) {
-    std::lock_guard<std::mutex> lk(cb_mutex);
-    on_binary = std::move(cb);
+    updateCallbacks([&](Callbacks& c) { c.on_binary = std::move(cb); });
 }
 
-void WebSocketContext::libeventThreads() {
-    std::call_once(g_evthread_once, []() {
-        evthread_use_pthreads();
-    });
+void WebSocketContext::setMessageChunkCallback(MessageChunkCallback cb) {
+    updateCallbacks([&](Callbacks& c) { c.on_chunk = std::move(cb); });
+}
+
+void WebSocketContext::setMessageBufferCallback(MessageBufferCallback cb) {
+    updateCallbacks([&](Callbacks& c) { c.on_buffer = std::move(cb); });
+}
+
+void WebSocketContext::setStatsCallback(StatsCallback cb) {
+    updateCallbacks([&](Callbacks& c) { c.on_stats = std::move(cb); });
+}
+
+void WebSocketContext::setWritableCallback(WritableCallback cb) {
+    updateCallbacks([&](Callbacks& c) { c.on_writable = std::move(cb); });
 }
 
 void WebSocketContext::start() {
     auto self = shared_from_this();
 
-    libeventThreads();
+    _loop = _cfg.loop;
+    if (!_loop) {
+        // No pool: this connection gets its own loop and thread
+        auto loop = std::make_shared<WebSocketEventLoop>();
+        std::string err;
+        if (!loop->start(err)) {
+            log_error("%s", err.c_str());
+            sendError(ErrorCode::IO, err);
+            return;
+        }
+        _loop = loop;
+        owns_loop = true;
+    }
+
+    event_tid = _loop->threadId();
+
+    // Queue sends from now on, until the handshake completes
+    connection_state.store(ConnectionState::CONNECTING, std::memory_order_release);
+    started.store(true, std::memory_order_release);
+    _loop->attach();
 
-    event_thread = std::thread([self]() {
+    _loop->post([self]() {
         self->run();
     });
 }
 
 void WebSocketContext::run() {
 
-    event_tid = std::this_thread::get_id();
+    self_ref = shared_from_this();
 
-    /*std::ostringstream oss;
-    oss << event_tid;
-    log_debug("event thread started, tid=%s", oss.str().c_str());*/
+    if (stop_requested.load(std::memory_order_acquire)) {
+        finish();
+        return;
+    }
 
     if (running.load()) {
         log_debug("Already connected or connecting");
@@ -151,27 +215,78 @@ void WebSocketContext::run() {
     if (_cfg.host.empty() || _cfg.port <= 0) {
         log_error("setUrl() must be called before connect(): invalid host or port");
         sendError(ErrorCode::CONNECT_FAILED, "Invalid host or port");
+        finish();
         return;
     }
 
-#ifdef USE_TLS
-    SSL *ssl = nullptr;
-#endif
-
     if(_cfg.secure) {
 #ifdef USE_TLS
+        // Kept for every attempt: one cache lookup, not one per reconnect
         std::string err;
         if (!_tls.init(_cfg.tls, err)) {
             log_error("TLS init failed: %s", err.c_str());
             sendError(ErrorCode::TLS_INIT_FAILED, "Failed to initialize TLS");
+            finish();
             return;
         }
+#else 
+        log_error("TLS support not compiled in (USE_TLS=OFF), proceeding in insecure mode");
+        _cfg.secure = false;
+#endif
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(base_mutex);
+        base = _loop->base();
+    }
+    timers = &_loop->timers();
+
+    event* wev = event_new(base, -1, 0, &WebSocketContext::wakeupCallback, this);
+    event* sev = event_new(base, -1, EV_PERSIST, &WebSocketContext::sendCallback, this);
+
+    {
+        std::lock_guard<std::mutex> lk(base_mutex);
+        wakeup_event = wev;
+        send_event   = sev;
+    }
+
+    if (wev) event_add(wev, nullptr);
+    else { log_error("Failed to create wakeup_event"); finish(); return; }
+    
+    if (sev) event_add(sev, nullptr);
+    else { log_error("Failed to create send_event"); finish(); return; }
+
+    // stop() may have run before wakeup_event was published
+    if (stop_requested.load(std::memory_order_acquire)) {
+        requestWakeup();
+    }
 
-        ssl = _tls.createSsl(err);
+    // From here on a failed attempt is retried when reconnect is enabled
+    retry_allowed = true;
+    connectAttempt();
+}
+
+void WebSocketContext::connectAttempt() {
+    // event-thread only; the loop, wakeup and send events outlive attempts
+    connect_started = std::chrono::steady_clock::now();
+    WebSocketCounters::add(counters->connects);
+
+    // A fresh nonce for every connection (RFC 6455 4.1)
+    key = getWebSocketKey();
+    accept = computeAccept(key);
+
+#ifdef USE_TLS
+    SSL *ssl = nullptr;
+
+    if (_cfg.secure) {
+        std::string err;
+
+        // Offers the last session ticket from this host and port, if any
+        ssl = _tls.createSsl(_cfg.host + ":" + std::to_string(_cfg.port), err);
         if (!ssl) {
             log_error("TLS SSL_new failed: %s", err.c_str());
             sendError(ErrorCode::TLS_INIT_FAILED, "Failed SSL context creation");
-            _tls.reset();
+            finish();
             return;
         }
 
@@ -187,123 +302,254 @@ void WebSocketContext::run() {
                     log_error("Failed to set hostname for verification");
                     sendError(ErrorCode::TLS_INIT_FAILED, "Failed hostname verification setup");
                     SSL_free(ssl);
-                    _tls.reset();
+                    finish();
                     return;
                 }
             }
         }
-#else 
-        log_error("TLS support not compiled in (USE_TLS=OFF), proceeding in insecure mode");
-        _cfg.secure = false;
-#endif
     }
+#endif
 
-    connection_state.store(ConnectionState::CONNECTING, std::memory_order_release);
-
-    base = event_base_new();
-    if (!base) {
-        log_error("Failed to create event_base");
-        sendError(ErrorCode::IO, "Failed to create event_base");
-        return;
+    // IP literals and pre-resolved addresses need no resolver; the loop
+    // creates its shared one on first use
+    evdns_base* dns_base = nullptr;
+    if (!_cfg.is_ip_address && _cfg.connect.addresses.empty()) {
+        dns_base = _loop->dnsBase();
+        if (!dns_base) {
+            sendError(ErrorCode::IO, "Failed to create DNS base");
+#ifdef USE_TLS
+            if (ssl) SSL_free(ssl);
+#endif
+            finish();
+            return;
+        }
     }
 
-    dns_base = evdns_base_new(base, 1);
-    if (!dns_base) {
-        log_error("Failed to create DNS base");
-        sendError(ErrorCode::IO, "Failed to create DNS base");
-        event_base_free(base);
-        base = nullptr;
-        return;
-    }
+    // Every bufferevent call happens on the event thread (other threads only
+    // queue and wake it), so the lock and the deferred callbacks are optional
+    const int bev_opts = BEV_OPT_CLOSE_ON_FREE |
+                         (_cfg.single_threaded_io ? 0 : BEV_OPT_DEFER_CALLBACKS | BEV_OPT_THREADSAFE);
 
     if (_cfg.secure) {
 #ifdef USE_TLS
-        _bev = bufferevent_openssl_socket_new(base, -1, ssl, BUFFEREVENT_SSL_CONNECTING, BEV_OPT_CLOSE_ON_FREE | BEV_OPT_DEFER_CALLBACKS | BEV_OPT_THREADSAFE);
+        _bev = bufferevent_openssl_socket_new(base, -1, ssl, BUFFEREVENT_SSL_CONNECTING, bev_opts);
         if (!_bev) {
             log_error("Failed to create secure bufferevent");
             SSL_free(ssl); // because _bev didn't take ownership.
-            _tls.reset();
-            cleanup();
+            finish();
             return;
         }
 #endif
     } else {
-        _bev = bufferevent_socket_new(base, -1, BEV_OPT_CLOSE_ON_FREE | BEV_OPT_DEFER_CALLBACKS | BEV_OPT_THREADSAFE);
+        _bev = bufferevent_socket_new(base, -1, bev_opts);
         if (!_bev) {
             log_error("Failed to create bufferevent");
             sendError(ErrorCode::IO, "Failed to create bufferevent");
-            cleanup();
+            finish();
             return;
         }
     }
     
-    event* wev = event_new(base, -1, 0, &WebSocketContext::wakeupCallback, this);
-    event* sev = event_new(base, -1, EV_PERSIST, &WebSocketContext::sendCallback, this);
+    if (_cfg.connection_timeout > 0) {
+        timers->schedule(timeout_timer, uint64_t(_cfg.connection_timeout) * 1000);
+    }
 
-    {
-        std::lock_guard<std::mutex> lk(base_mutex);
-        wakeup_event = wev;
-        send_event   = sev;
+    // The first ping lands anywhere in the second half of the interval, so
+    // connections opened together do not ping, and flush, in the same tick
+    if (_cfg.ping_interval > 0) {
+        const uint64_t interval_ms = uint64_t(_cfg.ping_interval) * 1000;
+        timers->schedule(ping_timer, interval_ms / 2 + timers->jitter(interval_ms / 2));
     }
 
-    if (wev) event_add(wev, nullptr);
-    else { log_error("Failed to create wakeup_event"); cleanup(); return; }
-    
-    if (sev) event_add(sev, nullptr);
-    else { log_error("Failed to create send_event"); cleanup(); return; }
+    if (_cfg.stats_interval_ms > 0) {
+        timers->schedule(stats_timer, _cfg.stats_interval_ms);
+    }
 
-    
-    struct timeval timeout;
-    timeout.tv_sec = _cfg.connection_timeout;
-    timeout.tv_usec = 0;
-    
+    bufferevent_setcb(_bev, &WebSocketContext::readCallback, &WebSocketContext::writeCallback, &WebSocketContext::eventCallback, this);
 
-    timeout_event = event_new(base, -1, 0, timeoutCallback, this);
-    event_add(timeout_event, &timeout);
-    
+    if (_cfg.socket.maxSingleRead) {
+        bufferevent_set_max_single_read(_bev, _cfg.socket.maxSingleRead);
+    }
+    if (_cfg.socket.maxSingleWrite) {
+        bufferevent_set_max_single_write(_bev, _cfg.socket.maxSingleWrite);
+    }
 
-    if (_cfg.ping_interval > 0) {
-        struct timeval tv;
-	    tv.tv_sec = _cfg.ping_interval;
-  	    tv.tv_usec = 0;
+    // Write callback fires once the output buffer drains to the low watermark
+    bufferevent_setwatermark(_bev, EV_WRITE, _cfg.backpressure.effectiveLowWatermark(), 0);
+
+    bufferevent_enable(_bev, EV_READ | EV_WRITE);
 
-        ping_event = event_new(base, -1, EV_PERSIST, pingCallback, this);
-        evtimer_add(ping_event, &tv);
+    running.store(true, std::memory_order_release);
+
+    connector.reset(new WebSocketConnector(base, dns_base, _cfg.connect,
+        [this](evutil_socket_t fd, int family) { applySocketOptions(fd, family); }));
+    connector->start(_cfg.host, _cfg.port,
+        [this](evutil_socket_t fd, const std::string& error) { onTcpConnected(fd, error); });
+}
+
+void WebSocketContext::onTcpConnected(evutil_socket_t fd, const std::string& error) {
+    if (fd < 0) {
+        log_error("Connect to %s failed: %s", _cfg.host.c_str(), error.c_str());
+        sendError(ErrorCode::CONNECT_FAILED, error);
+        discardOnFailure();
+
+        connection_state.store(ConnectionState::DISCONNECTING, std::memory_order_release);
+        requestTeardown();
+        return;
     }
 
-    bufferevent_setcb(_bev, &WebSocketContext::readCallback, /*writeCallback*/nullptr, &WebSocketContext::eventCallback, this);
+    counters->last_connect_us.store(WebSocketCounters::elapsedNs(connect_started) / 1000, std::memory_order_relaxed);
 
-    bufferevent_enable(_bev, EV_READ | EV_WRITE);
+    // _bev owns the socket from here (BEV_OPT_CLOSE_ON_FREE)
+    if (bufferevent_setfd(_bev, fd) != 0) {
+        evutil_closesocket(fd);
+        sendError(ErrorCode::CONNECT_FAILED, "Failed to attach socket");
+        discardOnFailure();
 
-    if (bufferevent_socket_connect_hostname(_bev, dns_base, AF_INET, _cfg.host.c_str(), _cfg.port) < 0) {
-        log_error("Failed to start connection");
-        sendError(ErrorCode::CONNECT_FAILED, "Failed to start connection");
-        cleanup();
+        connection_state.store(ConnectionState::DISCONNECTING, std::memory_order_release);
+        requestTeardown();
         return;
     }
 
-    running.store(true, std::memory_order_release);
-    event_base_dispatch(base);
+    // TLS reports CONNECTED itself once its handshake, started by setfd, is done
+    if (!_cfg.secure) {
+        handleEvent(_bev, BEV_EVENT_CONNECTED);
+    }
+}
 
-    log_debug("event loop exited, proceeding to cleanup()");
-    running.store(false, std::memory_order_release);
+bool WebSocketContext::shouldReconnect() const {
+    const WebSocketReconnectOptions& ro = _cfg.reconnect;
+    return ro.enabled && retry_allowed && !user_stop.load(std::memory_order_acquire) &&
+           (ro.maxAttempts == 0 || reconnect_failures < ro.maxAttempts);
+}
+
+uint64_t WebSocketContext::reconnectDelayMs() {
+    const WebSocketReconnectOptions& ro = _cfg.reconnect;
+
+    const unsigned steps = std::min(reconnect_failures - 1, 64u);
+    const double delay = std::min(ro.initialDelayMs * std::pow(std::max(ro.multiplier, 1.0), steps),
+                                  static_cast<double>(ro.maxDelayMs));
+    const double jitter = std::max(0.0, std::min(ro.jitter, 1.0));
 
+    // Up to the jitter fraction comes off, so a herd spreads below the cap too
+    const uint64_t ms = static_cast<uint64_t>(delay);
+    return ms - timers->jitter(static_cast<uint64_t>(ms * jitter));
+}
+
+void WebSocketContext::resetSession() {
+    upgraded.store(false, std::memory_order_release);
+    use_compression = false;
+    close_sent = false;
+    close_received = false;
+    protocol_failed.store(false, std::memory_order_release);
+    close_cb_fired.store(false, std::memory_order_release);
+    teardown_posted = false;
+    read_low_watermark = 0;
+    pong_seq = ping_seq;   // pongs to the old connection's pings never come
+    pong_awaited = 0;
+    receiver.reset();
+
+    // stop() sets user_stop first, so a stop racing with this store still ends the client
+    stop_requested.store(user_stop.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+void WebSocketContext::scheduleReconnect() {
+    // event-thread only; the loop, events and send queue stay
+    closeTransport();
+    resetSession();
+    if (!_cfg.reconnect.keepQueue) discardSendQueue();
+
+    ++reconnect_failures;
+    const uint64_t delay = reconnectDelayMs();
+    log_debug("Reconnecting to %s:%d in %llu ms (attempt %u)", _cfg.host.c_str(), _cfg.port,
+              static_cast<unsigned long long>(delay), reconnect_failures);
+
+    // Sends queue meanwhile, as before the first handshake
+    connection_state.store(ConnectionState::CONNECTING, std::memory_order_release);
+    timers->schedule(reconnect_timer, delay);
+
+    wakeBlockedSenders();
+}
+
+void WebSocketContext::reconnectCallback(void* arg) {
+    auto* self = static_cast<WebSocketContext*>(arg);
+    if (self->user_stop.load(std::memory_order_acquire)) {
+        self->finish();
+        return;
+    }
+    self->connectAttempt();
+}
+
+void WebSocketContext::discardOnFailure() {
+    // A reconnect that keeps the queue sends it on the next connection
+    const WebSocketReconnectOptions& ro = _cfg.reconnect;
+    if (ro.enabled && ro.keepQueue && !user_stop.load(std::memory_order_acquire)) return;
+    discardSendQueue();
+}
+
+void WebSocketContext::finish() {
+    // event-thread only, runs once
+    if (finished) return;
+
+    // A connection lost on its own is retried; the context lives on
+    if (shouldReconnect()) {
+        scheduleReconnect();
+        return;
+    }
+
+    // Given up or stopped: a kept queue has no connection left to go out on
+    if (_cfg.reconnect.enabled) discardSendQueue();
+
+    // Dropped at scope exit; may destroy this context
+    auto keep = std::move(self_ref);
+
+    running.store(false, std::memory_order_release);
     cleanup();
+
+    const auto st = connection_state.load(std::memory_order_acquire);
+    if (st != ConnectionState::FAILED) {
+        connection_state.store(ConnectionState::DISCONNECTED, std::memory_order_release);
+    }
+
+    _loop->detach();
+    if (owns_loop) {
+        _loop->stop();
+    }
+
+    log_debug("connection detached from event loop");
+
+    {
+        std::lock_guard<std::mutex> lk(finish_mutex);
+        finished = true;
+    }
+    finish_cv.notify_all();
+
+    // Senders blocked on backpressure give up once the connection is gone
+    wakeBlockedSenders();
 }
 
 void WebSocketContext::stop() {
+    user_stop.store(true, std::memory_order_release);
     stop_requested.store(true, std::memory_order_release);
 
     requestWakeup();
 
-    const bool on_event_thread = (std::this_thread::get_id() == event_tid);
+    if (!started.load(std::memory_order_acquire)) {
+        return;
+    }
 
-    if (event_thread.joinable()) {
-        if (!on_event_thread) {
-            event_thread.join();
-        } else {
-            event_thread.detach();
-        }
+    // On the loop thread teardown completes asynchronously
+    if (_loop->isLoopThread()) {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lk(finish_mutex);
+        finish_cv.wait(lk, [this]() { return finished; });
+    }
+
+    if (owns_loop) {
+        _loop->stop();  // join the private event thread
     }
 }
 
@@ -319,7 +565,7 @@ void WebSocketContext::stopNow() {
     if (!can_handshake || st != ConnectionState::CONNECTED) {
         // Abort, nothing to handshake
         connection_state.store(ConnectionState::DISCONNECTED, std::memory_order_release);
-        requestLoopExit();
+        requestTeardown();
         return;
     }
 
@@ -327,7 +573,7 @@ void WebSocketContext::stopNow() {
     close();
 }
 
-void WebSocketContext::timeoutCallback(evutil_socket_t /*fd*/, short /*event*/, void *arg) {
+void WebSocketContext::timeoutCallback(void *arg) {
     auto* self = static_cast<WebSocketContext*>(arg);
     log_debug("timeoutCallback entered");
     
@@ -341,20 +587,44 @@ void WebSocketContext::timeoutCallback(evutil_socket_t /*fd*/, short /*event*/,
     self->sendError(ErrorCode::TIMEOUT, "Timeout");
 
     // Connect/handshake timeout -> abort shutdown (no WS CLOSE possible)
-    self->requestLoopExit();
+    self->requestTeardown();
 }
 
-void WebSocketContext::pingCallback(evutil_socket_t /*fd*/, short /*event*/, void *arg) {
+void WebSocketContext::pingCallback(void *arg) {
     auto* self = static_cast<WebSocketContext*>(arg);
+    self->timers->schedule(self->ping_timer, uint64_t(self->_cfg.ping_interval) * 1000);
     self->sendPing();
 }
 
+void WebSocketContext::pongTimeoutCallback(void *arg) {
+    auto* self = static_cast<WebSocketContext*>(arg);
+    if (self->pong_seq >= self->pong_awaited) return;
+
+    const auto st = self->connection_state.load(std::memory_order_acquire);
+    if (st == ConnectionState::DISCONNECTING || st == ConnectionState::DISCONNECTED) {
+        return;
+    }
+
+    // The peer or the path is gone; a close handshake would only wait too
+    log_error("No pong for ping %u within %u s", self->pong_awaited, self->_cfg.pong_timeout);
+    self->sendError(ErrorCode::TIMEOUT, "Pong timeout");
+    self->requestTeardown();
+}
+
+void WebSocketContext::statsCallback(void *arg) {
+    auto* self = static_cast<WebSocketContext*>(arg);
+    self->timers->schedule(self->stats_timer, self->_cfg.stats_interval_ms);
+
+    const Callbacks& cbs = self->currentCallbacks();
+    if (cbs.on_stats) cbs.on_stats(self->stats());
+}
+
 void WebSocketContext::wakeupCallback(evutil_socket_t, short, void* arg) {
     auto* self = static_cast<WebSocketContext*>(arg);
     if (!self->base) return;
 
     // If shutdown was requested, initiate shutdown logic ONCE.
-    if (self->stop_requested.load(std::memory_order_acquire)) {
+    if (self->stop_requested.load(std::memory_order_acquire) || self->user_stop.load(std::memory_order_acquire)) {
         self->stopNow();     // does NOT necessarily exit loop immediately
         return;              // do NOT flush app data on shutdown request
     }
@@ -362,7 +632,7 @@ void WebSocketContext::wakeupCallback(evutil_socket_t, short, void* arg) {
     self->flushSendQueue();
 }
 
-void WebSocketContext::closeTimerCb(evutil_socket_t, short, void* arg) {
+void WebSocketContext::closeTimerCb(void* arg) {
     auto* self = static_cast<WebSocketContext*>(arg);
     // If peer already replied with CLOSE, nothing to do.
     if (self->close_received) {
@@ -375,7 +645,7 @@ void WebSocketContext::closeTimerCb(evutil_socket_t, short, void* arg) {
     self->connection_state.store(ConnectionState::DISCONNECTED, std::memory_order_release);
 
     // Peer did not complete close handshake in time -> force shutdown.
-    self->requestLoopExit();
+    self->requestTeardown();
 }
 
 void WebSocketContext::sendCallback(evutil_socket_t /*fd*/, short /*events*/, void* arg)
@@ -383,9 +653,16 @@ void WebSocketContext::sendCallback(evutil_socket_t /*fd*/, short /*events*/, vo
     auto* self = static_cast<WebSocketContext*>(arg);
     if (!self || !self->base) return;
 
-    self->flushSendQueue();
-    // After flushing mark the flag
+    // Clear before draining: a push racing with the drain schedules another flush
     self->send_flush_pending.store(false, std::memory_order_release);
+    self->flushSendQueue();
+}
+
+void WebSocketContext::writeCallback(bufferevent* /*bev*/, void* ctx) {
+    auto* self = static_cast<WebSocketContext*>(ctx);
+    if (!self) return;
+
+    self->updateBackpressure();
 }
 
 void WebSocketContext::eventCallback(bufferevent* bev, short events, void* ctx) {
@@ -407,22 +684,32 @@ inline void WebSocketContext::requestWakeup() {
     if (ev) event_active(ev, 0, 0);
 }
 
-inline void WebSocketContext::requestLoopExit() {
+inline void WebSocketContext::requestTeardown() {
     stop_requested.store(true, std::memory_order_release);
 
-    // If we're already on the event thread, exit the loop immediately.
+    // On the event thread, tear down once the current callbacks have returned.
     if (std::this_thread::get_id() == event_tid && base) {
-        timeval tv{0, 0};
-        event_base_loopexit(base, &tv);
+        if (teardown_posted) return;
+        teardown_posted = true;
+
+        auto self = shared_from_this();
+        _loop->post([self]() {
+            self->finish();
+        });
         return;
     }
 
-    // Otherwise, wake the event thread so it can call loopexit.
+    // Otherwise, wake the event thread so it can tear down.
     requestWakeup();
 }
 
 inline void WebSocketContext::requestSendFlush()
 {
+    // setCorked(false) flushes whatever piled up meanwhile
+    if (corked.load(std::memory_order_acquire) &&
+        connection_state.load(std::memory_order_acquire) == ConnectionState::CONNECTED)
+        return;
+
     // if already scheduled, don't schedule again
     if (send_flush_pending.exchange(true, std::memory_order_acq_rel))
         return;
@@ -442,11 +729,7 @@ inline void WebSocketContext::requestSendFlush()
 
 void WebSocketContext::armCloseTimer() {
     // event-thread only
-    if (!close_timer) {
-        close_timer = evtimer_new(base, &WebSocketContext::closeTimerCb, this);
-    }
-    timeval tv{1, 0}; // 1 second
-    evtimer_add(close_timer, &tv);
+    timers->schedule(close_timer, 1000); // 1 second
 }
 
 void WebSocketContext::handleEvent(bufferevent* bev, short events) {
@@ -471,7 +754,7 @@ void WebSocketContext::handleEvent(bufferevent* bev, short events) {
         if (stopping_now && (events & (BEV_EVENT_ERROR | BEV_EVENT_TIMEOUT))) {
             log_debug("handleEvent: ignoring 0x%hx during shutdown", events);
             
-            requestLoopExit();
+            requestTeardown();
             
             return;
         }
@@ -490,7 +773,7 @@ void WebSocketContext::handleEvent(bufferevent* bev, short events) {
                     // mark transport so stopNow() won't try to send CLOSE
                     connection_state.store(ConnectionState::DISCONNECTING, std::memory_order_release);
 
-                    requestLoopExit();
+                    requestTeardown();
                     return;
                 }
 #endif
@@ -510,8 +793,7 @@ void WebSocketContext::handleEvent(bufferevent* bev, short events) {
             sendError(ws_open ? ErrorCode::IO : ErrorCode::CONNECT_FAILED, msg);
             
             if (!ws_open) {
-                std::lock_guard<std::mutex> lk(send_queue_mutex);
-                send_queue.clear();
+                discardOnFailure();
             }
 
             if (ws_open && st == ConnectionState::DISCONNECTING) {
@@ -521,7 +803,7 @@ void WebSocketContext::handleEvent(bufferevent* bev, short events) {
             // mark transport so stopNow() won't try to send CLOSE
             connection_state.store(ConnectionState::DISCONNECTING, std::memory_order_release);
 
-            requestLoopExit();
+            requestTeardown();
             return;
         }
 
@@ -531,10 +813,7 @@ void WebSocketContext::handleEvent(bufferevent* bev, short events) {
                 log_error("Handshake/connect timeout");
                 sendError(ErrorCode::TIMEOUT, "Connection/handshake timeout");
 
-                {
-                    std::lock_guard<std::mutex> lk(send_queue_mutex);
-                    send_queue.clear();
-                }
+                discardOnFailure();
 
             } else {
                 log_error("Connection timeout");
@@ -543,7 +822,7 @@ void WebSocketContext::handleEvent(bufferevent* bev, short events) {
 
             connection_state.store(ConnectionState::DISCONNECTING, std::memory_order_release);
 
-            requestLoopExit();
+            requestTeardown();
             return;
         }
 
@@ -554,10 +833,7 @@ void WebSocketContext::handleEvent(bufferevent* bev, short events) {
                 log_debug("EOF during handshake");
                 sendError(ErrorCode::CONNECT_FAILED, "Connection closed during handshake (EOF)");
 
-                {
-                    std::lock_guard<std::mutex> lk(send_queue_mutex);
-                    send_queue.clear();
-                }
+                discardOnFailure();
 
             } else if (!graceful) {
                 // WebSocket was open but peer dropped TCP without CLOSE handshake
@@ -571,7 +847,7 @@ void WebSocketContext::handleEvent(bufferevent* bev, short events) {
                 sendCloseCallback(1000, "Normal closure");
             }
 
-            requestLoopExit();
+            requestTeardown();
             return;
         }
     }
@@ -584,7 +860,7 @@ void WebSocketContext::handleEvent(bufferevent* bev, short events) {
             SSL* ssl = bufferevent_openssl_get_ssl(bev);
             if (!ssl) {
                 sendError(ErrorCode::TLS_INIT_FAILED, "SSL object not found");
-                requestLoopExit();
+                requestTeardown();
                 return;
             }
             // Certificate verification
@@ -593,7 +869,7 @@ void WebSocketContext::handleEvent(bufferevent* bev, short events) {
                 if (verifyResult != X509_V_OK) {
                     const char* errStr = X509_verify_cert_error_string(verifyResult);
                     sendError(ErrorCode::SSL_HANDSHAKE_FAILED, std::string("TLS certificate error: ") + errStr);
-                    requestLoopExit();
+                    requestTeardown();
                     return;
                 }
                 
@@ -606,6 +882,14 @@ void WebSocketContext::handleEvent(bufferevent* bev, short events) {
             } else {
                 log_debug("Peer certificate verification disabled by config");
             }
+
+            log_debug("%s handshake done, session %s", SSL_get_version(ssl), SSL_session_reused(ssl) ? "resumed" : "new");
+#ifdef BIO_get_ktls_send
+            if (_cfg.tls.kernelTls) {
+                log_debug("kTLS send %s, receive %s", BIO_get_ktls_send(SSL_get_wbio(ssl)) ? "on" : "off",
+                          BIO_get_ktls_recv(SSL_get_rbio(ssl)) ? "on" : "off");
+            }
+#endif
 #endif            
         }
 
@@ -622,92 +906,88 @@ void WebSocketContext::handleRead(bufferevent* bev) {
         const size_t len = evbuffer_get_length(input);
         if (len < 4) return;
 
-        std::vector<char> snap(len);
-        evbuffer_copyout(input, snap.data(), len);
-        const char* b = snap.data();
-            
-        // Find end of headers: "\r\n\r\n" (length-bounded)
-        size_t headerBytes = 0;
-        for (size_t i = 0; i + 3 < len; ++i) {
-            if (b[i] == '\r' && b[i+1] == '\n' && b[i+2] == '\r' && b[i+3] == '\n') {
-                headerBytes = i + 4;
-                break;
-            }
-        }
-        if (headerBytes == 0) return;
-        std::string resp(b, headerBytes);
-
-        //log_debug("RESP: %s", resp.c_str());
-
-        if (resp.find("HTTP/1.1 101", 0) == std::string::npos ||
-            !containsHeader(resp, "Sec-WebSocket-Accept:"))
-        {
-            log_error("WebSocket upgrade failed");
+        auto fail = [&](const char* why) {
+            log_error("WebSocket upgrade failed: %s", why);
             connection_state.store(ConnectionState::FAILED, std::memory_order_release);
             sendError(ErrorCode::CONNECT_FAILED, "WebSocket upgrade failed");
             evbuffer_drain(input, len);
-            requestLoopExit();
+            requestTeardown();
+        };
+
+        // Find end of headers: "\r\n\r\n"
+        const evbuffer_ptr eoh = evbuffer_search(input, "\r\n\r\n", 4, nullptr);
+        if (eoh.pos < 0) {
+            if (len > WebSocketHandshake::MAX_RESPONSE_SIZE) fail("response headers too large");
+            return;
+        }
+        const size_t headerBytes = static_cast<size_t>(eoh.pos) + 4;
+
+        // Parsed in place; the response is usually in one chain already
+        const char* b = reinterpret_cast<const char*>(evbuffer_pullup(input, static_cast<ev_ssize_t>(headerBytes)));
+
+        WebSocketHandshakeResponse resp;
+        if (!b || !WebSocketHandshake::parseResponse(b, headerBytes, resp)) {
+            fail("malformed response");
+            return;
+        }
+        if (resp.status != 101) {
+            log_error("Server answered the upgrade with status %d", resp.status);
+            fail("unexpected status");
+            return;
+        }
+        if (!resp.upgrade_websocket || !resp.connection_upgrade) {
+            fail("missing Upgrade/Connection headers");
+            return;
+        }
+        if (resp.accept_len != accept.size() || std::memcmp(resp.accept, accept.data(), accept.size()) != 0) {
+            fail("Sec-WebSocket-Accept mismatch");
             return;
         }
 
         bool negotiated = false;
         
-        if (_cfg.compression_requested) {
-            std::string lowerResp = resp;
-            std::transform(lowerResp.begin(), lowerResp.end(), lowerResp.begin(), ::tolower);
-            const std::string key = "sec-websocket-extensions:";
-            size_t extHeaderPos = lowerResp.find(key);
-            if (extHeaderPos != std::string::npos) {
-                size_t lineEnd = resp.find("\r\n", extHeaderPos);
-                if (lineEnd == std::string::npos) lineEnd = resp.size();
-                std::string extLine = resp.substr(extHeaderPos, lineEnd - extHeaderPos);
-
-                if (containsHeader(extLine, "permessage-deflate")) {
-                    negotiated = true;
-                    log_debug("Compression negotiated: %s", extLine.c_str());
-
-                    auto hasToken = [](const std::string& s, const char* tok) {
-                        std::string ls = s;
-                        std::transform(ls.begin(), ls.end(), ls.begin(), ::tolower);
-                        return ls.find(tok) != std::string::npos;
-                    };
-                    auto parseBits = [&](const std::string& keyName) {
-                        std::string ls = extLine;
-                        std::transform(ls.begin(), ls.end(), ls.begin(), ::tolower);
-                        std::string needle = keyName + "=";
-                        size_t p = ls.find(needle);
-                        if (p == std::string::npos) return 15;
-                        size_t vstart = p + needle.size();
-                        size_t vend = ls.find_first_of(" ;\r\n", vstart);
-                        if (vend == std::string::npos) vend = ls.size();
-                        try {
-                            int v = std::stoi(ls.substr(vstart, vend - vstart));
-                            return (v >= 8 && v <= 15) ? v : 15;
-                        } catch (...) { return 15; }
-                    };
-
-                    client_no_context_takeover = hasToken(extLine, "client_no_context_takeover");
-                    server_no_context_takeover = hasToken(extLine, "server_no_context_takeover");
-                    client_max_window_bits = parseBits("client_max_window_bits");
-                    server_max_window_bits = parseBits("server_max_window_bits");
-
-                    PerMessageDeflateConfig cfg;
-                    cfg.enabled = true;
-                    cfg.client_no_context_takeover = client_no_context_takeover;
-                    cfg.server_no_context_takeover = server_no_context_takeover;
-                    cfg.client_max_window_bits = client_max_window_bits;
-                    cfg.server_max_window_bits = server_max_window_bits;
-                    cfg.compression_level = compression_level;
-
-                    if (!receiver.initializeCompression(cfg)) {
-                        log_error("Failed to initialize compression");
-                        use_compression = false;
-                        sendError(ErrorCode::NOT_SUPPORTED, "Compression negotiation failed");
-                    } else {
-                        use_compression = true;
-                    }
-
-                }
+        if (_cfg.compression_requested && resp.deflate.present) {
+            negotiated = true;
+
+            const WebSocketDeflateResponse& pmd = resp.deflate;
+            const WebSocketCompressionOptions& co = _cfg.compression;
+
+            // The server may only tighten what we offered; our own
+            // no_context_takeover request is honored even if not echoed.
+            client_no_context_takeover = co.clientNoContextTakeover || pmd.client_no_context_takeover;
+            server_no_context_takeover = pmd.server_no_context_takeover;
+            client_max_window_bits = std::min(pmd.client_max_window_bits,
+                                              std::max(9, std::min(co.clientMaxWindowBits, 15)));
+            server_max_window_bits = pmd.server_max_window_bits;
+
+            static const int strategies[] = { Z_DEFAULT_STRATEGY, Z_FILTERED, Z_HUFFMAN_ONLY, Z_RLE, Z_FIXED };
+
+            PerMessageDeflateConfig cfg;
+            cfg.enabled = true;
+            cfg.client_no_context_takeover = client_no_context_takeover;
+            cfg.server_no_context_takeover = server_no_context_takeover;
+            cfg.client_max_window_bits = client_max_window_bits;
+            cfg.server_max_window_bits = server_max_window_bits;
+            cfg.compression_level = std::max(-1, std::min(co.level, 9));
+            cfg.mem_level = std::max(1, std::min(co.memLevel, 9));
+            cfg.strategy = strategies[static_cast<int>(co.strategy)];
+            cfg.min_size = co.minSize;
+            cfg.adaptive = co.adaptive;
+            cfg.adaptive_max_ratio = co.adaptiveMaxRatio;
+            cfg.adaptive_probe_interval = co.adaptiveProbeInterval;
+            cfg.shared_streams = co.sharedStreams;
+
+            log_debug("permessage-deflate: tx bits=%d%s, rx bits=%d%s, level=%d",
+                      cfg.client_max_window_bits, cfg.client_no_context_takeover ? " (no takeover)" : "",
+                      cfg.server_max_window_bits, cfg.server_no_context_takeover ? " (no takeover)" : "",
+                      cfg.compression_level);
+
+            if (!receiver.initializeCompression(cfg)) {
+                log_error("Failed to initialize compression");
+                use_compression = false;
+                sendError(ErrorCode::NOT_SUPPORTED, "Compression negotiation failed");
+            } else {
+                use_compression = true;
             }
         }
 
@@ -722,30 +1002,29 @@ void WebSocketContext::handleRead(bufferevent* bev) {
 
         connection_state.store(ConnectionState::CONNECTED, std::memory_order_release);
 
+        WebSocketCounters::add(counters->opens);
+        reconnect_failures = 0;
+        counters->last_handshake_us.store(WebSocketCounters::elapsedNs(connect_started) / 1000, std::memory_order_relaxed);
+
         // Send Pending Queue
-        log_debug("Flushing %zu queued messages…", send_queue.size());
+        log_debug("Flushing %zu queued messages…", send_queue.sizeApprox());
         flushSendQueue();
 
-        OpenCallback cb;
-        {
-            std::lock_guard<std::mutex> lock(cb_mutex);
-            cb = on_open;
-        }
-        if (cb) {
-            cb();
+        const Callbacks& cbs = currentCallbacks();
+        if (cbs.listener.self) {
+            cbs.listener.onOpen(cbs.listener.self);
+        } else if (cbs.on_open) {
+            cbs.on_open();
         }
 
         log_debug("WebSocket connection upgraded successfully");
 
-        if (timeout_event) {
-            event_del(timeout_event);
-            event_free(timeout_event);
-            timeout_event = nullptr;
-        }
+        timers->cancel(timeout_timer);
 
         if (evbuffer_get_length(input) > 0) {
             //log_debug("Processing leftover frame data after upgrade");
             receiver.onData(input);
+            updateReadWatermark(input);
         }
 
         return;
@@ -753,29 +1032,73 @@ void WebSocketContext::handleRead(bufferevent* bev) {
 
     // now the magic
     receiver.onData(input);
+    updateReadWatermark(input);
 }
 
-void WebSocketContext::flushSendQueue() {
-    std::deque<Pending> local;
-    {
-        std::lock_guard<std::mutex> lk(send_queue_mutex);
-        local.swap(send_queue);
+void WebSocketContext::applySocketOptions(evutil_socket_t fd, int family) {
+    const WebSocketSocketOptions& so = _cfg.socket;
+
+    auto set = [fd](int level, int name, int value, const char* what) {
+        if (setsockopt(fd, level, name, &value, sizeof(value)) != 0) {
+            log_error("Failed to set %s=%d: %s", what, value, strerror(errno));
+        }
+    };
+
+    if (so.tcpNoDelay)            set(IPPROTO_TCP, TCP_NODELAY, 1, "TCP_NODELAY");
+    if (so.sendBufferSize > 0)    set(SOL_SOCKET, SO_SNDBUF, so.sendBufferSize, "SO_SNDBUF");
+    if (so.receiveBufferSize > 0) set(SOL_SOCKET, SO_RCVBUF, so.receiveBufferSize, "SO_RCVBUF");
+    if (so.ipTos >= 0) {
+        if (family == AF_INET6)   set(IPPROTO_IPV6, IPV6_TCLASS, so.ipTos, "IPV6_TCLASS");
+        else                      set(IPPROTO_IP, IP_TOS, so.ipTos, "IP_TOS");
+    }
+#ifdef SO_BUSY_POLL
+    if (so.busyPollUs > 0)        set(SOL_SOCKET, SO_BUSY_POLL, so.busyPollUs, "SO_BUSY_POLL");
+#else
+    if (so.busyPollUs > 0)        log_error("SO_BUSY_POLL is not supported on this platform");
+#endif
+}
+
+void WebSocketContext::updateReadWatermark(evbuffer* input) {
+    const size_t step = _cfg.socket.readWatermarkStep;
+    if (!step || !_bev) return;
+
+    // Hold the read callback until the frame is complete or another step arrived
+    const size_t need = receiver.rxIncompleteFrameSize();
+    const size_t low = need ? std::min(need, evbuffer_get_length(input) + step) : 0;
+
+    if (low != read_low_watermark) {
+        bufferevent_setwatermark(_bev, EV_READ, low, 0);
+        read_low_watermark = low;
     }
+}
 
+void WebSocketContext::flushSendQueue() {
     const auto st = connection_state.load(std::memory_order_acquire);
+
+    // Keep everything queued until the handshake completes
+    if (st == ConnectionState::CONNECTING) return;
+
+    // Corked: hold application data until uncorked (close() uncorks)
+    if (st == ConnectionState::CONNECTED && corked.load(std::memory_order_acquire)) return;
+
     const bool can_send_app = (st == ConnectionState::CONNECTED);
 
-    for (auto& p : local) {
+    // Size the first extent for everything queued right now, so a burst of
+    // small messages is framed into one contiguous region
+    const size_t queued = queued_bytes.load(std::memory_order_relaxed) +
+                          send_queue.sizeApprox() * WebSocketFrame::MAX_HEADER;
+    WebSocketFrameWriter writer(_bev ? bufferevent_get_output(_bev) : nullptr,
+                                std::min<size_t>(queued, MAX_FLUSH_EXTENT));
 
-        if (p.type == Pending::Text) {
-            if (!can_send_app) continue;
-            sendNow(p.text.data(), p.text.size(), MessageType::TEXT);
-            continue;
-        }
-        
-        if (p.type == Pending::Binary) {
+    Pending p;
+    while (popPending(p)) {
+
+        if (p.type == Pending::Text || p.type == Pending::Binary) {
             if (!can_send_app) continue;
-            sendNow(p.bin.data(), p.bin.size(), MessageType::BINARY);
+            const MessageType type = p.type == Pending::Text ? MessageType::TEXT : MessageType::BINARY;
+            if (sendNow(p.bytes(), p.len, type, p.compress, &writer) && p.enqueued_ns && send_latency) {
+                send_latency->record((WebSocketCounters::nowNs() - p.enqueued_ns) / 1000);
+            }
             continue;
         }
         
@@ -783,7 +1106,7 @@ void WebSocketContext::flushSendQueue() {
 
             if (close_sent) continue;
 
-            if (sendNow(p.bin.data(), p.bin.size(), MessageType::CLOSE)) {
+            if (sendNow(p.bytes(), p.len, MessageType::CLOSE, true, &writer)) {
 
                 close_sent = true;
                 armCloseTimer();
@@ -793,45 +1116,29 @@ void WebSocketContext::flushSendQueue() {
             continue;
         }
     }
+
+    writer.commit();
+    updateBackpressure();
 }
 
 void WebSocketContext::sendHandshakeRequest() {
     if (!_bev) return;
     log_debug("Sending WebSocket handshake request");
 
-    auto out = bufferevent_get_output(_bev);
-
-    evbuffer_add_printf(out, "GET %s HTTP/1.1\r\n", _cfg.uri.c_str());
-    evbuffer_add_printf(out, "Host:%s:%d\r\n", _cfg.host.c_str(), _cfg.port);
-    evbuffer_add_printf(out, "Upgrade:websocket\r\n");
-    evbuffer_add_printf(out, "Connection:upgrade\r\n");
-    evbuffer_add_printf(out, "Sec-WebSocket-Key:%s\r\n", key.c_str());
-    evbuffer_add_printf(out, "Sec-WebSocket-Version:13\r\n");
-    
-    if (_cfg.compression_requested) {
-        evbuffer_add_printf(out, "Sec-WebSocket-Extensions:permessage-deflate; client_no_context_takeover; server_no_context_takeover; client_max_window_bits=9\r\n");
-    }
-
-    evbuffer_add_printf(out, "Origin:http://%s:%d\r\n", _cfg.host.c_str(), _cfg.port);
-    
-    if (!_cfg.headers.headers.empty()) {
-        for (const auto& header : _cfg.headers.headers) {
-            evbuffer_add_printf(out, "%s:%s\r\n", header.first.c_str(), header.second.c_str());
-        }
+    // Pre-rendered per client configuration; only the key differs per connection
+    if (!_cfg.handshake->write(bufferevent_get_output(_bev), key)) {
+        log_error("Failed to write handshake request");
+        sendError(ErrorCode::IO, "Failed to write handshake request");
+        requestTeardown();
     }
-
-    evbuffer_add_printf(out, "\r\n");
-
 }
 
 void WebSocketContext::sendError(int error_code, const std::string& error_message) {
-    ErrorCallback cb;
-    {
-        std::lock_guard<std::mutex> lock(cb_mutex);
-        cb = on_error;
-    }
-    if (cb) {
-        cb(error_code, error_message);
+    const Callbacks& cbs = currentCallbacks();
+    if (cbs.listener.self) {
+        cbs.listener.onError(cbs.listener.self, error_code, error_message);
+    } else if (cbs.on_error) {
+        cbs.on_error(error_code, error_message);
     } else {
         log_error("Unhandled error: %s", error_message.c_str());
     }
@@ -853,11 +1160,12 @@ bool WebSocketContext::close(int code, const std::string& reason) {
     if (!upgraded.load(std::memory_order_acquire) || !_bev) {
         log_debug("close(): abort (not upgraded or no bev)");
         connection_state.store(ConnectionState::DISCONNECTED, std::memory_order_release);
-        requestLoopExit();
+        requestTeardown();
         return true;
     }
 
     connection_state.store(ConnectionState::DISCONNECTING, std::memory_order_release);
+    corked.store(false, std::memory_order_release);
 
     // If we already sent CLOSE, nothing else to do.
     if (close_sent) {
@@ -874,14 +1182,11 @@ bool WebSocketContext::close(int code, const std::string& reason) {
         memcpy(payload.data() + sizeof(code_be), r.data(), r.size());
     }
 
-    {
-        std::lock_guard<std::mutex> lk(send_queue_mutex);
-        if (send_queue.size() >= MAX_QUEUE_SIZE) {
-            log_error("Send queue full—dropping CLOSE");
-            requestLoopExit();
-            return false;
-        }
-        send_queue.emplace_back(std::move(payload), Pending::Close);
+    if (!pushPending(Pending(Pending::Close, payload.data(), payload.size()))) {
+        WebSocketCounters::add(counters->sends_rejected);
+        log_error("Send queue full—dropping CLOSE");
+        requestTeardown();
+        return false;
     }
     
     requestSendFlush();
@@ -892,70 +1197,293 @@ bool WebSocketContext::close(CloseCode code, const std::string& reason) {
     return close(static_cast<int>(code), reason);
 }
 
-bool WebSocketContext::sendData(const void* data, size_t length, MessageType type) {
-    ConnectionState state = connection_state.load(std::memory_order_acquire);
+bool WebSocketContext::pushPending(Pending&& p) {
+    const size_t len = p.len;
+    queued_bytes.fetch_add(len, std::memory_order_relaxed);
+    if (!send_queue.push(std::move(p))) {
+        queued_bytes.fetch_sub(len, std::memory_order_relaxed);
+        return false;
+    }
+    WebSocketCounters::raise(counters->queue_high_water, send_queue.sizeApprox());
+    return true;
+}
 
-    if (type == MessageType::CLOSE) return false;
-    
-    // While CONNECTING: queue only
-    if (state == ConnectionState::CONNECTING) {
-        std::lock_guard<std::mutex> lk(send_queue_mutex);
-        if (send_queue.size() >= MAX_QUEUE_SIZE) {
-            log_error("Send queue full—dropping packet");
-            return false;
-        }
-        if (type == MessageType::TEXT) {
-            send_queue.emplace_back(
-                std::string(reinterpret_cast<const char*>(data), length)
-            );
-        } else {
-            send_queue.emplace_back(
-                std::vector<uint8_t>(
-                    reinterpret_cast<const uint8_t*>(data),
-                    reinterpret_cast<const uint8_t*>(data) + length
-                )
-            );
-        }
+bool WebSocketContext::pushPendingBatch(Pending* items, size_t count, size_t bytes) {
+    queued_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    if (!send_queue.pushBatch(items, count)) {
+        queued_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+        return false;
+    }
+    WebSocketCounters::raise(counters->queue_high_water, send_queue.sizeApprox());
+    return true;
+}
+
+bool WebSocketContext::popPending(Pending& p) {
+    if (!send_queue.pop(p)) return false;
+    queued_bytes.fetch_sub(p.len, std::memory_order_relaxed);
+    return true;
+}
 
-        log_debug("Queued %zu bytes during CONNECTING", length);
+void WebSocketContext::discardSendQueue() {
+    Pending p;
+    while (popPending(p)) {}
+    updateBackpressure();
+}
 
-        return true;
-    }
+size_t WebSocketContext::bufferedAmount() const {
+    return queued_bytes.load(std::memory_order_relaxed) +
+           output_bytes.load(std::memory_order_relaxed);
+}
+
+WebSocketStats WebSocketContext::stats() const {
+    WebSocketStats s;
+    counters->snapshot(s);
+    s.sendQueueDepth = send_queue.sizeApprox();
+    s.bufferedAmount = bufferedAmount();
+    s.outputBufferLength = output_bytes.load(std::memory_order_relaxed);
+    return s;
+}
+
+bool WebSocketContext::admit(size_t length) {
+    const size_t high = _cfg.backpressure.highWatermark;
+    if (high == 0) return true;
 
-    // After CONNECTING:
-    // Only event thread sends.
-    if (std::this_thread::get_id() == event_tid) {
-        return sendNow(data, length, type);
+    // An idle connection always takes one message, however large
+    const size_t buffered = bufferedAmount();
+    if (buffered == 0 || buffered + length <= high) return true;
+
+    congested.store(true, std::memory_order_release);
+    return false;
+}
+
+bool WebSocketContext::overflow(size_t length) {
+    congested.store(true, std::memory_order_release);
+    WebSocketCounters::add(counters->sends_rejected);
+
+    if (_cfg.backpressure.policy == WebSocketBackpressureOptions::Policy::DROP) {
+        log_error("Send buffer full—dropping %zu bytes (%zu buffered)", length, bufferedAmount());
     }
+    return false;
+}
 
-    // Not event thread: queue and poke event loop (send_event)
+bool WebSocketContext::waitForRoom(uint64_t seen, std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lk(bp_mutex);
+    bp_waiters.fetch_add(1, std::memory_order_acq_rel);
+
+    const bool woken = bp_cv.wait_until(lk, deadline, [&]{ return bp_generation != seen; });
+
+    bp_waiters.fetch_sub(1, std::memory_order_acq_rel);
+
+    const auto st = connection_state.load(std::memory_order_acquire);
+    return woken && (st == ConnectionState::CONNECTING || st == ConnectionState::CONNECTED);
+}
+
+void WebSocketContext::wakeBlockedSenders() {
+    if (bp_waiters.load(std::memory_order_acquire) == 0) return;
     {
-        std::lock_guard<std::mutex> lk(send_queue_mutex);
-        if (send_queue.size() >= MAX_QUEUE_SIZE) {
-            log_error("Send queue full—dropping packet");
-            return false;
+        std::lock_guard<std::mutex> lk(bp_mutex);
+        ++bp_generation;
+    }
+    bp_cv.notify_all();
+}
+
+void WebSocketContext::updateBackpressure() {
+    // event-thread only
+    output_bytes.store(_bev ? evbuffer_get_length(bufferevent_get_output(_bev)) : 0,
+                       std::memory_order_relaxed);
+    counters->output_bytes.store(output_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    wakeBlockedSenders();
+
+    if (!congested.load(std::memory_order_acquire)) return;
+    if (bufferedAmount() > _cfg.backpressure.effectiveLowWatermark()) return;
+    if (connection_state.load(std::memory_order_acquire) != ConnectionState::CONNECTED) return;
+
+    congested.store(false, std::memory_order_release);
+
+    const Callbacks& cbs = currentCallbacks();
+    if (cbs.listener.self) {
+        cbs.listener.onWritable(cbs.listener.self);
+    } else if (cbs.on_writable) {
+        cbs.on_writable();
+    }
+}
+
+bool WebSocketContext::sendsInline() const {
+    // Only the event thread sends, and never before the handshake completes.
+    // While corked, or with queued messages still waiting, it queues too so
+    // messages stay in order.
+    return connection_state.load(std::memory_order_acquire) != ConnectionState::CONNECTING &&
+           std::this_thread::get_id() == event_tid &&
+           !corked.load(std::memory_order_acquire) &&
+           send_queue.sizeApprox() == 0;
+}
+
+bool WebSocketContext::sendInline(const void* data, size_t length, MessageType type, bool compress) {
+    // BLOCK cannot wait on the thread that drains, so it rejects here
+    if (!admit(length)) return overflow(length);
+
+    const bool ok = sendNow(data, length, type, compress);
+    output_bytes.store(_bev ? evbuffer_get_length(bufferevent_get_output(_bev)) : 0,
+                       std::memory_order_relaxed);
+    if (ok && send_latency) send_latency->record(0);   // never queued
+    return ok;
+}
+
+bool WebSocketContext::queueSend(Pending&& p) {
+    const WebSocketBackpressureOptions& bp = _cfg.backpressure;
+    const bool may_block = bp.policy == WebSocketBackpressureOptions::Policy::BLOCK &&
+                           !_loop->isLoopThread();
+    const auto deadline = std::chrono::steady_clock::now() +
+                          std::chrono::milliseconds(bp.blockTimeoutMs);
+
+    // Time spent blocked on backpressure counts as queueing delay
+    if (send_latency) p.enqueued_ns = WebSocketCounters::nowNs();
+
+    for (;;) {
+        uint64_t seen = 0;
+        if (may_block) {
+            std::lock_guard<std::mutex> lk(bp_mutex);
+            seen = bp_generation;
         }
 
-        if (type == MessageType::TEXT) {
-            send_queue.emplace_back(
-                std::string(reinterpret_cast<const char*>(data), length)
-            );
-        } else {
-            send_queue.emplace_back(
-                std::vector<uint8_t>(
-                    reinterpret_cast<const uint8_t*>(data),
-                    reinterpret_cast<const uint8_t*>(data) + length
-                )
-            );
+        // push() leaves p untouched when the ring is full
+        if (admit(p.len) && pushPending(std::move(p))) break;
+
+        if (!may_block || !waitForRoom(seen, deadline)) return overflow(p.len);
+    }
+
+    if (connection_state.load(std::memory_order_acquire) == ConnectionState::CONNECTING) {
+        log_debug("Queued message during CONNECTING (%zu bytes buffered)", bufferedAmount());
+    }
+
+    // Poke the event loop (send_event); the flush is a no-op while CONNECTING
+    // and the handshake path flushes on its own once upgraded
+    requestSendFlush();
+
+    return true;
+}
+
+bool WebSocketContext::queueBatch(Pending* items, size_t count, size_t bytes) {
+    const WebSocketBackpressureOptions& bp = _cfg.backpressure;
+    const bool may_block = bp.policy == WebSocketBackpressureOptions::Policy::BLOCK &&
+                           !_loop->isLoopThread();
+    const auto deadline = std::chrono::steady_clock::now() +
+                          std::chrono::milliseconds(bp.blockTimeoutMs);
+
+    if (send_latency) {
+        const uint64_t now = WebSocketCounters::nowNs();
+        for (size_t i = 0; i < count; ++i) items[i].enqueued_ns = now;
+    }
+
+    for (;;) {
+        uint64_t seen = 0;
+        if (may_block) {
+            std::lock_guard<std::mutex> lk(bp_mutex);
+            seen = bp_generation;
         }
+
+        // The whole batch is admitted, or none of it
+        if (admit(bytes) && pushPendingBatch(items, count, bytes)) break;
+
+        if (!may_block || !waitForRoom(seen, deadline)) return overflow(bytes);
     }
 
+    // One wakeup for the whole batch
     requestSendFlush();
 
     return true;
 }
 
-bool WebSocketContext::sendNow(const void* data, size_t length, MessageType type) {
+bool WebSocketContext::sendBatch(const WebSocketClient::BatchItem* items, size_t count, bool compress) {
+    if (!items || count == 0) return count == 0;
+
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (items[i].type != MessageType::TEXT && items[i].type != MessageType::BINARY) return false;
+        total += items[i].length;
+    }
+
+    if (sendsInline()) {
+        if (!admit(total)) return overflow(total);
+
+        // Frame everything into one reserved region
+        bool ok = true;
+        {
+            WebSocketFrameWriter writer(_bev ? bufferevent_get_output(_bev) : nullptr,
+                                        std::min<size_t>(total + count * WebSocketFrame::MAX_HEADER, MAX_FLUSH_EXTENT));
+            for (size_t i = 0; i < count && ok; ++i) {
+                ok = sendNow(items[i].data, items[i].length, items[i].type, compress, &writer);
+                if (ok && send_latency) send_latency->record(0);
+            }
+        }
+        output_bytes.store(_bev ? evbuffer_get_length(bufferevent_get_output(_bev)) : 0,
+                           std::memory_order_relaxed);
+        return ok;
+    }
+
+    if (count > send_queue.capacity()) {
+        log_error("sendBatch: %zu messages exceed the send queue capacity (%zu)", count, send_queue.capacity());
+        return false;
+    }
+
+    std::vector<Pending> batch;
+    batch.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const Pending::Type ptype = (items[i].type == MessageType::TEXT) ? Pending::Text : Pending::Binary;
+        batch.emplace_back(ptype, items[i].data, items[i].length, compress);
+    }
+    return queueBatch(batch.data(), count, total);
+}
+
+void WebSocketContext::setCorked(bool cork) {
+    corked.store(cork, std::memory_order_release);
+    if (!cork) requestSendFlush();
+}
+
+bool WebSocketContext::sendData(const void* data, size_t length, MessageType type, bool compress) {
+    if (type == MessageType::CLOSE) return false;
+
+    if (sendsInline()) {
+        return sendInline(data, length, type, compress);
+    }
+
+    const Pending::Type ptype = (type == MessageType::TEXT) ? Pending::Text : Pending::Binary;
+    return queueSend(Pending(ptype, data, length, compress));
+}
+
+bool WebSocketContext::sendData(std::string&& text, bool compress) {
+    if (sendsInline()) {
+        return sendInline(text.data(), text.size(), MessageType::TEXT, compress);
+    }
+
+    // Steal the caller's buffer instead of copying it into the queue
+    auto owner = std::make_shared<std::string>(std::move(text));
+    return queueSend(Pending(Pending::Text, owner, owner->data(), owner->size(), compress));
+}
+
+bool WebSocketContext::sendData(std::vector<uint8_t>&& bin, bool compress) {
+    if (sendsInline()) {
+        return sendInline(bin.data(), bin.size(), MessageType::BINARY, compress);
+    }
+
+    auto owner = std::make_shared<std::vector<uint8_t>>(std::move(bin));
+    return queueSend(Pending(Pending::Binary, owner, owner->data(), owner->size(), compress));
+}
+
+bool WebSocketContext::sendShared(std::shared_ptr<const void> owner, const void* data, size_t length, MessageType type, bool compress) {
+    if (type == MessageType::CLOSE) return false;
+
+    if (sendsInline()) {
+        return sendInline(data, length, type, compress);
+    }
+
+    const Pending::Type ptype = (type == MessageType::TEXT) ? Pending::Text : Pending::Binary;
+    return queueSend(Pending(ptype, std::move(owner), data, length, compress));
+}
+
+bool WebSocketContext::sendNow(const void* data, size_t length, MessageType type, bool compress,
+                               WebSocketFrameWriter* writer) {
     if (!_bev) {
         log_error("sendNow: No bufferevent—cannot send");
         return false;
@@ -985,12 +1513,21 @@ bool WebSocketContext::sendNow(const void* data, size_t length, MessageType type
         return false;
     }
 
-    send(output, data, length, type);
+    if (writer) {
+        send(*writer, data, length, type, compress);
+    } else {
+        send(output, data, length, type, compress);
+    }
 
     return true;
 }
 
-void WebSocketContext::send(evbuffer* buf, const void* raw_data, size_t raw_len, MessageType type) {
+void WebSocketContext::send(evbuffer* buf, const void* raw_data, size_t raw_len, MessageType type, bool compress) {
+    WebSocketFrameWriter writer(buf, 0);
+    send(writer, raw_data, raw_len, type, compress);
+}
+
+void WebSocketContext::send(WebSocketFrameWriter& writer, const void* raw_data, size_t raw_len, MessageType type, bool compress) {
     const bool is_control_frame = (type == MessageType::CLOSE || type == MessageType::PING  || type == MessageType::PONG);
 
     if (is_control_frame && raw_len > 125) {
@@ -1001,7 +1538,7 @@ void WebSocketContext::send(evbuffer* buf, const void* raw_data, size_t raw_len,
     const uint8_t* original_ptr = static_cast<const uint8_t*>(raw_data);
     const size_t   original_len = raw_len;
 
-    const bool request_compress = !is_control_frame && use_compression && (type == MessageType::TEXT || type == MessageType::BINARY);
+    const bool request_compress = compress && !is_control_frame && use_compression && (type == MessageType::TEXT || type == MessageType::BINARY);
 
     const uint8_t* payload_ptr = original_ptr;
     size_t payload_len = original_len;
@@ -1020,75 +1557,43 @@ void WebSocketContext::send(evbuffer* buf, const void* raw_data, size_t raw_len,
         case MessageType::PONG:   b1 |= 0x0A; break;
     }
 
-    uint8_t b2 = 0x80; // Mask bit
-    if (payload_len <= 125) {
-        b2 |= static_cast<uint8_t>(payload_len);
-    } else if (payload_len <= 65535) {
-        b2 |= 126;
-    } else {
-        b2 |= 127;
-    }
-
-    log_debug("send frame: b1=0x%02X b2=0x%02X len=%zu compress=%d\n",
-              b1, b2, payload_len, do_compress);
-
-    auto out = buf;
-
-    evbuffer_add(out, &b1, 1);
-    evbuffer_add(out, &b2, 1);
-
-    if ((b2 & 0x7F) == 126) {
-        uint16_t len = htons(static_cast<uint16_t>(payload_len));
-        evbuffer_add(out, &len, 2);
-    } else if ((b2 & 0x7F) == 127) {
-        uint64_t len = htonll(static_cast<uint64_t>(payload_len));
-        evbuffer_add(out, &len, 8);
-    }
-
-    // ---- Fast masking (single evbuffer_add) ----
     uint8_t mask_key[4];
+    WebSocketFrame::nextMaskKey(mask_key);
 
-    thread_local uint32_t s = 0;
-    if (s == 0) {
-        uint64_t t = static_cast<uint64_t>(time(nullptr));
-        uintptr_t a = reinterpret_cast<uintptr_t>(&s);
-        s = static_cast<uint32_t>((t ^ (t >> 32) ^ a) | 1u);
-    }
-
-    auto next_u32 = [&]() -> uint32_t {
-        s += 0x9E3779B9u;
-        uint32_t z = s;
-        z ^= z >> 16;
-        z *= 0x85EBCA6Bu;
-        z ^= z >> 13;
-        z *= 0xC2B2AE35u;
-        z ^= z >> 16;
-        return z;
-    };
-
-    uint32_t mask32 = next_u32();
-    std::memcpy(mask_key, &mask32, 4);
-
-    // Write mask key
-    evbuffer_add(out, mask_key, 4);
+    log_debug("send frame: b1=0x%02X len=%zu compress=%d\n",
+              b1, payload_len, do_compress);
 
-    // Mask payload into one contiguous buffer, then add once
-    static thread_local std::vector<uint8_t> masked;
-    masked.resize(payload_len);
-
-    const uint8_t* src = payload_ptr;
-    for (size_t i = 0; i < payload_len; ++i) {
-        masked[i] = src[i] ^ mask_key[i & 3];
+    // Header and masked payload go straight into the output buffer
+    if (!writer.add(b1, payload_ptr, payload_len, mask_key)) {
+        log_error("Failed to reserve %zu bytes in output buffer", payload_len);
+        return;
     }
 
-    // Add
-    evbuffer_add(out, masked.data(), masked.size());
+    WebSocketCounters::bump(counters->frames_out);
+    WebSocketCounters::bump(counters->bytes_out, WebSocketFrame::headerSize(payload_len) + payload_len);
+    if (!is_control_frame) WebSocketCounters::bump(counters->messages_out);
 }
 
 void WebSocketContext::sendPing() {
     if (!upgraded.load() || !_bev) return;
-    const char ping_payload[] = "ping";
-    sendNow(ping_payload, sizeof(ping_payload) - 1, MessageType::PING);
+
+    // The peer echoes the payload, so the pong carries its own send time
+    uint8_t payload[PING_PAYLOAD_SIZE];
+    const uint32_t seq = ++ping_seq;
+    const uint64_t sent_ns = WebSocketCounters::nowNs();
+    std::memcpy(payload, PING_MAGIC, sizeof(PING_MAGIC));
+    std::memcpy(payload + 4, &seq, sizeof(seq));
+    std::memcpy(payload + 8, &sent_ns, sizeof(sent_ns));
+
+    if (sendNow(payload, sizeof(payload), MessageType::PING)) {
+        WebSocketCounters::bump(counters->pings_sent);
+
+        // One deadline at a time: a later pong also answers earlier pings
+        if (_cfg.pong_timeout > 0 && !pong_timer.armed()) {
+            pong_awaited = seq;
+            timers->schedule(pong_timer, uint64_t(_cfg.pong_timeout) * 1000);
+        }
+    }
 }
 
 void WebSocketContext::sendCloseCallback(int code, const std::string& reason) {
@@ -1096,23 +1601,12 @@ void WebSocketContext::sendCloseCallback(int code, const std::string& reason) {
         return;
     }
 
-    CloseCallback cb;
-    {
-        std::lock_guard<std::mutex> lock(cb_mutex);
-        cb = on_close;
+    const Callbacks& cbs = currentCallbacks();
+    if (cbs.listener.self) {
+        cbs.listener.onClose(cbs.listener.self, code, reason);
+    } else if (cbs.on_close) {
+        cbs.on_close(code, reason);
     }
-    if (cb) cb(code, reason);
-}
-
-bool WebSocketContext::containsHeader(const std::string& response, const std::string& header) const {
-    std::string lowerResponse = response;
-    std::string lowerHeader = header;
-    
-    // Convert both to lowercase for case insensitive search
-    std::transform(lowerResponse.begin(), lowerResponse.end(), lowerResponse.begin(), ::tolower);
-    std::transform(lowerHeader.begin(), lowerHeader.end(), lowerHeader.begin(), ::tolower);
-    
-    return lowerResponse.find(lowerHeader) != std::string::npos;
 }
 
 static inline uint8_t hexNibble(char c) {
@@ -1133,8 +1627,7 @@ std::array<uint8_t,20> WebSocketContext::hexToBytes(const std::string& hex) {
 
 std::string WebSocketContext::getWebSocketKey() {
     std::array<uint8_t,16> nonce;
-    std::random_device rd;
-    for (auto &b : nonce) b = rd();
+    for (auto &b : nonce) b = static_cast<uint8_t>(key_rng());
     return base64_encode(nonce.data(), nonce.size());
 }
 
@@ -1169,8 +1662,28 @@ bool WebSocketContext::rxCompressionEnabled() const {
 }
 
 void WebSocketContext::onRxPong(std::vector<uint8_t>&& payload) {
-    log_debug("Received pong frame (%zu bytes)", payload.size());
-    (void)payload;
+    // Unsolicited pongs (RFC 6455 5.5.3) and other payloads carry no timing
+    if (payload.size() != PING_PAYLOAD_SIZE || std::memcmp(payload.data(), PING_MAGIC, sizeof(PING_MAGIC)) != 0) {
+        log_debug("Received pong frame (%zu bytes)", payload.size());
+        return;
+    }
+
+    uint32_t seq;
+    uint64_t sent_ns;
+    std::memcpy(&seq, payload.data() + 4, sizeof(seq));
+    std::memcpy(&sent_ns, payload.data() + 8, sizeof(sent_ns));
+
+    // Only pings of this connection, each answered once
+    if (seq == 0 || seq > ping_seq || seq <= pong_seq) return;
+    pong_seq = seq;
+    if (seq >= pong_awaited) timers->cancel(pong_timer);
+
+    const uint64_t rtt_us = (WebSocketCounters::nowNs() - sent_ns) / 1000;
+    log_debug("Pong %u: rtt %llu us", seq, static_cast<unsigned long long>(rtt_us));
+
+    WebSocketCounters::bump(counters->pongs_received);
+    counters->last_rtt_us.store(rtt_us, std::memory_order_relaxed);
+    if (rtt_histogram) rtt_histogram->record(rtt_us);
 }
 
 void WebSocketContext::onRxPing(std::vector<uint8_t>&& payload) {
@@ -1222,26 +1735,56 @@ void WebSocketContext::onRxProtocolError(uint16_t closeCode, std::string&& why)
         requestSendFlush();
         // loop exit happens on rx close / close timer / transport error
     } else {
-        requestLoopExit();
+        requestTeardown();
     }
 }
 
-void WebSocketContext::onRxText(std::string&& msg) {
-    MessageCallback cb;
-    {
-        std::lock_guard<std::mutex> lock(cb_mutex);
-        cb = on_message;
+void WebSocketContext::onRxText(const uint8_t* data, size_t len) {
+    WebSocketCounters::bump(counters->messages_in);
+
+    const Callbacks& cbs = currentCallbacks();
+
+    // Zero-copy: the view points into the receive buffer
+    if (cbs.listener.self) {
+        cbs.listener.onMessage(cbs.listener.self, reinterpret_cast<const char*>(data), len);
+    } else if (cbs.on_message_view) {
+        cbs.on_message_view(reinterpret_cast<const char*>(data), len);
+    } else if (cbs.on_message) {
+        cbs.on_message(std::string(reinterpret_cast<const char*>(data), len));
     }
-    if (cb) cb(msg);
 }
 
-void WebSocketContext::onRxBinary(std::vector<uint8_t>&& msg) {
-    BinaryCallback cb;
-    {
-        std::lock_guard<std::mutex> lock(cb_mutex);
-        cb = on_binary;
+void WebSocketContext::onRxBinary(const uint8_t* data, size_t len) {
+    WebSocketCounters::bump(counters->messages_in);
+
+    const Callbacks& cbs = currentCallbacks();
+    if (cbs.listener.self) {
+        cbs.listener.onBinary(cbs.listener.self, data, len);
+    } else if (cbs.on_binary) {
+        cbs.on_binary(data, len);
     }
-    if (cb) cb(msg.data(), msg.size());
+}
+
+bool WebSocketContext::rxStreamChunks() const {
+    return static_cast<bool>(currentCallbacks().on_chunk);
+}
+
+void WebSocketContext::onRxChunk(const uint8_t* data, size_t len, bool binary, bool final) {
+    if (final) WebSocketCounters::bump(counters->messages_in);
+
+    const Callbacks& cbs = currentCallbacks();
+    if (cbs.on_chunk) cbs.on_chunk(data, len, binary ? MessageType::BINARY : MessageType::TEXT, final);
+}
+
+bool WebSocketContext::rxTakesBuffers() const {
+    return static_cast<bool>(currentCallbacks().on_buffer);
+}
+
+void WebSocketContext::onRxBuffer(WebSocketBuffer&& buffer, bool binary) {
+    WebSocketCounters::bump(counters->messages_in);
+
+    const Callbacks& cbs = currentCallbacks();
+    if (cbs.on_buffer) cbs.on_buffer(std::move(buffer), binary ? MessageType::BINARY : MessageType::TEXT);
 }
 
 bool WebSocketContext::rxIsTerminating() const {
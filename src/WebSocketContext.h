@@ -17,29 +17,41 @@
 #endif
 
 #include <event2/dns.h>
-#include <event2/thread.h>
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
-#include <deque>
 #include <random>
 #include <zlib.h>
 
 #include <vector>
 #include <array>
 #include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
 #include "base64.h"
 #include "WebSocketClient.h"
 #include "WebSocketHeaders.h"
 #include "WebSocketTLSOptions.h"
+#include "WebSocketBackpressureOptions.h"
+#include "WebSocketCompressionOptions.h"
+#include "WebSocketSocketOptions.h"
+#include "WebSocketConnectOptions.h"
+#include "WebSocketReconnectOptions.h"
 
 #include "WebSocketReceiver.h"
+#include "WebSocketEventLoop.h"
+#include "WebSocketFrame.h"
+#include "WebSocketHandshake.h"
+#include "WebSocketConnector.h"
+#include "WebSocketCounters.h"
+#include "MpscQueue.h"
 #include "IWebSocketSinks.h"
 
 #define htonll(x) ((1==htonl(1)) ? (x) : ((uint64_t)htonl((x) & 0xFFFFFFFF) << 32) | htonl((x) >> 32))
@@ -57,7 +69,12 @@ public:
     using ErrorCallback = std::function<void(int error_code, const std::string& error_message)>;
     using CloseCallback = std::function<void(int code, const std::string& reason)>;
     using MessageCallback = std::function<void(const std::string&)>;
+    using MessageViewCallback = WebSocketClient::MessageViewCallback;
     using BinaryCallback = std::function<void(const void*, size_t)>;
+    using WritableCallback = WebSocketClient::WritableCallback;
+    using MessageChunkCallback = WebSocketClient::MessageChunkCallback;
+    using MessageBufferCallback = WebSocketClient::MessageBufferCallback;
+    using StatsCallback = WebSocketClient::StatsCallback;
 
     struct Config {
         std::string host;
@@ -66,20 +83,55 @@ public:
         bool secure;
         bool is_ip_address;
         unsigned int ping_interval;
+        unsigned int pong_timeout = 0;     // seconds; 0: pongs are not awaited
         unsigned int connection_timeout;
         WebSocketHeaders headers;
         WebSocketTLSOptions tls;
         bool compression_requested;
+        bool single_threaded_io = false;   // bufferevent without locks or deferred callbacks
+        WebSocketCompressionOptions compression;
+        WebSocketBackpressureOptions backpressure;
+        WebSocketSocketOptions socket;
+        WebSocketConnectOptions connect;
+        WebSocketReconnectOptions reconnect;
+        std::shared_ptr<WebSocketEventLoop> loop;   // null: private loop and thread
+        std::shared_ptr<const WebSocketHandshake> handshake;   // null: rendered per connection
+        std::shared_ptr<WebSocketCounters> counters;           // null: private to this connection
+        unsigned int stats_interval_ms = 0;                    // periodic on_stats export (0 = off)
+        bool send_latency_tracking = false;                    // timestamp queued messages
+    };
+
+    // A published set is never modified: setters copy the current one, change
+    // it and swap the pointer, so dispatch is one acquire load without a lock
+    struct Callbacks {
+        OpenCallback on_open;
+        ErrorCallback on_error;
+        CloseCallback on_close;
+        MessageCallback on_message;
+        MessageViewCallback on_message_view;
+        BinaryCallback on_binary;
+        WritableCallback on_writable;
+        MessageChunkCallback on_chunk;
+        MessageBufferCallback on_buffer;
+        StatsCallback on_stats;
+        WebSocketListenerTable listener;   // when set, replaces open..writable
     };
 
     explicit WebSocketContext(const Config& cfg);
     ~WebSocketContext();
     
+    void setCallbacks(const Callbacks& cbs);
+    void setListener(const WebSocketListenerTable& listener);
     void setOpenCallback(OpenCallback cb);
     void setErrorCallback(ErrorCallback cb);
     void setCloseCallback(CloseCallback cb);
     void setMessageCallback(MessageCallback cb);
+    void setMessageViewCallback(MessageViewCallback cb);
     void setBinaryCallback(BinaryCallback cb);
+    void setWritableCallback(WritableCallback cb);
+    void setMessageChunkCallback(MessageChunkCallback cb);
+    void setMessageBufferCallback(MessageBufferCallback cb);
+    void setStatsCallback(StatsCallback cb);
 
     void start();
     void stop();
@@ -87,47 +139,70 @@ public:
     // IWebSocketSinks overrides
     bool rxCompressionEnabled() const override;
     bool isConnected() const;
-    bool sendData(const void* data, size_t length, MessageType type);   //public wrapper
+    bool sendData(const void* data, size_t length, MessageType type, bool compress = true);   //public wrapper
+    bool sendData(std::string&& text, bool compress = true);
+    bool sendData(std::vector<uint8_t>&& bin, bool compress = true);
+    bool sendShared(std::shared_ptr<const void> owner, const void* data, size_t length, MessageType type, bool compress = true);
+    bool sendBatch(const WebSocketClient::BatchItem* items, size_t count, bool compress = true);
+    void setCorked(bool cork);
+    size_t bufferedAmount() const;
+    WebSocketStats stats() const;
 
     void onRxPong(std::vector<uint8_t>&& payload) override;
     void onRxPing(std::vector<uint8_t>&& payload) override;
     void onRxClose(uint16_t code, std::string&& reason) override;
     void onRxProtocolError(uint16_t closeCode, std::string&& why) override;
-    void onRxText(std::string&& msg) override;
-    void onRxBinary(std::vector<uint8_t>&& msg) override;
+    void onRxText(const uint8_t* data, size_t len) override;
+    void onRxBinary(const uint8_t* data, size_t len) override;
+    bool rxStreamChunks() const override;
+    void onRxChunk(const uint8_t* data, size_t len, bool binary, bool final) override;
+    bool rxTakesBuffers() const override;
+    void onRxBuffer(WebSocketBuffer&& buffer, bool binary) override;
     bool rxIsTerminating() const override;
 
 private:
-    static void libeventThreads();
-    bool containsHeader(const std::string& response, const std::string& header) const;
-
     // Static callbacks - these will be called by libevent
     static void readCallback(bufferevent* bev, void* ctx);
     static void eventCallback(bufferevent* bev, short events, void *ctx);
-    static void timeoutCallback(evutil_socket_t fd, short event, void *arg);
-    static void pingCallback(evutil_socket_t fd, short event, void *arg);
+    static void timeoutCallback(void *arg);
+    static void pingCallback(void *arg);
+    static void pongTimeoutCallback(void *arg);
     static void wakeupCallback(evutil_socket_t fd, short event, void *arg);
     static void sendCallback(evutil_socket_t fd, short events, void *arg);
-    static void closeTimerCb(evutil_socket_t fd, short events, void *arg);
+    static void writeCallback(bufferevent* bev, void* ctx);
+    static void closeTimerCb(void *arg);
 
     void run();
+    void connectAttempt();
     void cleanup();
+    void closeTransport();
+    void finish();
+
+    // Reconnect: retry on the same context, keeping loop, TLS, zlib and queue
+    bool shouldReconnect() const;
+    void scheduleReconnect();
+    void resetSession();
+    uint64_t reconnectDelayMs();
+    void discardOnFailure();
+    static void reconnectCallback(void *arg);
 
     // Member callback implementations
     void handleRead(bufferevent* bev);
     // void handleWrite(bufferevent* bev);
     void handleEvent(bufferevent* bev, short events);
 
-    inline void requestLoopExit();
+    inline void requestTeardown();
     inline void requestSendFlush();
     inline void requestWakeup();
     inline void armCloseTimer();
 
     bool close(int code = 1000, const std::string& reason = "Normal closure");
     bool close(CloseCode code, const std::string& reason);
-    void send(evbuffer* buf, const void* data, size_t len, MessageType type = MessageType::TEXT);
+    void send(evbuffer* buf, const void* data, size_t len, MessageType type = MessageType::TEXT, bool compress = true);
+    void send(WebSocketFrameWriter& writer, const void* data, size_t len, MessageType type, bool compress);
 
-    bool sendNow(const void* data, size_t length, MessageType type);    //event thread only
+    bool sendNow(const void* data, size_t length, MessageType type, bool compress = true,
+                 WebSocketFrameWriter* writer = nullptr);    //event thread only
     void stopNow();
 
     void sendError(int error_code, const std::string& error_message);
@@ -146,41 +221,107 @@ private:
     std::string key;
     std::string accept;
 
-    std::mutex cb_mutex;
+    std::mutex cb_mutex;     // serializes callback updates; dispatch never takes it
     std::mutex base_mutex;
 
-    OpenCallback on_open;
-    ErrorCallback on_error;
-    CloseCallback on_close;
-    MessageCallback on_message;
-    BinaryCallback on_binary;
+    // Every set ever published stays alive until the context goes away, as
+    // a callback may still be running from the one it replaced. Callbacks
+    // are normally installed once, before start().
+    std::atomic<const Callbacks*> callbacks{nullptr};
+    std::vector<std::unique_ptr<const Callbacks>> callback_sets;
 
-    static const size_t MAX_QUEUE_SIZE = 1024;
+    template <typename Edit>
+    void updateCallbacks(Edit&& edit);
+    const Callbacks& currentCallbacks() const { return *callbacks.load(std::memory_order_acquire); }
 
-    // Pending queue
+    // Pending queue: either a private copy (one allocation) or a view
+    // into caller-owned storage kept alive by 'owner' (no copy)
     struct Pending {
-        enum Type { Text, Binary, Close } type;
-        std::string            text;
-        std::vector<uint8_t>   bin;
-
-        Pending(std::string&&  t) : type(Text),   text(std::move(t)) {}
-        Pending(std::vector<uint8_t>&& b, Type t = Binary) : type(t), bin(std::move(b)) {}
+        enum Type : uint8_t { Text, Binary, Close };
+
+        Type type = Text;
+        bool compress = true;   // false: sent raw even when deflate is negotiated
+        uint64_t enqueued_ns = 0;   // steady clock at send time, when latency is tracked
+        size_t len = 0;
+        const uint8_t* ptr = nullptr;
+        std::unique_ptr<uint8_t[]> data;
+        std::shared_ptr<const void> owner;
+
+        Pending() = default;
+        Pending(Type t, const void* p, size_t n, bool c = true)
+            : type(t), compress(c), len(n), data(n ? new uint8_t[n] : nullptr) {
+            if (n) std::memcpy(data.get(), p, n);
+            ptr = data.get();
+        }
+        Pending(Type t, std::shared_ptr<const void> o, const void* p, size_t n, bool c = true)
+            : type(t), compress(c), len(n), ptr(static_cast<const uint8_t*>(p)), owner(std::move(o)) {}
+
+        const uint8_t* bytes() const { return ptr; }
     };
 
-    std::deque<Pending> send_queue;
-    std::mutex send_queue_mutex;
-    
+    MpscQueue<Pending> send_queue;
+
+    bool pushPending(Pending&& p);
+    bool pushPendingBatch(Pending* items, size_t count, size_t bytes);
+    bool popPending(Pending& p);
+    void discardSendQueue();
+
+    bool sendsInline() const;
+    bool sendInline(const void* data, size_t length, MessageType type, bool compress);
+    bool queueSend(Pending&& p);
+    bool queueBatch(Pending* items, size_t count, size_t bytes);
+
+    // Corked: sends only queue, nothing is flushed until setCorked(false)
+    std::atomic_bool corked{false};
+
+    // First reserved extent per flush; larger backlogs continue in new extents
+    static const size_t MAX_FLUSH_EXTENT = 1 << 20;
     void flushSendQueue();
 
+    // Resolves and races the TCP connect; hands the winning socket to _bev
+    std::unique_ptr<WebSocketConnector> connector;
+    void onTcpConnected(evutil_socket_t fd, const std::string& error);
+
+    void applySocketOptions(evutil_socket_t fd, int family);   // before connect()
+    void updateReadWatermark(evbuffer* input);   // after each parse pass
+    size_t read_low_watermark = 0;
+
+    // Backpressure: bytes in send_queue plus bytes in the bufferevent output
+    std::atomic<size_t> queued_bytes{0};
+    std::atomic<size_t> output_bytes{0};   // refreshed on the event thread
+    std::atomic_bool congested{false};     // a send was refused; fire on_writable on drain
+
+    std::mutex bp_mutex;
+    std::condition_variable bp_cv;
+    uint64_t bp_generation = 0;            // bumped under bp_mutex on every drain
+    std::atomic<int> bp_waiters{0};
+
+    bool admit(size_t length);
+    bool waitForRoom(uint64_t seen, std::chrono::steady_clock::time_point deadline);
+    bool overflow(size_t length);
+    void updateBackpressure();
+    void wakeBlockedSenders();
+
     // Libevent objects
     event_base* base = nullptr;
-    evdns_base* dns_base = nullptr;
     bufferevent* _bev = nullptr;
 
+    // Event loop (private or borrowed from a WebSocketEventLoopPool)
+    std::shared_ptr<WebSocketEventLoop> _loop;
+    bool owns_loop = false;
+
     // Thread/state
-    std::thread event_thread;
     std::thread::id event_tid{};
     std::atomic_bool running{false};
+    std::atomic_bool started{false};
+    bool teardown_posted = false;
+
+    // Keeps the context alive while attached to the loop; released by finish()
+    std::shared_ptr<WebSocketContext> self_ref;
+
+    std::mutex finish_mutex;
+    std::condition_variable finish_cv;
+    bool finished = false;
 
     void sendHandshakeRequest();
 
@@ -190,12 +331,12 @@ private:
     // WebSocket key
     std::array<uint8_t,20> hexToBytes(const std::string &hex);
     std::string getWebSocketKey();
+    std::mt19937 key_rng;
     std::string computeAccept(const std::string &key);
 
     // Per-message Deflate
     bool use_compression = false;
-    int compression_level = 6; //Z_BEST_SPEED;
-    
+
     bool server_no_context_takeover = false;
     bool client_no_context_takeover = false;
     int  client_max_window_bits = 15;
@@ -205,8 +346,9 @@ private:
     std::atomic<ConnectionState> connection_state{ConnectionState::DISCONNECTED};
 
     // Close
-    struct event* close_timer = nullptr;
+    WebSocketTimer close_timer{&WebSocketContext::closeTimerCb, this};
     std::atomic_bool stop_requested{false}; // shutdown has been requested
+    std::atomic_bool user_stop{false};      // by stop(): no reconnect after this
     bool close_sent = false;
     bool close_received = false;
 
@@ -214,11 +356,32 @@ private:
     std::atomic<bool> protocol_failed{false};
     std::atomic<bool> close_cb_fired{false};
 
-    // Timeout / Ping / Wakeup
-    struct event *timeout_event = nullptr;
-    struct event *ping_event = nullptr;
+    // Timeout / Ping / Stats on the loop's wheel; set in run()
+    WebSocketTimerWheel* timers = nullptr;
+    WebSocketTimer timeout_timer{&WebSocketContext::timeoutCallback, this};
+    WebSocketTimer ping_timer{&WebSocketContext::pingCallback, this};
+    WebSocketTimer pong_timer{&WebSocketContext::pongTimeoutCallback, this};
+    WebSocketTimer stats_timer{&WebSocketContext::statsCallback, this};
+    WebSocketTimer reconnect_timer{&WebSocketContext::reconnectCallback, this};
+    bool retry_allowed = false;         // set once the first attempt starts
+    unsigned reconnect_failures = 0;    // retries since the last open
+    static void statsCallback(void *arg);
+
+    // Wakeup
     struct event *wakeup_event = nullptr;
 
+    // Shared with the client so totals survive reconnects
+    std::shared_ptr<WebSocketCounters> counters;
+    WebSocketHistogram* rtt_histogram = nullptr;    // with pings enabled
+    WebSocketHistogram* send_latency = nullptr;     // with send latency tracking
+
+    // Ping payload: magic, sequence number, steady clock send time
+    static const size_t PING_PAYLOAD_SIZE = 16;
+    uint32_t ping_seq = 0;
+    uint32_t pong_seq = 0;   // newest sequence answered
+    uint32_t pong_awaited = 0;   // ping the pong deadline is for
+    std::chrono::steady_clock::time_point connect_started;
+
     // Sender
     struct event *send_event = nullptr;
     std::atomic_bool send_flush_pending{false};
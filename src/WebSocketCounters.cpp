@@ -0,0 +1,128 @@
+/*
+ *  WebSocketCounters.cpp
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "WebSocketCounters.h"
+
+#include <algorithm>
+#include <mutex>
+#include <set>
+
+namespace {
+
+struct Registry {
+    std::mutex mtx;
+    std::set<const WebSocketCounters*> live;
+    WebSocketStats retired;
+};
+
+Registry& registry() {
+    static Registry* r = new Registry;   // never destroyed: clients may outlive static teardown
+    return *r;
+}
+
+void accumulate(WebSocketStats& sum, const WebSocketStats& s) {
+    sum.messagesIn          += s.messagesIn;
+    sum.messagesOut         += s.messagesOut;
+    sum.framesIn            += s.framesIn;
+    sum.framesOut           += s.framesOut;
+    sum.bytesIn             += s.bytesIn;
+    sum.bytesOut            += s.bytesOut;
+    sum.txUncompressedBytes += s.txUncompressedBytes;
+    sum.txCompressedBytes   += s.txCompressedBytes;
+    sum.rxCompressedBytes   += s.rxCompressedBytes;
+    sum.rxUncompressedBytes += s.rxUncompressedBytes;
+    sum.deflateTimeUs       += s.deflateTimeUs;
+    sum.inflateTimeUs       += s.inflateTimeUs;
+    sum.deflateBufferGrows  += s.deflateBufferGrows;
+    sum.sendsRejected       += s.sendsRejected;
+    sum.sendQueueHighWater   = std::max(sum.sendQueueHighWater, s.sendQueueHighWater);
+    sum.outputBufferLength  += s.outputBufferLength;
+    sum.connects            += s.connects;
+    sum.reconnects          += s.reconnects;
+    sum.opens               += s.opens;
+    sum.lastConnectUs        = std::max(sum.lastConnectUs, s.lastConnectUs);
+    sum.lastHandshakeUs      = std::max(sum.lastHandshakeUs, s.lastHandshakeUs);
+    sum.pingsSent           += s.pingsSent;
+    sum.pongsReceived       += s.pongsReceived;
+}
+
+} // namespace
+
+WebSocketCounters::WebSocketCounters() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lk(r.mtx);
+    r.live.insert(this);
+}
+
+WebSocketCounters::~WebSocketCounters() {
+    WebSocketStats s;
+    snapshot(s);
+    s.outputBufferLength = 0;   // nothing left buffered
+
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lk(r.mtx);
+        r.live.erase(this);
+        accumulate(r.retired, s);
+    }
+
+    delete rtt_hist.load(std::memory_order_acquire);
+    delete send_hist.load(std::memory_order_acquire);
+}
+
+WebSocketHistogram* WebSocketCounters::histogram(std::atomic<WebSocketHistogram*>& slot, bool create) {
+    WebSocketHistogram* h = slot.load(std::memory_order_acquire);
+    if (h || !create) return h;
+
+    WebSocketHistogram* fresh = new WebSocketHistogram;
+    if (slot.compare_exchange_strong(h, fresh, std::memory_order_acq_rel)) return fresh;
+    delete fresh;   // lost the race; h is the winner
+    return h;
+}
+
+void WebSocketCounters::snapshot(WebSocketStats& out) const {
+    auto get = [](const Counter& c) { return c.load(std::memory_order_relaxed); };
+
+    out.messagesIn          = get(messages_in);
+    out.messagesOut         = get(messages_out);
+    out.framesIn            = get(frames_in);
+    out.framesOut           = get(frames_out);
+    out.bytesIn             = get(bytes_in);
+    out.bytesOut            = get(bytes_out);
+    out.txUncompressedBytes = get(tx_uncompressed);
+    out.txCompressedBytes   = get(tx_compressed);
+    out.rxCompressedBytes   = get(rx_compressed);
+    out.rxUncompressedBytes = get(rx_uncompressed);
+    out.deflateTimeUs       = get(deflate_ns) / 1000;
+    out.inflateTimeUs       = get(inflate_ns) / 1000;
+    out.deflateBufferGrows  = get(deflate_grows);
+    out.sendsRejected       = get(sends_rejected);
+    out.sendQueueHighWater  = get(queue_high_water);
+    out.outputBufferLength  = static_cast<size_t>(get(output_bytes));
+    out.connects            = get(connects);
+    out.reconnects          = out.connects ? out.connects - 1 : 0;
+    out.opens               = get(opens);
+    out.lastConnectUs       = get(last_connect_us);
+    out.lastHandshakeUs     = get(last_handshake_us);
+    out.pingsSent           = get(pings_sent);
+    out.pongsReceived       = get(pongs_received);
+    out.lastRttUs           = get(last_rtt_us);
+
+    if (const WebSocketHistogram* h = rtt_hist.load(std::memory_order_acquire)) h->snapshot(out.rtt);
+    if (const WebSocketHistogram* h = send_hist.load(std::memory_order_acquire)) h->snapshot(out.sendLatency);
+}
+
+void WebSocketCounters::global(WebSocketStats& out) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lk(r.mtx);
+
+    out = r.retired;
+    for (const WebSocketCounters* c : r.live) {
+        WebSocketStats s;
+        c->snapshot(s);
+        accumulate(out, s);
+    }
+}
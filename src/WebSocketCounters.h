@@ -0,0 +1,116 @@
+/*
+ *  WebSocketCounters.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "WebSocketStats.h"
+#include "WebSocketHistogram.h"
+
+/**
+ * \brief Live counters behind WebSocketStats, one set per client.
+ *
+ * Most fields have a single writer, the event thread of the client's
+ * current connection, and are bumped with a relaxed load and store
+ * instead of a locked read-modify-write. Readers on other threads take
+ * relaxed loads, so a snapshot is never torn per field but need not be
+ * consistent across fields.
+ *
+ * Every instance is registered for the process-wide aggregate; on
+ * destruction its totals are folded into that aggregate.
+ */
+struct WebSocketCounters {
+    WebSocketCounters();
+    ~WebSocketCounters();
+
+    WebSocketCounters(const WebSocketCounters&) = delete;
+    WebSocketCounters& operator=(const WebSocketCounters&) = delete;
+
+    using Counter = std::atomic<uint64_t>;
+
+    static void bump(Counter& c, uint64_t n = 1) {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    // Any thread
+    static void add(Counter& c, uint64_t n = 1) { c.fetch_add(n, std::memory_order_relaxed); }
+    static void raise(Counter& c, uint64_t v) {
+        uint64_t cur = c.load(std::memory_order_relaxed);
+        while (v > cur && !c.compare_exchange_weak(cur, v, std::memory_order_relaxed)) {}
+    }
+
+    static uint64_t nowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    static uint64_t elapsedNs(std::chrono::steady_clock::time_point since) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - since).count());
+    }
+
+    /// Adds the scope's duration in nanoseconds to a counter; no clock reads when null
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Counter* c) : counter(c) {
+            if (counter) start = std::chrono::steady_clock::now();
+        }
+        ~ScopedTimer() {
+            if (counter) bump(*counter, elapsedNs(start));
+        }
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Counter* counter;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    // Event thread
+    Counter messages_in{0};
+    Counter messages_out{0};
+    Counter frames_in{0};
+    Counter frames_out{0};
+    Counter bytes_in{0};
+    Counter bytes_out{0};
+    Counter tx_uncompressed{0};
+    Counter tx_compressed{0};
+    Counter rx_compressed{0};
+    Counter rx_uncompressed{0};
+    Counter deflate_ns{0};
+    Counter inflate_ns{0};
+    Counter deflate_grows{0};
+    Counter output_bytes{0};     // gauge
+    Counter last_connect_us{0};
+    Counter last_handshake_us{0};
+    Counter pings_sent{0};
+    Counter pongs_received{0};
+    Counter last_rtt_us{0};
+
+    // Any thread
+    Counter sends_rejected{0};
+    Counter queue_high_water{0};
+    Counter connects{0};
+    Counter opens{0};
+
+    /// Histograms are allocated on first use and kept for the client's lifetime
+    WebSocketHistogram* rttHistogram(bool create = false) { return histogram(rtt_hist, create); }
+    WebSocketHistogram* sendLatencyHistogram(bool create = false) { return histogram(send_hist, create); }
+
+    /// Counters only; queue and buffer gauges come from the live connection
+    void snapshot(WebSocketStats& out) const;
+
+    /// Sum over every client, past and present; latencies and gauges other than the output buffer stay 0
+    static void global(WebSocketStats& out);
+
+private:
+    static WebSocketHistogram* histogram(std::atomic<WebSocketHistogram*>& slot, bool create);
+
+    std::atomic<WebSocketHistogram*> rtt_hist{nullptr};
+    std::atomic<WebSocketHistogram*> send_hist{nullptr};
+};
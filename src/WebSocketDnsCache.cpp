@@ -0,0 +1,58 @@
+/*
+ *  WebSocketDnsCache.cpp
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "WebSocketDnsCache.h"
+
+const size_t WebSocketDnsCache::MAX_ENTRIES;
+
+WebSocketDnsCache& WebSocketDnsCache::instance() {
+    static WebSocketDnsCache* cache = new WebSocketDnsCache;   // never destroyed: loops may outlive static teardown
+    return *cache;
+}
+
+bool WebSocketDnsCache::lookup(const std::string& host, int family, std::vector<WebSocketAddress>& out) {
+    const auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lk(mtx);
+    auto it = entries.find(std::make_pair(host, family));
+    if (it == entries.end()) return false;
+    if (it->second.expires <= now) {
+        entries.erase(it);
+        return false;
+    }
+    out = it->second.addrs;
+    return true;
+}
+
+void WebSocketDnsCache::store(const std::string& host, int family, const std::vector<WebSocketAddress>& addrs,
+                              unsigned int ttl_seconds) {
+    if (ttl_seconds == 0) return;
+
+    const auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lk(mtx);
+    if (entries.size() >= MAX_ENTRIES) {
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (it->second.expires <= now) it = entries.erase(it);
+            else ++it;
+        }
+        if (entries.size() >= MAX_ENTRIES) entries.erase(entries.begin());
+    }
+
+    Entry& e = entries[std::make_pair(host, family)];
+    e.addrs = addrs;
+    e.expires = now + std::chrono::seconds(ttl_seconds);
+}
+
+void WebSocketDnsCache::clear() {
+    std::lock_guard<std::mutex> lk(mtx);
+    entries.clear();
+}
+
+size_t WebSocketDnsCache::size() const {
+    std::lock_guard<std::mutex> lk(mtx);
+    return entries.size();
+}
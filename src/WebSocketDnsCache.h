@@ -0,0 +1,73 @@
+/*
+ *  WebSocketDnsCache.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+#include <sys/socket.h>
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * \brief One resolved address; the port is filled in by the connector.
+ */
+struct WebSocketAddress {
+    sockaddr_storage addr;
+    socklen_t len;
+
+    int family() const { return addr.ss_family; }
+};
+
+/**
+ * \brief Process-wide cache of resolved addresses.
+ *
+ * Entries are keyed by host name and address family and expire after
+ * their DNS TTL, so reconnect storms resolve each name once instead of
+ * once per connection. An empty entry records that the name has no
+ * addresses of that family (NODATA), so an IPv4-only host is not asked
+ * for AAAA on every connect. Thread-safe; shared by every event loop.
+ */
+class WebSocketDnsCache {
+public:
+    static WebSocketDnsCache& instance();
+
+    /**
+     * \brief Fetch a live entry.
+     * \return false if there is none or it has expired; true with out
+     *         empty if the family is known to have no addresses.
+     */
+    bool lookup(const std::string& host, int family, std::vector<WebSocketAddress>& out);
+
+    /**
+     * \brief Insert or replace an entry; ttl_seconds == 0 stores nothing.
+     *
+     * Empty addrs make a negative entry for the family.
+     */
+    void store(const std::string& host, int family, const std::vector<WebSocketAddress>& addrs,
+               unsigned int ttl_seconds);
+
+    void clear();
+    size_t size() const;
+
+private:
+    WebSocketDnsCache() = default;
+    WebSocketDnsCache(const WebSocketDnsCache&) = delete;
+    WebSocketDnsCache& operator=(const WebSocketDnsCache&) = delete;
+
+    static const size_t MAX_ENTRIES = 4096;
+
+    struct Entry {
+        std::vector<WebSocketAddress> addrs;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    mutable std::mutex mtx;
+    std::map<std::pair<std::string, int>, Entry> entries;
+};
@@ -0,0 +1,160 @@
+/*
+ *  WebSocketEventLoop.cpp
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "WebSocketEventLoop.h"
+#include "Logger.h"
+#include "WebSocketConnector.h"
+
+#include <event2/thread.h>
+
+static std::once_flag g_evthread_once;
+
+void WebSocketEventLoop::libeventThreads() {
+    std::call_once(g_evthread_once, []() {
+        evthread_use_pthreads();
+    });
+}
+
+WebSocketEventLoop::~WebSocketEventLoop() {
+    stop();
+
+    // Last reference dropped by the loop thread itself, after dispatch returned.
+    if (loop_thread.joinable()) {
+        loop_thread.detach();
+    }
+
+    std::vector<Task> pending;
+    {
+        std::lock_guard<std::mutex> lk(task_mutex);
+        pending.swap(tasks);
+    }
+    pending.clear();
+
+    if (task_event) {
+        event_del(task_event);
+        event_free(task_event);
+        task_event = nullptr;
+    }
+
+    if (keepalive_event) {
+        event_del(keepalive_event);
+        event_free(keepalive_event);
+        keepalive_event = nullptr;
+    }
+
+    _timers.reset();
+
+    if (_dns) {
+        // Freed without failing requests, so their callbacks never run
+        WebSocketConnector::releaseResolver(_dns);
+        evdns_base_free(_dns, 0);
+        _dns = nullptr;
+    }
+
+    if (_base) {
+        event_base_free(_base);
+        _base = nullptr;
+    }
+}
+
+bool WebSocketEventLoop::start(std::string& err) {
+    err.clear();
+
+    libeventThreads();
+
+    _base = event_base_new();
+    if (!_base) {
+        err = "Failed to create event_base";
+        return false;
+    }
+
+    task_event = event_new(_base, -1, EV_PERSIST, &WebSocketEventLoop::taskCallback, this);
+    if (!task_event) {
+        err = "Failed to create task event";
+        return false;
+    }
+
+    int flags = 0;
+#ifdef EVLOOP_NO_EXIT_ON_EMPTY
+    flags = EVLOOP_NO_EXIT_ON_EMPTY;
+#else
+    // libevent 2.0: a long persistent timer keeps an idle loop dispatching
+    keepalive_event = event_new(_base, -1, EV_PERSIST, [](evutil_socket_t, short, void*) {}, nullptr);
+    if (!keepalive_event) {
+        err = "Failed to create keepalive event";
+        return false;
+    }
+    timeval tv{3600, 0};
+    event_add(keepalive_event, &tv);
+#endif
+
+    auto self = shared_from_this();
+    loop_thread = std::thread([self, flags]() {
+        event_base_loop(self->_base, flags);
+        log_debug("event loop exited");
+    });
+    loop_tid = loop_thread.get_id();
+
+    return true;
+}
+
+void WebSocketEventLoop::stop() {
+    if (!stopped.exchange(true, std::memory_order_acq_rel) && _base) {
+        event_base_loopexit(_base, nullptr);
+    }
+
+    if (loop_thread.joinable() && !isLoopThread()) {
+        loop_thread.join();
+    }
+}
+
+void WebSocketEventLoop::post(Task task) {
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lk(task_mutex);
+        wake = tasks.empty();
+        tasks.push_back(std::move(task));
+    }
+    if (wake && task_event) {
+        event_active(task_event, 0, 0);
+    }
+}
+
+evdns_base* WebSocketEventLoop::dnsBase() {
+    // loop thread only
+    if (!_dns && _base) {
+        _dns = evdns_base_new(_base, 1);
+        if (!_dns) {
+            log_error("Failed to create DNS base");
+        }
+    }
+    return _dns;
+}
+
+WebSocketTimerWheel& WebSocketEventLoop::timers() {
+    // loop thread only
+    if (!_timers) {
+        _timers.reset(new WebSocketTimerWheel(_base));
+    }
+    return *_timers;
+}
+
+void WebSocketEventLoop::taskCallback(evutil_socket_t /*fd*/, short /*events*/, void* arg) {
+    auto* self = static_cast<WebSocketEventLoop*>(arg);
+    self->runTasks();
+}
+
+void WebSocketEventLoop::runTasks() {
+    std::vector<Task> local;
+    {
+        std::lock_guard<std::mutex> lk(task_mutex);
+        local.swap(tasks);
+    }
+
+    for (auto& task : local) {
+        task();
+    }
+}
@@ -0,0 +1,77 @@
+/*
+ *  WebSocketEventLoop.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+#include <event2/event.h>
+#include <event2/dns.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "WebSocketTimerWheel.h"
+
+/**
+ * \brief A single libevent loop running on its own thread.
+ *
+ * Owns the event_base, a lazily created evdns_base and timer wheel shared
+ * by every connection attached to the loop, and the thread dispatching it.
+ * Work from other threads is handed over with post().
+ *
+ * The loop thread keeps the object alive until stop() has been called
+ * and the dispatch has returned.
+ */
+class WebSocketEventLoop : public std::enable_shared_from_this<WebSocketEventLoop> {
+public:
+    using Task = std::function<void()>;
+
+    WebSocketEventLoop() = default;
+    ~WebSocketEventLoop();
+
+    WebSocketEventLoop(const WebSocketEventLoop&) = delete;
+    WebSocketEventLoop& operator=(const WebSocketEventLoop&) = delete;
+
+    bool start(std::string& err);
+    void stop();
+
+    // Run task on the loop thread (any thread).
+    void post(Task task);
+
+    bool isLoopThread() const { return std::this_thread::get_id() == loop_tid; }
+    std::thread::id threadId() const { return loop_tid; }
+
+    event_base* base() const { return _base; }
+    evdns_base* dnsBase();  // loop thread only
+    WebSocketTimerWheel& timers();  // loop thread only
+
+    // Connection accounting used by WebSocketEventLoopPool
+    void attach() { connections.fetch_add(1, std::memory_order_relaxed); }
+    void detach() { connections.fetch_sub(1, std::memory_order_relaxed); }
+    size_t load() const { return connections.load(std::memory_order_relaxed); }
+
+private:
+    static void libeventThreads();
+    static void taskCallback(evutil_socket_t fd, short events, void* arg);
+    void runTasks();
+
+    event_base* _base = nullptr;
+    evdns_base* _dns = nullptr;
+    std::unique_ptr<WebSocketTimerWheel> _timers;
+    event* task_event = nullptr;
+    event* keepalive_event = nullptr;
+
+    std::mutex task_mutex;
+    std::vector<Task> tasks;
+
+    std::thread loop_thread;
+    std::thread::id loop_tid{};
+    std::atomic_bool stopped{false};
+    std::atomic<size_t> connections{0};
+};
@@ -0,0 +1,59 @@
+/*
+ *  WebSocketEventLoopPool.cpp
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "WebSocketEventLoopPool.h"
+#include "WebSocketEventLoop.h"
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+WebSocketEventLoopPool::WebSocketEventLoopPool(size_t count, Strategy s) : strategy(s) {
+    if (count == 0) {
+        count = std::thread::hardware_concurrency();
+        if (count == 0) count = 1;
+    }
+
+    loops.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto loop = std::make_shared<WebSocketEventLoop>();
+        std::string err;
+        if (!loop->start(err)) {
+            for (auto& l : loops) l->stop();
+            throw std::runtime_error("WebSocketEventLoopPool: " + err);
+        }
+        loops.push_back(std::move(loop));
+    }
+}
+
+WebSocketEventLoopPool::~WebSocketEventLoopPool() {
+    for (auto& l : loops) {
+        l->stop();
+    }
+}
+
+size_t WebSocketEventLoopPool::connectionCount() const {
+    size_t total = 0;
+    for (const auto& l : loops) {
+        total += l->load();
+    }
+    return total;
+}
+
+std::shared_ptr<WebSocketEventLoop> WebSocketEventLoopPool::acquire() {
+    if (strategy == Strategy::LEAST_LOADED) {
+        // Start from a rotating index so ties do not all land on loop 0
+        const size_t start = next.fetch_add(1, std::memory_order_relaxed);
+        size_t best = start % loops.size();
+        for (size_t i = 1; i < loops.size(); ++i) {
+            const size_t idx = (start + i) % loops.size();
+            if (loops[idx]->load() < loops[best]->load()) best = idx;
+        }
+        return loops[best];
+    }
+
+    return loops[next.fetch_add(1, std::memory_order_relaxed) % loops.size()];
+}
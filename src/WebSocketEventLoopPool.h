@@ -0,0 +1,76 @@
+/*
+ *  WebSocketEventLoopPool.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class WebSocketEventLoop;
+
+/**
+ * \brief Shared pool of event loops for WebSocketClient instances.
+ *
+ * By default every client runs its own event thread. Clients attached to a
+ * pool (see WebSocketClient::setEventLoopPool()) share a fixed number of
+ * loops instead, so thread and resolver count no longer grow with the
+ * number of connections.
+ *
+ * Each loop owns one thread, one event_base and one DNS resolver.
+ * A client picks its loop on connect() and stays on it until disconnect().
+ */
+class WebSocketEventLoopPool {
+public:
+
+    enum class Strategy {
+        ROUND_ROBIN,    ///< Assign loops in turn
+        LEAST_LOADED    ///< Assign the loop with the fewest active connections
+    };
+
+    /**
+     * \brief Create and start the pool.
+     *
+     * \param loops    Number of event loops (threads).
+     *                 0 uses std::thread::hardware_concurrency().
+     * \param strategy How connections are spread across loops.
+     * \throws std::runtime_error if a loop cannot be created.
+     */
+    explicit WebSocketEventLoopPool(size_t loops = 0, Strategy strategy = Strategy::ROUND_ROBIN);
+
+    /**
+     * \brief Stop and join all loops.
+     *
+     * Clients hold a reference to their pool, so this normally runs
+     * after the last attached client has been destroyed.
+     */
+    ~WebSocketEventLoopPool();
+
+    // non-copyable
+    WebSocketEventLoopPool(const WebSocketEventLoopPool&) = delete;
+    WebSocketEventLoopPool& operator=(const WebSocketEventLoopPool&) = delete;
+
+    /**
+     * \brief Number of loops in the pool.
+     */
+    size_t size() const { return loops.size(); }
+
+    /**
+     * \brief Total number of connections currently attached to the pool.
+     */
+    size_t connectionCount() const;
+
+    /**
+     * \brief Pick a loop for a new connection according to the strategy.
+     */
+    std::shared_ptr<WebSocketEventLoop> acquire();
+
+private:
+    Strategy strategy;
+    std::vector<std::shared_ptr<WebSocketEventLoop>> loops;
+    std::atomic<size_t> next{0};
+};
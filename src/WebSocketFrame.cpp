@@ -0,0 +1,121 @@
+/*
+ *  WebSocketFrame.cpp
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "WebSocketFrame.h"
+#include "WebSocketMask.h"
+
+#include <arpa/inet.h>
+#include <cstring>
+#include <ctime>
+
+#ifndef htonll
+#define htonll(x) ((1==htonl(1)) ? (x) : ((uint64_t)htonl((x) & 0xFFFFFFFF) << 32) | htonl((x) >> 32))
+#endif
+
+size_t WebSocketFrame::headerSize(size_t payload_len) {
+    size_t n = 2 + 4;
+    if (payload_len > 65535) n += 8;
+    else if (payload_len > 125) n += 2;
+    return n;
+}
+
+size_t WebSocketFrame::writeHeader(uint8_t* dst, uint8_t b1, size_t payload_len, const uint8_t key[4]) {
+    size_t n = 0;
+    dst[n++] = b1;
+
+    if (payload_len <= 125) {
+        dst[n++] = static_cast<uint8_t>(0x80 | payload_len);  // Mask bit
+    } else if (payload_len <= 65535) {
+        dst[n++] = 0x80 | 126;
+        uint16_t len = htons(static_cast<uint16_t>(payload_len));
+        std::memcpy(dst + n, &len, 2);
+        n += 2;
+    } else {
+        dst[n++] = 0x80 | 127;
+        uint64_t len = htonll(static_cast<uint64_t>(payload_len));
+        std::memcpy(dst + n, &len, 8);
+        n += 8;
+    }
+
+    std::memcpy(dst + n, key, 4);
+    return n + 4;
+}
+
+size_t WebSocketFrame::write(uint8_t* dst, uint8_t b1, const uint8_t* payload, size_t len, const uint8_t key[4]) {
+    const size_t hdr = writeHeader(dst, b1, len, key);
+    WebSocketMask::apply(dst + hdr, payload, len, key);
+    return hdr + len;
+}
+
+bool WebSocketFrame::append(evbuffer* out, uint8_t b1, const uint8_t* payload, size_t len, const uint8_t key[4]) {
+    const size_t total = headerSize(len) + len;
+
+    // One extent: header and payload end up in the same chain
+    evbuffer_iovec vec;
+    if (evbuffer_reserve_space(out, static_cast<ev_ssize_t>(total), &vec, 1) != 1) {
+        return false;
+    }
+
+    vec.iov_len = write(static_cast<uint8_t*>(vec.iov_base), b1, payload, len, key);
+    return evbuffer_commit_space(out, &vec, 1) == 0;
+}
+
+WebSocketFrameWriter::WebSocketFrameWriter(evbuffer* out_, size_t size_hint)
+    : out(out_), hint(size_hint) {
+    vec.iov_base = nullptr;
+    vec.iov_len = 0;
+}
+
+WebSocketFrameWriter::~WebSocketFrameWriter() {
+    commit();
+}
+
+bool WebSocketFrameWriter::add(uint8_t b1, const uint8_t* payload, size_t len, const uint8_t key[4]) {
+    const size_t total = WebSocketFrame::headerSize(len) + len;
+
+    if (reserved && vec.iov_len - used < total && !commit()) return false;
+
+    if (!reserved) {
+        const size_t want = total > hint ? total : hint;
+        if (evbuffer_reserve_space(out, static_cast<ev_ssize_t>(want), &vec, 1) != 1) {
+            return false;
+        }
+        reserved = true;
+        used = 0;
+    }
+
+    used += WebSocketFrame::write(static_cast<uint8_t*>(vec.iov_base) + used, b1, payload, len, key);
+    ++count;
+    return true;
+}
+
+bool WebSocketFrameWriter::commit() {
+    if (!reserved) return true;
+    reserved = false;
+    if (used == 0) return true;   // an unused reservation is simply dropped
+    vec.iov_len = used;
+    used = 0;
+    return evbuffer_commit_space(out, &vec, 1) == 0;
+}
+
+void WebSocketFrame::nextMaskKey(uint8_t key[4]) {
+    thread_local uint32_t s = 0;
+    if (s == 0) {
+        uint64_t t = static_cast<uint64_t>(time(nullptr));
+        uintptr_t a = reinterpret_cast<uintptr_t>(&s);
+        s = static_cast<uint32_t>((t ^ (t >> 32) ^ a) | 1u);
+    }
+
+    s += 0x9E3779B9u;
+    uint32_t z = s;
+    z ^= z >> 16;
+    z *= 0x85EBCA6Bu;
+    z ^= z >> 13;
+    z *= 0xC2B2AE35u;
+    z ^= z >> 16;
+
+    std::memcpy(key, &z, 4);
+}
@@ -0,0 +1,93 @@
+/*
+ *  WebSocketFrame.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+#include <event2/buffer.h>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * \brief Client frame serialization (RFC 6455, section 5.2).
+ *
+ * Header and masked payload are written in one pass into space
+ * reserved directly in the output evbuffer, so the frame is one
+ * contiguous chain and the payload is copied exactly once.
+ */
+struct WebSocketFrame {
+    static const size_t MAX_HEADER = 14;   ///< 2 + 8 (extended length) + 4 (mask key)
+
+    /**
+     * \brief Size of a masked client frame header for the given payload length.
+     */
+    static size_t headerSize(size_t payload_len);
+
+    /**
+     * \brief Write a masked frame header into dst (at least headerSize() bytes).
+     *
+     * \param b1 First header byte (FIN, RSV bits and opcode).
+     * \return Number of bytes written.
+     */
+    static size_t writeHeader(uint8_t* dst, uint8_t b1, size_t payload_len, const uint8_t key[4]);
+
+    /**
+     * \brief Write a complete frame (header + masked payload) into dst.
+     *
+     * \return Number of bytes written (headerSize(len) + len).
+     */
+    static size_t write(uint8_t* dst, uint8_t b1, const uint8_t* payload, size_t len, const uint8_t key[4]);
+
+    /**
+     * \brief Append a complete frame to out using a single reserved region.
+     *
+     * \return false if the evbuffer could not provide the space.
+     */
+    static bool append(evbuffer* out, uint8_t b1, const uint8_t* payload, size_t len, const uint8_t key[4]);
+
+    /**
+     * \brief Generate a fresh masking key (fast per-thread PRNG).
+     */
+    static void nextMaskKey(uint8_t key[4]);
+};
+
+/**
+ * \brief Appends consecutive frames into shared reserved extents.
+ *
+ * Frames are written back to back into one region reserved in the output
+ * evbuffer (at least size_hint bytes), which is committed once when the
+ * writer is done, so a burst of small messages becomes one contiguous
+ * chain instead of one chain per frame. No other operation may touch the
+ * evbuffer while a writer is active.
+ */
+class WebSocketFrameWriter {
+public:
+    WebSocketFrameWriter(evbuffer* out, size_t size_hint);
+    ~WebSocketFrameWriter();
+
+    /**
+     * \brief Append a complete frame (header + masked payload).
+     *
+     * \return false if the evbuffer could not provide the space.
+     */
+    bool add(uint8_t b1, const uint8_t* payload, size_t len, const uint8_t key[4]);
+
+    /**
+     * \brief Commit everything written so far; add() may be called again afterwards.
+     */
+    bool commit();
+
+    size_t frames() const { return count; }
+
+private:
+    WebSocketFrameWriter(const WebSocketFrameWriter&) = delete;
+    WebSocketFrameWriter& operator=(const WebSocketFrameWriter&) = delete;
+
+    evbuffer* out;
+    size_t hint;
+    evbuffer_iovec vec;
+    size_t used = 0;
+    bool reserved = false;
+    size_t count = 0;
+};
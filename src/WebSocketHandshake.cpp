@@ -0,0 +1,236 @@
+/*
+ *  WebSocketHandshake.cpp
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "WebSocketHandshake.h"
+
+#include <algorithm>
+#include <cstring>
+
+const size_t WebSocketHandshake::KEY_LENGTH;
+const size_t WebSocketHandshake::MAX_RESPONSE_SIZE;
+
+namespace {
+
+inline char lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+inline bool isOws(char c) {
+    return c == ' ' || c == '\t';
+}
+
+void trim(const char*& b, const char*& e) {
+    while (b < e && isOws(*b)) ++b;
+    while (e > b && isOws(e[-1])) --e;
+}
+
+// Case-insensitive compare of [b, e) against a lowercase literal
+template <size_t N>
+bool ieq(const char* b, const char* e, const char (&lit)[N]) {
+    if (static_cast<size_t>(e - b) != N - 1) return false;
+    for (size_t i = 0; i < N - 1; ++i) {
+        if (lower(b[i]) != lit[i]) return false;
+    }
+    return true;
+}
+
+const char* find(const char* b, const char* e, char c) {
+    const void* p = std::memchr(b, c, static_cast<size_t>(e - b));
+    return p ? static_cast<const char*>(p) : e;
+}
+
+// Does the comma-separated list [b, e) contain tok?
+template <size_t N>
+bool hasListToken(const char* b, const char* e, const char (&tok)[N]) {
+    while (b < e) {
+        const char* comma = find(b, e, ',');
+        const char* tb = b;
+        const char* te = comma;
+        trim(tb, te);
+        if (ieq(tb, te, tok)) return true;
+        b = comma + 1;
+    }
+    return false;
+}
+
+int parseBits(const char* b, const char* e) {
+    if (e - b >= 2 && *b == '"' && e[-1] == '"') { ++b; --e; }
+    if (b == e || e - b > 2) return 15;
+
+    int v = 0;
+    for (; b < e; ++b) {
+        if (*b < '0' || *b > '9') return 15;
+        v = v * 10 + (*b - '0');
+    }
+    return (v >= 8 && v <= 15) ? v : 15;
+}
+
+} // namespace
+
+WebSocketHandshake::WebSocketHandshake(const std::string& host, unsigned short port, const std::string& uri,
+                                       const WebSocketHeaders& headers, bool compression,
+                                       const WebSocketCompressionOptions& compression_options) {
+    const std::string host_port = host + ":" + std::to_string(port);
+
+    text.reserve(256);
+    text += "GET " + uri + " HTTP/1.1\r\n";
+    text += "Host:" + host_port + "\r\n";
+    text += "Upgrade:websocket\r\n";
+    text += "Connection:upgrade\r\n";
+    text += "Sec-WebSocket-Key:";
+    key_offset = text.size();
+    text.append(KEY_LENGTH, 'A');
+    text += "\r\n";
+    text += "Sec-WebSocket-Version:13\r\n";
+
+    if (compression) {
+        text += "Sec-WebSocket-Extensions:" + compressionOffer(compression_options) + "\r\n";
+    }
+
+    text += "Origin:http://" + host_port + "\r\n";
+
+    for (const auto& header : headers.headers) {
+        text += header.first + ":" + header.second + "\r\n";
+    }
+
+    text += "\r\n";
+}
+
+bool WebSocketHandshake::write(evbuffer* out, const std::string& key) const {
+    if (key.size() != KEY_LENGTH) return false;
+
+    evbuffer_iovec vec;
+    if (evbuffer_reserve_space(out, static_cast<ev_ssize_t>(text.size()), &vec, 1) != 1) return false;
+
+    char* dst = static_cast<char*>(vec.iov_base);
+    std::memcpy(dst, text.data(), text.size());
+    std::memcpy(dst + key_offset, key.data(), KEY_LENGTH);
+
+    vec.iov_len = text.size();
+    return evbuffer_commit_space(out, &vec, 1) == 0;
+}
+
+bool WebSocketHandshake::parseResponse(const char* data, size_t len, WebSocketHandshakeResponse& out) {
+    const char* p = data;
+    const char* const end = data + len;
+
+    // Status line: HTTP/1.x SSS [reason]
+    const char* eol = find(p, end, '\n');
+    if (eol == end) return false;
+    const char* le = (eol > p && eol[-1] == '\r') ? eol - 1 : eol;
+
+    if (le - p < 12 || std::memcmp(p, "HTTP/1.", 7) != 0 || p[8] != ' ') return false;
+    int status = 0;
+    for (int i = 9; i < 12; ++i) {
+        if (p[i] < '0' || p[i] > '9') return false;
+        status = status * 10 + (p[i] - '0');
+    }
+    if (le - p > 12 && p[12] != ' ') return false;
+    out.status = status;
+    p = eol + 1;
+
+    // Header lines until the empty line
+    while (p < end) {
+        eol = find(p, end, '\n');
+        if (eol == end) return false;
+        le = (eol > p && eol[-1] == '\r') ? eol - 1 : eol;
+
+        if (le == p) return true;   // end of headers
+
+        const char* colon = find(p, le, ':');
+        if (colon == le) return false;
+
+        const char* nb = p;
+        const char* ne = colon;
+        const char* vb = colon + 1;
+        const char* ve = le;
+        trim(nb, ne);
+        trim(vb, ve);
+
+        if (ieq(nb, ne, "upgrade")) {
+            out.upgrade_websocket = ieq(vb, ve, "websocket");
+        } else if (ieq(nb, ne, "connection")) {
+            out.connection_upgrade = out.connection_upgrade || hasListToken(vb, ve, "upgrade");
+        } else if (ieq(nb, ne, "sec-websocket-accept")) {
+            out.accept = vb;
+            out.accept_len = static_cast<size_t>(ve - vb);
+        } else if (ieq(nb, ne, "sec-websocket-extensions")) {
+            parseDeflate(vb, static_cast<size_t>(ve - vb), out.deflate);
+        }
+
+        p = eol + 1;
+    }
+    return false;
+}
+
+void WebSocketHandshake::parseDeflate(const char* value, size_t len, WebSocketDeflateResponse& out) {
+    const char* p = value;
+    const char* const end = value + len;
+
+    // ext-list: ext *( "," ext ), ext: name *( ";" param[=value] )
+    while (p < end && !out.present) {
+        const char* ext_end = find(p, end, ',');
+
+        const char* semi = find(p, ext_end, ';');
+        const char* nb = p;
+        const char* ne = semi;
+        trim(nb, ne);
+
+        if (ieq(nb, ne, "permessage-deflate")) {
+            out.present = true;
+
+            const char* q = semi;
+            while (q < ext_end) {
+                ++q;   // skip ';'
+                const char* param_end = find(q, ext_end, ';');
+                const char* eq = find(q, param_end, '=');
+
+                const char* kb = q;
+                const char* ke = eq;
+                trim(kb, ke);
+                const char* vb = eq < param_end ? eq + 1 : param_end;
+                const char* ve = param_end;
+                trim(vb, ve);
+
+                if (ieq(kb, ke, "client_no_context_takeover")) {
+                    out.client_no_context_takeover = true;
+                } else if (ieq(kb, ke, "server_no_context_takeover")) {
+                    out.server_no_context_takeover = true;
+                } else if (ieq(kb, ke, "client_max_window_bits")) {
+                    out.client_max_window_bits = parseBits(vb, ve);
+                } else if (ieq(kb, ke, "server_max_window_bits")) {
+                    out.server_max_window_bits = parseBits(vb, ve);
+                }
+
+                q = param_end;
+            }
+        }
+
+        p = ext_end + 1;
+    }
+}
+
+std::string WebSocketHandshake::compressionOffer(const WebSocketCompressionOptions& co) {
+    std::string offer = "permessage-deflate";
+
+    if (co.clientNoContextTakeover) offer += "; client_no_context_takeover";
+    if (co.serverNoContextTakeover) offer += "; server_no_context_takeover";
+
+    // Always advertise client_max_window_bits so the server may limit our window
+    // zlib cannot emit raw streams with an 8-bit window, so 9 is our floor
+    int client_bits = std::max(9, std::min(co.clientMaxWindowBits, 15));
+    if (client_bits < 15) {
+        offer += "; client_max_window_bits=" + std::to_string(client_bits);
+    } else {
+        offer += "; client_max_window_bits";
+    }
+
+    int server_bits = std::max(8, std::min(co.serverMaxWindowBits, 15));
+    if (server_bits < 15) {
+        offer += "; server_max_window_bits=" + std::to_string(server_bits);
+    }
+    return offer;
+}
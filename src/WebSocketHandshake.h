@@ -0,0 +1,89 @@
+/*
+ *  WebSocketHandshake.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+#include <cstddef>
+#include <string>
+
+#include <event2/buffer.h>
+
+#include "WebSocketHeaders.h"
+#include "WebSocketCompressionOptions.h"
+
+/**
+ * \brief permessage-deflate parameters accepted by the server.
+ */
+struct WebSocketDeflateResponse {
+    bool present = false;
+    bool client_no_context_takeover = false;
+    bool server_no_context_takeover = false;
+    int client_max_window_bits = 15;
+    int server_max_window_bits = 15;
+};
+
+/**
+ * \brief Fields of an HTTP upgrade response, parsed in place.
+ *
+ * accept points into the parsed buffer and is only valid while it is.
+ */
+struct WebSocketHandshakeResponse {
+    int status = 0;
+    bool upgrade_websocket = false;    ///< Upgrade: websocket
+    bool connection_upgrade = false;   ///< Connection: ... upgrade ...
+    const char* accept = nullptr;      ///< Sec-WebSocket-Accept value
+    size_t accept_len = 0;
+    WebSocketDeflateResponse deflate;
+};
+
+/**
+ * \brief Client handshake: a request rendered once per configuration and
+ * a single-pass, non-allocating parser for the server's response.
+ *
+ * The request is built up front with a placeholder for the per-connection
+ * Sec-WebSocket-Key, so sending it is one copy plus a 24-byte patch.
+ */
+class WebSocketHandshake {
+public:
+    static const size_t KEY_LENGTH = 24;              ///< base64 of the 16-byte nonce
+    static const size_t MAX_RESPONSE_SIZE = 16 * 1024; ///< Larger response headers fail the upgrade
+
+    WebSocketHandshake(const std::string& host, unsigned short port, const std::string& uri,
+                       const WebSocketHeaders& headers, bool compression,
+                       const WebSocketCompressionOptions& compression_options);
+
+    /**
+     * \brief Append the request with key filled in.
+     * \return false if key has the wrong length or the buffer is out of memory.
+     */
+    bool write(evbuffer* out, const std::string& key) const;
+
+    const std::string& request() const { return text; }
+
+    /**
+     * \brief Parse the status line and headers of an upgrade response.
+     *
+     * \param data Response up to and including the terminating empty line.
+     * \param len  Length of data.
+     * \return false if the status line or a header line is malformed.
+     */
+    static bool parseResponse(const char* data, size_t len, WebSocketHandshakeResponse& out);
+
+    /**
+     * \brief Parse a Sec-WebSocket-Extensions value for permessage-deflate.
+     *
+     * Window bits outside 8..15 or not a number fall back to 15.
+     */
+    static void parseDeflate(const char* value, size_t len, WebSocketDeflateResponse& out);
+
+    /**
+     * \brief permessage-deflate offer for the request, see WebSocketCompressionOptions.
+     */
+    static std::string compressionOffer(const WebSocketCompressionOptions& co);
+
+private:
+    std::string text;
+    size_t key_offset = 0;
+};
@@ -0,0 +1,80 @@
+/*
+ *  WebSocketHistogram.cpp
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "WebSocketHistogram.h"
+
+#include <algorithm>
+
+const unsigned WebSocketHistogram::SUB_BITS;
+const uint64_t WebSocketHistogram::SUB_COUNT;
+const unsigned WebSocketHistogram::MAX_EXP;
+const size_t WebSocketHistogram::BUCKETS;
+
+WebSocketHistogram::WebSocketHistogram() {
+    for (auto& b : buckets) b.store(0, std::memory_order_relaxed);
+}
+
+size_t WebSocketHistogram::indexOf(uint64_t v) {
+    if (v < SUB_COUNT) return static_cast<size_t>(v);
+
+    unsigned e = 63u - static_cast<unsigned>(__builtin_clzll(v));
+    if (e > MAX_EXP) {
+        v = (uint64_t(1) << (MAX_EXP + 1)) - 1;
+        e = MAX_EXP;
+    }
+    // Top SUB_BITS bits below the leading one pick the sub-bucket
+    const uint64_t sub = (v >> (e - SUB_BITS)) & (SUB_COUNT - 1);
+    return static_cast<size_t>((e - SUB_BITS + 1) * SUB_COUNT + sub);
+}
+
+uint64_t WebSocketHistogram::highestEquivalent(size_t index) {
+    if (index < SUB_COUNT) return index;
+
+    const unsigned e = static_cast<unsigned>(index / SUB_COUNT) + SUB_BITS - 1;
+    const uint64_t sub = index % SUB_COUNT;
+    const unsigned shift = e - SUB_BITS;
+    return ((SUB_COUNT + sub) << shift) + (uint64_t(1) << shift) - 1;
+}
+
+void WebSocketHistogram::record(uint64_t value) {
+    auto bump = [](std::atomic<uint64_t>& c, uint64_t n) {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    };
+
+    bump(buckets[indexOf(value)], 1);
+    bump(sum, value);
+    if (value < min.load(std::memory_order_relaxed)) min.store(value, std::memory_order_relaxed);
+    if (value > max.load(std::memory_order_relaxed)) max.store(value, std::memory_order_relaxed);
+    // Last, so a reader that sees the count also sees its bucket
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void WebSocketHistogram::snapshot(WebSocketLatencyStats& out) const {
+    out = WebSocketLatencyStats();
+
+    const uint64_t n = count.load(std::memory_order_acquire);
+    if (n == 0) return;
+
+    out.count = n;
+    out.minUs = min.load(std::memory_order_relaxed);
+    out.maxUs = max.load(std::memory_order_relaxed);
+    out.meanUs = static_cast<double>(sum.load(std::memory_order_relaxed)) / static_cast<double>(n);
+
+    struct Target { double q; uint64_t* dst; };
+    const Target targets[] = { { 0.50, &out.p50Us }, { 0.90, &out.p90Us }, { 0.99, &out.p99Us }, { 0.999, &out.p999Us } };
+
+    // Buckets may run slightly ahead of n; each target clamps to the observed range
+    uint64_t seen = 0;
+    size_t t = 0;
+    for (size_t i = 0; i < BUCKETS && t < 4; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        while (t < 4 && static_cast<double>(seen) >= targets[t].q * static_cast<double>(n)) {
+            *targets[t].dst = std::min(std::max(highestEquivalent(i), out.minUs), out.maxUs);
+            ++t;
+        }
+    }
+    for (; t < 4; ++t) *targets[t].dst = out.maxUs;
+}
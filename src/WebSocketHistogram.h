@@ -0,0 +1,48 @@
+/*
+ *  WebSocketHistogram.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "WebSocketStats.h"
+
+/**
+ * \brief Log-linear latency histogram in the style of HdrHistogram.
+ *
+ * Values below 16 get a bucket each; above that every power of two is
+ * split into 16 buckets, bounding the relative error at 1/16. Values
+ * saturate at 2^37 - 1 (about 38 hours in microseconds).
+ *
+ * record() has a single writer (the event thread) and uses relaxed
+ * load/store pairs; snapshot() can run on any thread.
+ */
+class WebSocketHistogram {
+public:
+    WebSocketHistogram();
+
+    WebSocketHistogram(const WebSocketHistogram&) = delete;
+    WebSocketHistogram& operator=(const WebSocketHistogram&) = delete;
+
+    void record(uint64_t value);
+    void snapshot(WebSocketLatencyStats& out) const;
+
+private:
+    static const unsigned SUB_BITS = 4;
+    static const uint64_t SUB_COUNT = 1u << SUB_BITS;
+    static const unsigned MAX_EXP = 36;
+    static const size_t BUCKETS = (MAX_EXP - SUB_BITS + 2) * SUB_COUNT;
+
+    static size_t indexOf(uint64_t value);
+    static uint64_t highestEquivalent(size_t index);
+
+    std::atomic<uint64_t> buckets[BUCKETS];
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> min{UINT64_MAX};
+    std::atomic<uint64_t> max{0};
+};
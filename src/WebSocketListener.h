@@ -0,0 +1,79 @@
+/*
+ *  WebSocketListener.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+#include <cstddef>
+#include <string>
+
+/**
+ * \struct WebSocketListenerTable
+ * \brief Plain function-pointer dispatch for a listener object
+ *
+ * \details Built by WebSocketClient::setListener() from a WebSocketListener
+ * subclass; each entry is a thunk that calls the object's handler directly.
+ * An empty table (self == nullptr) means no listener.
+ */
+struct WebSocketListenerTable {
+    void* self = nullptr;
+    void (*onOpen)(void* self) = nullptr;
+    void (*onMessage)(void* self, const char* data, size_t len) = nullptr;
+    void (*onBinary)(void* self, const void* data, size_t len) = nullptr;
+    void (*onClose)(void* self, int code, const std::string& reason) = nullptr;
+    void (*onError)(void* self, int error_code, const std::string& error_message) = nullptr;
+    void (*onWritable)(void* self) = nullptr;
+};
+
+/**
+ * \class WebSocketListener
+ * \brief Compile-time alternative to the std::function callbacks
+ *
+ * \details Derive with CRTP and hide the handlers you need; the others
+ * default to no-ops. Handlers are resolved statically, so the only
+ * indirection per event is the thunk's function pointer and there is no
+ * type-erased callable to copy or allocate:
+ *
+ * \code
+ * struct Feed : WebSocketListener<Feed> {
+ *     void onMessage(const char* data, size_t len) { parse(data, len); }
+ *     void onClose(int code, const std::string& reason) { ... }
+ * };
+ * Feed feed;
+ * client.setListener(feed);
+ * \endcode
+ *
+ * Handlers run on the event thread. onMessage() gets the text in place,
+ * like the message view callback; both pointers are only valid until the
+ * handler returns. The listener must outlive the connection.
+ */
+template <typename Derived>
+class WebSocketListener {
+public:
+    void onOpen() {}
+    void onMessage(const char* /*data*/, size_t /*len*/) {}
+    void onBinary(const void* /*data*/, size_t /*len*/) {}
+    void onClose(int /*code*/, const std::string& /*reason*/) {}
+    void onError(int /*error_code*/, const std::string& /*error_message*/) {}
+    void onWritable() {}
+
+    /**
+     * \brief Dispatch table calling listener's handlers.
+     */
+    static WebSocketListenerTable table(Derived& listener) {
+        WebSocketListenerTable t;
+        t.self = &listener;
+        t.onOpen = [](void* s) { static_cast<Derived*>(s)->onOpen(); };
+        t.onMessage = [](void* s, const char* d, size_t n) { static_cast<Derived*>(s)->onMessage(d, n); };
+        t.onBinary = [](void* s, const void* d, size_t n) { static_cast<Derived*>(s)->onBinary(d, n); };
+        t.onClose = [](void* s, int c, const std::string& r) { static_cast<Derived*>(s)->onClose(c, r); };
+        t.onError = [](void* s, int c, const std::string& m) { static_cast<Derived*>(s)->onError(c, m); };
+        t.onWritable = [](void* s) { static_cast<Derived*>(s)->onWritable(); };
+        return t;
+    }
+
+protected:
+    WebSocketListener() = default;
+    ~WebSocketListener() = default;
+};
@@ -0,0 +1,265 @@
+/*
+ *  WebSocketLog.cpp
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "WebSocketLog.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <syslog.h>
+#include <thread>
+#include <unistd.h>
+#include <ctime>
+
+#include "Logger.h"
+#include "MpscQueue.h"
+
+namespace {
+
+const unsigned DEFAULT_RATE_LIMIT = 20;
+
+// A queued message; the text is copied in, truncated like the formatter does
+struct Entry {
+    WebSocketLog::Level level = WebSocketLog::Level::Error;
+    unsigned suppressed = 0;
+    std::chrono::system_clock::time_point time;
+    size_t length = 0;
+    char text[LOG_MESSAGE_MAX];
+};
+
+struct LogState {
+    std::atomic<int> level{LIBWSC_LOG_LEVEL};
+    std::atomic<unsigned> rate_limit{DEFAULT_RATE_LIMIT};
+    std::atomic<uint64_t> dropped{0};
+
+    std::mutex sink_mutex;
+    WebSocketLog::Sink sink;                   // empty: console/syslog
+
+    // Set while async; the ring is kept once created so a writer that
+    // loaded the pointer just before async was switched off stays safe
+    std::atomic<MpscQueue<Entry>*> active{nullptr};
+    MpscQueue<Entry>* ring = nullptr;
+    std::mutex drain_mutex;                    // held by whichever thread pops
+
+    std::mutex thread_mutex;
+    std::condition_variable wake;
+    std::thread worker;
+    bool stop = false;
+    bool exit_hook = false;
+};
+
+LogState& state() {
+    static LogState* s = new LogState;   // leaked: usable from other static destructors
+    return *s;
+}
+
+bool useSyslog() {
+    static const bool use = [] {
+        const bool s = !isatty(STDOUT_FILENO);
+        if (s) openlog(nullptr, LOG_PID, LOG_DAEMON);
+        return s;
+    }();
+    return use;
+}
+
+// "YYYY-MM-DD HH:MM:SS.mmm"
+void formatTime(std::chrono::system_clock::time_point t, char* buf, size_t len) {
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(t.time_since_epoch()).count();
+    const time_t secs = static_cast<time_t>(us / 1000000);
+    struct tm tm_info;
+    localtime_r(&secs, &tm_info);
+    strftime(buf, len, "%Y-%m-%d %H:%M:%S", &tm_info);
+    const size_t sl = strlen(buf);
+    snprintf(buf + sl, len - sl, ".%03d", static_cast<int>((us / 1000) % 1000));
+}
+
+void defaultSink(const WebSocketLog::Record& r) {
+    const bool debug = (r.level == WebSocketLog::Level::Debug);
+    const int len = static_cast<int>(r.length);
+
+    char note[64] = "";
+    if (r.suppressed) snprintf(note, sizeof(note), " (%u similar messages suppressed)", r.suppressed);
+
+    if (useSyslog()) {
+        syslog(debug ? LOG_DEBUG : LOG_ERR, "%.*s%s", len, r.message, note);
+        return;
+    }
+
+    char ts[32];
+    formatTime(r.time, ts, sizeof(ts));
+    FILE* out = debug ? stdout : stderr;
+    fprintf(out, "[%s %s] %.*s%s\n", debug ? "DEBUG" : "ERROR", ts, len, r.message, note);
+    fflush(out);
+}
+
+void deliver(LogState& st, const WebSocketLog::Record& r) {
+    std::lock_guard<std::mutex> lk(st.sink_mutex);
+    if (st.sink) {
+        st.sink(r);
+    } else {
+        defaultSink(r);
+    }
+}
+
+void drain(LogState& st, MpscQueue<Entry>& ring) {
+    std::lock_guard<std::mutex> lk(st.drain_mutex);
+    Entry e;
+    while (ring.pop(e)) {
+        WebSocketLog::Record r;
+        r.level = e.level;
+        r.time = e.time;
+        r.message = e.text;
+        r.length = e.length;
+        r.suppressed = e.suppressed;
+        deliver(st, r);
+    }
+}
+
+void run(LogState& st, MpscQueue<Entry>& ring) {
+    std::unique_lock<std::mutex> lk(st.thread_mutex);
+    while (!st.stop) {
+        lk.unlock();
+        drain(st, ring);
+        lk.lock();
+        // Writers only signal an empty ring, so also poll for a missed wakeup
+        if (!st.stop) st.wake.wait_for(lk, std::chrono::milliseconds(50));
+    }
+}
+
+// Rate limit window; +1 keeps 0 free to mean "no window yet"
+uint64_t coarseSeconds() {
+#ifdef CLOCK_MONOTONIC_COARSE
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC_COARSE, &ts) == 0) return static_cast<uint64_t>(ts.tv_sec) + 1;
+#endif
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count()) + 1;
+}
+
+void flushAtExit() {
+    WebSocketLog::flush();
+}
+
+} // namespace
+
+void WebSocketLog::setSink(Sink sink) {
+    LogState& st = state();
+    std::lock_guard<std::mutex> lk(st.sink_mutex);
+    st.sink = std::move(sink);
+}
+
+void WebSocketLog::setLevel(Level level) {
+    const int lv = std::min(static_cast<int>(level), static_cast<int>(LIBWSC_LOG_LEVEL));
+    state().level.store(lv, std::memory_order_relaxed);
+}
+
+WebSocketLog::Level WebSocketLog::level() {
+    return static_cast<Level>(state().level.load(std::memory_order_relaxed));
+}
+
+WebSocketLog::Level WebSocketLog::compiledLevel() {
+    return static_cast<Level>(LIBWSC_LOG_LEVEL);
+}
+
+void WebSocketLog::setAsync(bool enable, size_t capacity) {
+    LogState& st = state();
+    std::unique_lock<std::mutex> lk(st.thread_mutex);
+
+    if (enable) {
+        if (st.worker.joinable()) return;
+        if (!st.ring) st.ring = new MpscQueue<Entry>(std::max<size_t>(capacity, 2));
+        st.stop = false;
+        st.worker = std::thread(run, std::ref(st), std::ref(*st.ring));
+        st.active.store(st.ring, std::memory_order_release);
+        if (!st.exit_hook) {
+            st.exit_hook = true;
+            std::atexit(flushAtExit);
+        }
+        return;
+    }
+
+    if (!st.worker.joinable()) return;
+    st.active.store(nullptr, std::memory_order_release);
+    st.stop = true;
+    st.wake.notify_one();
+    std::thread worker = std::move(st.worker);
+    lk.unlock();
+    worker.join();
+    drain(st, *st.ring);
+}
+
+void WebSocketLog::setRateLimit(unsigned per_second) {
+    state().rate_limit.store(per_second, std::memory_order_relaxed);
+}
+
+void WebSocketLog::flush() {
+    LogState& st = state();
+    MpscQueue<Entry>* ring = st.active.load(std::memory_order_acquire);
+    if (ring) drain(st, *ring);
+}
+
+uint64_t WebSocketLog::dropped() {
+    return state().dropped.load(std::memory_order_relaxed);
+}
+
+bool WebSocketLog::admit(Level level, Site& site, unsigned& suppressed) {
+    LogState& st = state();
+    if (static_cast<int>(level) > st.level.load(std::memory_order_relaxed)) return false;
+
+    const unsigned limit = st.rate_limit.load(std::memory_order_relaxed);
+    if (limit) {
+        const uint64_t now = coarseSeconds();
+        uint64_t window = site.window.load(std::memory_order_relaxed);
+        if (window != now && site.window.compare_exchange_strong(window, now, std::memory_order_relaxed)) {
+            site.count.store(0, std::memory_order_relaxed);
+        }
+        // Once over the limit the count stays put; only the skips are counted
+        if (site.count.load(std::memory_order_relaxed) >= limit ||
+            site.count.fetch_add(1, std::memory_order_relaxed) >= limit) {
+            // Approximate under contention, like the counters; no locked add on this path
+            site.suppressed.store(site.suppressed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    suppressed = site.suppressed.load(std::memory_order_relaxed)
+        ? site.suppressed.exchange(0, std::memory_order_relaxed) : 0;
+    return true;
+}
+
+void WebSocketLog::write(Level level, unsigned suppressed, const char* message, size_t length) {
+    LogState& st = state();
+    const auto now = std::chrono::system_clock::now();
+
+    MpscQueue<Entry>* ring = st.active.load(std::memory_order_acquire);
+    if (!ring) {
+        Record r;
+        r.level = level;
+        r.time = now;
+        r.message = message;
+        r.length = length;
+        r.suppressed = suppressed;
+        deliver(st, r);
+        return;
+    }
+
+    Entry e;
+    e.level = level;
+    e.suppressed = suppressed;
+    e.time = now;
+    e.length = std::min(length, sizeof(e.text));
+    std::memcpy(e.text, message, e.length);
+
+    if (!ring->push(std::move(e))) {
+        st.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // One wakeup per burst: the worker drains everything once it runs
+    if (ring->sizeApprox() == 1) st.wake.notify_one();
+}
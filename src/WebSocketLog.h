@@ -0,0 +1,101 @@
+/*
+ *  WebSocketLog.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/**
+ * \brief Where library log messages go, and how fast.
+ *
+ * By default messages are written synchronously to stdout/stderr, or to
+ * syslog when stdout is not a terminal. A sink routes them into the
+ * application's own logging instead; it gets the formatted text once,
+ * with no timestamp or prefix added.
+ *
+ * setAsync() moves the sink call onto a background thread behind a
+ * lock-free ring, so a thread that logs never blocks on I/O; when the
+ * ring is full the message is counted in dropped() and discarded.
+ *
+ * Each log statement is rate limited on its own: past setRateLimit()
+ * messages in one second it is skipped before anything is formatted, and
+ * the number skipped is reported with its next message.
+ *
+ * Levels above LIBWSC_LOG_LEVEL are compiled out of the library and cost
+ * nothing; setLevel() filters further at run time.
+ */
+class WebSocketLog {
+public:
+    // Not ERROR/DEBUG: applications commonly define those as macros
+    enum class Level {
+        Off,    ///< Nothing is logged
+        Error,  ///< Failures and dropped data
+        Debug   ///< Verbose tracing; needs a LIBWSC_LOG_LEVEL=debug build
+    };
+
+    struct Record {
+        Level level;
+        std::chrono::system_clock::time_point time;   ///< When it was logged, not delivered
+        const char* message;                          ///< Not NUL-terminated past length
+        size_t length;
+        unsigned suppressed;   ///< Messages from the same statement dropped by the rate limit since the last one
+    };
+
+    /// Called on the logging thread, or on the async thread when enabled; must not log itself
+    using Sink = std::function<void(const Record& record)>;
+
+    /**
+     * \brief Replace the sink; an empty function restores the console/syslog default.
+     */
+    static void setSink(Sink sink);
+
+    /**
+     * \brief Run-time threshold; levels compiled out stay out.
+     */
+    static void setLevel(Level level);
+    static Level level();
+
+    /// Highest level compiled into the library (LIBWSC_LOG_LEVEL)
+    static Level compiledLevel();
+
+    /**
+     * \brief Deliver messages from a background thread.
+     * \param capacity Messages the ring holds before dropping; used when first enabled.
+     */
+    static void setAsync(bool enable, size_t capacity = 1024);
+
+    /**
+     * \brief Messages per second each log statement may emit; 0 disables the limit.
+     */
+    static void setRateLimit(unsigned per_second);
+
+    /**
+     * \brief Deliver everything queued so far before returning.
+     */
+    static void flush();
+
+    /// Messages lost because the async ring was full
+    static uint64_t dropped();
+
+    /// Per-statement rate limit state; one static instance per log call site
+    struct Site {
+        std::atomic<uint64_t> window{0};   // second the count belongs to
+        std::atomic<unsigned> count{0};
+        std::atomic<unsigned> suppressed{0};
+    };
+
+    /**
+     * \brief Whether a message from site at level should be formatted now.
+     * \param suppressed Set to the count to report with it.
+     */
+    static bool admit(Level level, Site& site, unsigned& suppressed);
+
+    /// Hand a formatted message to the sink or the async ring
+    static void write(Level level, unsigned suppressed, const char* message, size_t length);
+};
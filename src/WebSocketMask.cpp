@@ -0,0 +1,136 @@
+/*
+ *  WebSocketMask.cpp
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "WebSocketMask.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define LIBWSC_MASK_SSE2 1
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #include <immintrin.h>
+    #define LIBWSC_MASK_AVX2 1
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define LIBWSC_MASK_NEON 1
+#endif
+
+using MaskFn = void (*)(uint8_t*, const uint8_t*, size_t, const uint8_t*);
+
+static inline void maskTail(uint8_t* dst, const uint8_t* src, size_t from, size_t len, const uint8_t* key) {
+    // 'from' is always a multiple of 4, so the key phase restarts at key[0]
+    for (size_t i = from; i < len; ++i) {
+        dst[i] = src[i] ^ key[i & 3];
+    }
+}
+
+void WebSocketMask::applyBytewise(uint8_t* dst, const uint8_t* src, size_t len, const uint8_t key[4]) {
+    maskTail(dst, src, 0, len, key);
+}
+
+void WebSocketMask::applyScalar(uint8_t* dst, const uint8_t* src, size_t len, const uint8_t key[4]) {
+    uint8_t k8[8] = { key[0], key[1], key[2], key[3], key[0], key[1], key[2], key[3] };
+    uint64_t k64;
+    std::memcpy(&k64, k8, sizeof(k64));
+
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t v;
+        std::memcpy(&v, src + i, sizeof(v));
+        v ^= k64;
+        std::memcpy(dst + i, &v, sizeof(v));
+    }
+    maskTail(dst, src, i, len, key);
+}
+
+#ifdef LIBWSC_MASK_SSE2
+static void maskSse2(uint8_t* dst, const uint8_t* src, size_t len, const uint8_t* key) {
+    int32_t k32;
+    std::memcpy(&k32, key, sizeof(k32));
+    const __m128i k = _mm_set1_epi32(k32);
+
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(v, k));
+    }
+    maskTail(dst, src, i, len, key);
+}
+#endif
+
+#ifdef LIBWSC_MASK_AVX2
+__attribute__((target("avx2")))
+static void maskAvx2(uint8_t* dst, const uint8_t* src, size_t len, const uint8_t* key) {
+    int32_t k32;
+    std::memcpy(&k32, key, sizeof(k32));
+    const __m256i k = _mm256_set1_epi32(k32);
+
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(v, k));
+    }
+    maskTail(dst, src, i, len, key);
+}
+#endif
+
+#ifdef LIBWSC_MASK_NEON
+static void maskNeon(uint8_t* dst, const uint8_t* src, size_t len, const uint8_t* key) {
+    uint32_t k32;
+    std::memcpy(&k32, key, sizeof(k32));
+    const uint8x16_t k = vreinterpretq_u8_u32(vdupq_n_u32(k32));
+
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        vst1q_u8(dst + i, veorq_u8(vld1q_u8(src + i), k));
+    }
+    maskTail(dst, src, i, len, key);
+}
+#endif
+
+struct MaskKernel {
+    MaskFn fn;
+    const char* name;
+};
+
+static MaskKernel selectKernel() {
+#ifdef LIBWSC_MASK_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return { &maskAvx2, "avx2" };
+    }
+#endif
+#if defined(LIBWSC_MASK_SSE2)
+    return { &maskSse2, "sse2" };
+#elif defined(LIBWSC_MASK_NEON)
+    return { &maskNeon, "neon" };
+#else
+    return { &WebSocketMask::applyScalar, "scalar" };
+#endif
+}
+
+static const MaskKernel& kernel() {
+    static const MaskKernel k = selectKernel();
+    return k;
+}
+
+void WebSocketMask::apply(uint8_t* dst, const uint8_t* src, size_t len, const uint8_t key[4]) {
+    // Frames this small are not worth an indirect call
+    if (len < 16) {
+        maskTail(dst, src, 0, len, key);
+        return;
+    }
+    kernel().fn(dst, src, len, key);
+}
+
+const char* WebSocketMask::implementation() {
+    return kernel().name;
+}
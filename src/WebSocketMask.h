@@ -0,0 +1,40 @@
+/*
+ *  WebSocketMask.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * \brief Client-to-server payload masking (RFC 6455, section 5.3).
+ *
+ * apply() picks the widest kernel the CPU supports on first use:
+ * AVX2 (32 bytes per step, runtime-detected), SSE2 or NEON (16 bytes),
+ * or a portable 8-byte word loop. Tails are masked byte by byte.
+ */
+struct WebSocketMask {
+    /**
+     * \brief XOR len bytes of src with the repeating 4-byte key into dst.
+     *
+     * The key is applied from offset 0. dst and src may be the same buffer.
+     */
+    static void apply(uint8_t* dst, const uint8_t* src, size_t len, const uint8_t key[4]);
+
+    /**
+     * \brief Portable kernel (8 bytes per step), used when no SIMD is available.
+     */
+    static void applyScalar(uint8_t* dst, const uint8_t* src, size_t len, const uint8_t key[4]);
+
+    /**
+     * \brief Reference one-byte-per-step loop.
+     */
+    static void applyBytewise(uint8_t* dst, const uint8_t* src, size_t len, const uint8_t key[4]);
+
+    /**
+     * \brief Name of the kernel selected by apply() ("avx2", "sse2", "neon" or "scalar").
+     */
+    static const char* implementation();
+};
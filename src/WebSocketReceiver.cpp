@@ -12,27 +12,81 @@
 
 #include "Logger.h"
 
-WebSocketReceiver::WebSocketReceiver(IWebSocketSinks& sinks) : _sinks(sinks) {}
+WebSocketReceiver::WebSocketReceiver(IWebSocketSinks& sinks)
+    : _sinks(sinks), pool(WebSocketBufferPool::create()) {}
 
 WebSocketReceiver::~WebSocketReceiver() {
     shutdownCompression();
+    rxDropFragments();
+    log_debug("Receive buffers allocated: %llu", static_cast<unsigned long long>(pool->allocations()));
+}
+
+void WebSocketReceiver::rxDropFragments() {
+    pool->recycle(fragmented_message);
+    fragmented_message = nullptr;
 }
 
 void WebSocketReceiver::shutdownCompression() {
     if (inflate_initialized) {
-        inflateEnd(&inflate_stream);
+        if (rx_pooled) {
+            ZStreamPool::instance().releaseInflate(_cfg.server_max_window_bits, rx_zs);
+        } else {
+            inflateEnd(&inflate_stream);
+        }
+        rx_zs = nullptr;
         inflate_initialized = false;
     }
     if (deflate_initialized) {
-        deflateEnd(&deflate_stream);
+        log_debug("Deflate output buffer grew %llu times", static_cast<unsigned long long>(tx_grow_count));
+        if (tx_pooled) {
+            ZStreamPool::instance().releaseDeflate(txPoolParams(), tx_zs);
+        } else if (tx_zs) {
+            deflateEnd(&deflate_stream);
+        }
+        tx_zs = nullptr;
         deflate_initialized = false;
     }
+    rx_pooled = tx_pooled = false;
+    codec.reset();
+    codec_tx = codec_rx = false;
     tx_compressed_buf.clear();
     tx_payload_len = 0;
     _cfg = PerMessageDeflateConfig{};
 }
 
+bool WebSocketReceiver::sameStreams(const PerMessageDeflateConfig& a, const PerMessageDeflateConfig& b) {
+    return a.client_no_context_takeover == b.client_no_context_takeover &&
+           a.server_no_context_takeover == b.server_no_context_takeover &&
+           a.client_max_window_bits == b.client_max_window_bits &&
+           a.server_max_window_bits == b.server_max_window_bits &&
+           a.compression_level == b.compression_level &&
+           a.mem_level == b.mem_level &&
+           a.strategy == b.strategy &&
+           a.shared_streams == b.shared_streams;
+}
+
+void WebSocketReceiver::reset() {
+    rxDropFragments();
+    message_in_progress = false;
+    compressed_message_in_progress = false;
+    streaming_message_in_progress = false;
+    fragmented_opcode = 0;
+    rx_frame_need = 0;
+    utf8Validator.reset();
+}
+
 bool WebSocketReceiver::initializeCompression(const PerMessageDeflateConfig& cfg) {
+    if (cfg.enabled && _cfg.enabled && sameStreams(_cfg, cfg) && inflate_initialized && deflate_initialized) {
+        // Reconnect: the windows belong to the old connection, the allocations don't
+        _cfg = cfg;
+        rxResetInflate();
+        txResetDeflate();
+        tx_ratio_avg = -1.0;
+        tx_skip_remaining = 0;
+        log_debug("Compression streams reused");
+        return true;
+    }
+
     shutdownCompression();
     _cfg = cfg;
 
@@ -40,153 +94,202 @@ bool WebSocketReceiver::initializeCompression(const PerMessageDeflateConfig& cfg
         return true;
     }
 
+    // A direction without context takeover needs no state between messages
+    rx_pooled = _cfg.shared_streams && _cfg.server_no_context_takeover;
+    tx_pooled = _cfg.shared_streams && _cfg.client_no_context_takeover;
+
+    if (DeflateCodec::compiledBackend() != DeflateCodec::Backend::ZLIB &&
+        (_cfg.client_no_context_takeover || _cfg.server_no_context_takeover)) {
+        DeflateCodecParams cp;
+        cp.level = _cfg.compression_level;
+        cp.tx_window_bits = _cfg.client_max_window_bits;
+        cp.rx_window_bits = _cfg.server_max_window_bits;
+        cp.mem_level = _cfg.mem_level;
+        cp.strategy = _cfg.strategy;
+        codec = DeflateCodec::create(DeflateCodec::compiledBackend(), cp);
+    }
+    if (codec) {
+        // libdeflate always compresses with a 32 KB window
+        codec_tx = _cfg.client_no_context_takeover &&
+                   (codec->backend() != DeflateCodec::Backend::LIBDEFLATE || _cfg.client_max_window_bits == 15);
+        codec_rx = _cfg.server_no_context_takeover;
+        log_debug("Using %s for%s%s", DeflateCodec::backendName(codec->backend()),
+                  codec_tx ? " tx" : "", codec_rx ? " rx" : "");
+    }
+
     if (!rxInitInflate()) {
         shutdownCompression();
         return false;
     }
 
     if (!txInitDeflate()) {
-        if (inflate_initialized) {
-            inflateEnd(&inflate_stream);
-            inflate_initialized = false;
-        }
         shutdownCompression();
         return false;
     }
 
-    log_debug("Compression initialized successfully");
-
-    /*log_debug("Compression initialized successfully (rx bits=%d, tx bits=%d)",
-              _cfg.server_max_window_bits, _cfg.client_max_window_bits);*/
+    log_debug("Compression initialized successfully (rx bits=%d%s, tx bits=%d%s)",
+              _cfg.server_max_window_bits, rx_pooled ? " pooled" : "",
+              _cfg.client_max_window_bits, tx_pooled ? " pooled" : "");
     return true;
 }
 
+ZStreamPool::DeflateParams WebSocketReceiver::txPoolParams() const {
+    ZStreamPool::DeflateParams p;
+    p.level = _cfg.compression_level;
+    p.window_bits = _cfg.client_max_window_bits;
+    p.mem_level = _cfg.mem_level;
+    p.strategy = _cfg.strategy;
+    return p;
+}
+
 bool WebSocketReceiver::rxInitInflate() {
+    if (rx_pooled) {
+        // Borrow once up front so bad parameters fail the negotiation, not the first message
+        rx_zs = ZStreamPool::instance().acquireInflate(_cfg.server_max_window_bits);
+        if (!rx_zs) return false;
+        inflate_initialized = true;
+        return true;
+    }
+
     std::memset(&inflate_stream, 0, sizeof(inflate_stream));
     int ret = inflateInit2(&inflate_stream, -_cfg.server_max_window_bits);
     if (ret != Z_OK) {
         log_error("Failed to initialize inflate: %d", ret);
         return false;
     }
+    rx_zs = &inflate_stream;
     inflate_initialized = true;
     return true;
 }
 
 bool WebSocketReceiver::txInitDeflate() {
+    if (codec_tx) {
+        // The codec owns compression; no zlib stream needed
+        deflate_initialized = true;
+        return true;
+    }
+
+    if (tx_pooled) {
+        tx_zs = ZStreamPool::instance().acquireDeflate(txPoolParams());
+        if (!tx_zs) return false;
+        deflate_initialized = true;
+        return true;
+    }
+
     std::memset(&deflate_stream, 0, sizeof(deflate_stream));
     int ret = deflateInit2(&deflate_stream,
                            _cfg.compression_level,
                            Z_DEFLATED,
                            -_cfg.client_max_window_bits,
-                           8,
-                           Z_DEFAULT_STRATEGY);
+                           _cfg.mem_level,
+                           _cfg.strategy);
     if (ret != Z_OK) {
         log_error("Failed to initialize deflate: %d", ret);
         return false;
     }
+    tx_zs = &deflate_stream;
     deflate_initialized = true;
     return true;
 }
 
+z_stream* WebSocketReceiver::rxStream() {
+    if (!rx_zs && rx_pooled) rx_zs = ZStreamPool::instance().acquireInflate(_cfg.server_max_window_bits);
+    return rx_zs;
+}
+
+z_stream* WebSocketReceiver::txStream() {
+    if (!tx_zs && tx_pooled) tx_zs = ZStreamPool::instance().acquireDeflate(txPoolParams());
+    return tx_zs;
+}
+
 void WebSocketReceiver::rxResetInflate() {
-    if (!inflate_initialized) return;
-    inflateEnd(&inflate_stream);
-    inflate_initialized = false;
-    rxInitInflate();
+    if (!inflate_initialized || !rx_zs) return;
+    if (rx_pooled) {
+        // Hand the stream back between messages; the pool resets it
+        ZStreamPool::instance().releaseInflate(_cfg.server_max_window_bits, rx_zs);
+        rx_zs = nullptr;
+        return;
+    }
+    inflateReset(rx_zs);
 }
 
 void WebSocketReceiver::txResetDeflate() {
-    if (!deflate_initialized) return;
-    deflateReset(&deflate_stream);
+    if (!deflate_initialized || !tx_zs) return;
+    if (tx_pooled) {
+        ZStreamPool::instance().releaseDeflate(txPoolParams(), tx_zs);
+        tx_zs = nullptr;
+        return;
+    }
+    deflateReset(tx_zs);
 }
 
 bool WebSocketReceiver::txDeflate(const uint8_t* in, size_t in_len) {
     if (!deflate_initialized) return false;
 
-    // Attempt compression with progressively larger output buffers.
-    // This accounts for zlib SYNC_FLUSH overhead, which is not fully
-    // captured by deflateBound().
-    for (int attempt = 0; attempt < 4; ++attempt) {
-        txResetDeflate();
-
-        // Add extra slack beyond deflateBound() to safely accommodate
-        // SYNC_FLUSH trailer and internal zlib bookkeeping.
-        const size_t extra = 64u * (attempt + 1);
-        const size_t bound = deflateBound(&deflate_stream, static_cast<uLong>(in_len)) + extra;
-
-        tx_compressed_buf.resize(bound);
-
-        // zlib input/output buffers
-        deflate_stream.next_in   = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(in));
-        deflate_stream.avail_in  = static_cast<uInt>(in_len);
-        deflate_stream.next_out  = reinterpret_cast<Bytef*>(tx_compressed_buf.data());
-        deflate_stream.avail_out = static_cast<uInt>(bound);
-
-        // Perform a single SYNC_FLUSH compression step
-        const int ret = deflate(&deflate_stream, Z_SYNC_FLUSH);
+    if (codec_tx) {
+        if (codec->compress(in, in_len, tx_compressed_buf, tx_payload_len)) return true;
+        log_error("Compression failed (%s), sending raw", DeflateCodec::backendName(codec->backend()));
+        return false;
+    }
+    z_stream* zs = txStream();
+    if (!zs) return false;
+
+    // deflateBound() does not cover the SYNC_FLUSH marker, so leave a little
+    // slack; if that is still not enough the buffer grows and deflate carries
+    // on from where it stopped instead of recompressing the message.
+    size_t cap = deflateBound(zs, static_cast<uLong>(in_len)) + 16;
+    if (tx_compressed_buf.size() < cap) tx_compressed_buf.resize(cap);
+    cap = tx_compressed_buf.size();
+
+    zs->next_in   = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(in));
+    zs->avail_in  = static_cast<uInt>(in_len);
+    zs->next_out  = reinterpret_cast<Bytef*>(tx_compressed_buf.data());
+    zs->avail_out = static_cast<uInt>(cap);
+
+    size_t produced = 0;
+    for (;;) {
+        const int ret = deflate(zs, Z_SYNC_FLUSH);
+        produced = cap - zs->avail_out;
 
-        // We only accept a clean SYNC_FLUSH result
-        // Z_BUF_ERROR indicates insufficient output space and triggers a retry.
-        if (ret != Z_OK) {
-            // If we ran out of output space, retry larger
-            if (ret == Z_BUF_ERROR || deflate_stream.avail_out == 0) {
-                continue;
-            }
+        if (ret != Z_OK && ret != Z_BUF_ERROR) {
             log_error("Compression failed (%d), sending raw", ret);
+            txResetDeflate();
             return false;
         }
 
-        const size_t produced = bound - deflate_stream.avail_out;
-        if (produced < 4) {
-            // Cannot possibly contain the SYNC_FLUSH trailer
-            continue;
-        }
+        // SYNC_FLUSH is complete once deflate returns with output space left
+        if (zs->avail_out != 0) break;
 
-        // A valid zlib SYNC_FLUSH output must end with 00 00 FF FF.
-        // permessage-deflate requires stripping this trailer before framing.
-        const size_t n = produced;
-        if (!(tx_compressed_buf[n-4] == 0x00 &&
-              tx_compressed_buf[n-3] == 0x00 &&
-              tx_compressed_buf[n-2] == 0xFF &&
-              tx_compressed_buf[n-1] == 0xFF)) {
-            // Incomplete SYNC_FLUSH output, retry with more space
-            continue;
-        }
-
-        // Exclude SYNC_FLUSH trailer from transmitted payload
-        tx_payload_len = produced - 4;
-
-        // Reset compression context when client_no_context_takeover is negotiated
-        if (_cfg.client_no_context_takeover) {
-            if (!txReinitAfterNoContextTakeover()) return false;
-        }
-        return true;
+        cap *= 2;
+        tx_compressed_buf.resize(cap);
+        zs->next_out  = reinterpret_cast<Bytef*>(tx_compressed_buf.data() + produced);
+        zs->avail_out = static_cast<uInt>(cap - produced);
+        ++tx_grow_count;
+        if (counters) WebSocketCounters::bump(counters->deflate_grows);
     }
 
-    // Exhausted all retries without a valid SYNC_FLUSH frame
-    log_error("Compression failed: could not produce complete SYNC_FLUSH output");
-    return false;
-}
-
-bool WebSocketReceiver::txReinitAfterNoContextTakeover() {
-    if (!deflate_initialized) return false;
-
-    deflateEnd(&deflate_stream);
-    deflate_initialized = false;
-    std::memset(&deflate_stream, 0, sizeof(deflate_stream));
-    
-    int init_ret = deflateInit2(&deflate_stream,
-                                _cfg.compression_level,
-                                Z_DEFLATED,
-                                -_cfg.client_max_window_bits,
-                                8,
-                                Z_DEFAULT_STRATEGY);
-    if (init_ret != Z_OK) {
-        log_error("deflateInit2 after context takeover failed (%d)", init_ret);
+    // A valid SYNC_FLUSH output must end with 00 00 FF FF.
+    // permessage-deflate requires stripping this trailer before framing.
+    const size_t n = produced;
+    if (n < 4 || zs->avail_in != 0 ||
+        !(tx_compressed_buf[n-4] == 0x00 &&
+          tx_compressed_buf[n-3] == 0x00 &&
+          tx_compressed_buf[n-2] == 0xFF &&
+          tx_compressed_buf[n-1] == 0xFF)) {
+        log_error("Compression failed: incomplete SYNC_FLUSH output, sending raw");
+        // The window now holds data the peer will never see
+        txResetDeflate();
         return false;
     }
 
-    deflate_initialized = true;
+    // Exclude SYNC_FLUSH trailer from transmitted payload
+    tx_payload_len = produced - 4;
+
+    // Keep the window for the next message unless client_no_context_takeover
+    // was negotiated
+    if (_cfg.client_no_context_takeover) {
+        txResetDeflate();
+    }
     return true;
 }
 
@@ -199,8 +302,23 @@ bool WebSocketReceiver::txPrepare(const uint8_t* original_ptr, size_t original_l
     if (!request_compress) return true;
     if (!_cfg.enabled) return true;
     if (!deflate_initialized) return true;
+    if (original_len < _cfg.min_size) return true;
 
-    if (!txDeflate(original_ptr, original_len)) {
+    // Nothing to compress; a second SYNC_FLUSH with no input emits no trailer
+    if (original_len == 0) return true;
+
+    // Skipped messages never reach the deflater, so the peer's window stays in sync
+    if (tx_skip_remaining > 0) {
+        --tx_skip_remaining;
+        return true;
+    }
+
+    bool deflated;
+    {
+        WebSocketCounters::ScopedTimer t(counters ? &counters->deflate_ns : nullptr);
+        deflated = txDeflate(original_ptr, original_len);
+    }
+    if (!deflated) {
         // fallback to raw
         payload_ptr = original_ptr;
         payload_len = original_len;
@@ -208,104 +326,360 @@ bool WebSocketReceiver::txPrepare(const uint8_t* original_ptr, size_t original_l
         return true;
     }
 
+    if (_cfg.adaptive) txTrackRatio(original_len, tx_payload_len);
+
+    // Without context takeover the deflater forgets this message anyway,
+    // so an output that didn't shrink can be dropped in favour of the original
+    if (_cfg.client_no_context_takeover && tx_payload_len >= original_len) return true;
+
     payload_ptr = tx_compressed_buf.data();
     payload_len = tx_payload_len;
     do_compress = true;
+
+    if (counters) {
+        WebSocketCounters::bump(counters->tx_uncompressed, original_len);
+        WebSocketCounters::bump(counters->tx_compressed, tx_payload_len);
+    }
     return true;
 }
 
+void WebSocketReceiver::txTrackRatio(size_t original_len, size_t compressed_len) {
+    if (original_len == 0) return;
+
+    // Exponential moving average, 1/8 weight per message, seeded by the first one
+    const double ratio = static_cast<double>(compressed_len) / static_cast<double>(original_len);
+    if (tx_ratio_avg < 0.0) {
+        tx_ratio_avg = ratio;
+    } else {
+        tx_ratio_avg += (ratio - tx_ratio_avg) / 8.0;
+    }
+
+    if (tx_ratio_avg > _cfg.adaptive_max_ratio) {
+        tx_skip_remaining = _cfg.adaptive_probe_interval;
+        // Start the next probe from neutral so one good message can resume compression
+        tx_ratio_avg = _cfg.adaptive_max_ratio;
+        log_debug("Compression not paying off, skipping next %u messages", tx_skip_remaining);
+    }
+}
+
+// permessage-deflate payloads omit the zlib SYNC_FLUSH trailer; it is fed
+// to inflate as a second input step instead of being appended to a copy.
+static const uint8_t kSyncTrailer[4] = { 0x00, 0x00, 0xFF, 0xFF };
+
+// Inflate the segments of 'in', followed by the SYNC_FLUSH trailer when
+// 'fin' ends the message. 'window' is called each time the output space is
+// exhausted (and once up front) and must point next_out/avail_out at fresh
+// space; it returns false to abort.
+template <typename Window>
+static bool inflateMessage(z_stream& zs, const RxPayload& in, bool fin, Window&& window) {
+    zs.avail_out = 0;
+
+    for (int i = 0; i <= in.count; ++i) {
+        const bool trailer = (i == in.count);
+        if (trailer && !fin) break;
+
+        const uint8_t* p = trailer ? kSyncTrailer : in.data(i);
+        size_t left = trailer ? sizeof(kSyncTrailer) : in.size(i);
+
+        while (left > 0) {
+            const uInt step = static_cast<uInt>(std::min<size_t>(left, 1u << 30));
+            zs.next_in  = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(p));
+            zs.avail_in = step;
+
+            while (zs.avail_in > 0) {
+                if (zs.avail_out == 0 && !window()) return false;
+
+                const int ret = inflate(&zs, Z_SYNC_FLUSH);
+                if (ret == Z_STREAM_END) {
+                    // Final deflate block; anything after it is ignored
+                    return true;
+                }
+                if (ret == Z_BUF_ERROR && zs.avail_out == 0) {
+                    continue;  // output full, get more space
+                }
+                if (ret != Z_OK) {
+                    log_error("inflate failed: %d (avail_in=%u avail_out=%u)", ret, zs.avail_in, zs.avail_out);
+                    return false;
+                }
+            }
+
+            p += step;
+            left -= step;
+        }
+    }
+
+    // Input consumed; drain output zlib could not place in a full window
+    while (zs.avail_out == 0) {
+        if (!window()) return false;
+        const int ret = inflate(&zs, Z_SYNC_FLUSH);
+        if (ret == Z_BUF_ERROR || ret == Z_STREAM_END) break;  // nothing left
+        if (ret != Z_OK) {
+            log_error("inflate failed: %d", ret);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Copy the payload segments to the end of out
+static void appendPayload(std::vector<uint8_t>& out, const RxPayload& in) {
+    out.reserve(out.size() + in.len);
+    for (int i = 0; i < in.count; ++i) out.insert(out.end(), in.data(i), in.data(i) + in.size(i));
+}
+
 bool WebSocketReceiver::rxInflate(const uint8_t* in, size_t in_len, std::vector<uint8_t>& out) {
+    evbuffer_iovec seg;
+    seg.iov_base = const_cast<uint8_t*>(in);
+    seg.iov_len = in_len;
+
+    RxPayload payload;
+    payload.seg = &seg;
+    payload.count = 1;
+    payload.len = in_len;
+    return rxInflate(payload, out);
+}
+
+bool WebSocketReceiver::rxInflate(const RxPayload& in, std::vector<uint8_t>& out) {
+    const size_t in_len = in.len;
+
     if (!_cfg.enabled || !inflate_initialized) {
-        out.assign(in, in + in_len);
+        out.clear();
+        appendPayload(out, in);
         return true;
     }
 
-    // permessage-deflate payloads omit the zlib SYNC_FLUSH trailer.
-    // To inflate with Z_SYNC_FLUSH, we append 00 00 FF FF temporarily.
-    static thread_local std::vector<uint8_t> src;
-    src.clear();
-    src.reserve(in_len + 4);
+    WebSocketCounters::ScopedTimer t(counters ? &counters->inflate_ns : nullptr);
+
+    if (codec_rx) {
+        // Whole-buffer backend: a payload spread over chains is joined first
+        bool ok;
+        if (in.contiguous()) {
+            ok = codec->decompress(in.data(), in_len, out);
+        } else {
+            WebSocketBufferPool::Storage* joined = pool->acquire(in_len);
+            appendPayload(*joined, in);
+            ok = codec->decompress(joined->data(), joined->size(), out);
+            pool->recycle(joined);
+        }
+        if (ok && counters) {
+            WebSocketCounters::bump(counters->rx_compressed, in_len);
+            WebSocketCounters::bump(counters->rx_uncompressed, out.size());
+        }
+        return ok;
+    }
 
-    src.insert(src.end(), in, in + in_len);
-    src.push_back(0x00);
-    src.push_back(0x00);
-    src.push_back(0xFF);
-    src.push_back(0xFF);
+    z_stream* zs = rxStream();
+    if (!zs) return false;
 
     // The decompressor state must be reset for each message (if negotiated).
     if (_cfg.server_no_context_takeover) {
-        inflateReset(&inflate_stream);
+        inflateReset(zs);
     }
 
-    // Configure zlib input buffer (src includes the appended SYNC_FLUSH trailer)
-    inflate_stream.next_in  = reinterpret_cast<Bytef*>(src.data());
-    inflate_stream.avail_in = static_cast<uInt>(src.size());
-
+    // Inflate straight into out, doubling it whenever zlib fills it up
     out.clear();
-    // The decompressed output can be larger than input.
-    out.reserve(in_len * 4);
-    
-    uint8_t tmp[4096];
-
-    while (true) {
-        // Inflate into a fixed-size chunk and append to 'out'
-        inflate_stream.next_out  = tmp;
-        inflate_stream.avail_out = sizeof(tmp);
-
-        int ret = inflate(&inflate_stream, Z_SYNC_FLUSH);
-
-        if (ret == Z_BUF_ERROR) {
-            // Not fatal, either the output buffer filled up (retry),
-            // or we have no more input available (done).
-            if (inflate_stream.avail_out == 0) {
-                continue; // produced output, but tmp was full
-            }
-            
-            if (inflate_stream.avail_in == 0) {
-                break; // no more input
-            }
-            // Otherwise, no progress is possible
-            log_error("inflate stalled (Z_BUF_ERROR with avail_in=%u avail_out=%u)",
-                        inflate_stream.avail_in, inflate_stream.avail_out);
+    bool first = true;
+
+    const bool ok = inflateMessage(*zs, in, true, [&]() {
+        const size_t produced = first ? 0 : static_cast<size_t>(zs->next_out - out.data());
+        first = false;
+
+        const size_t grow = produced ? produced : std::max<size_t>(in_len * 2, 1024);
+        out.resize(produced + grow);
+
+        zs->next_out  = reinterpret_cast<Bytef*>(out.data() + produced);
+        zs->avail_out = static_cast<uInt>(std::min<size_t>(grow, 1u << 30));
+        return true;
+    });
+
+    out.resize(ok ? static_cast<size_t>(reinterpret_cast<uint8_t*>(zs->next_out) - out.data()) : 0);
+    if (ok && counters) {
+        WebSocketCounters::bump(counters->rx_compressed, in_len);
+        WebSocketCounters::bump(counters->rx_uncompressed, out.size());
+    }
+    return ok;
+}
+
+bool WebSocketReceiver::rxInflateChunks(const RxPayload& in, int opcode, bool first, bool fin) {
+    const bool text = (opcode == 0x01);
+    const bool binary = !text;
+
+    if (!_cfg.enabled || !inflate_initialized) {
+        _sinks.onRxProtocolError(1007, "Decompression failed");
+        return false;
+    }
+
+    z_stream* zs = rxStream();
+    if (!zs) {
+        _sinks.onRxProtocolError(1007, "Decompression failed");
+        return false;
+    }
+
+    if (first) {
+        if (_cfg.server_no_context_takeover) {
+            inflateReset(zs);
+        }
+        if (text) utf8Validator.reset();
+    }
+
+    if (rx_chunk_buf.size() != RX_CHUNK_SIZE) rx_chunk_buf.resize(RX_CHUNK_SIZE);
+    uint8_t* const window_start = rx_chunk_buf.data();
+
+    WebSocketCounters::ScopedTimer t(counters ? &counters->inflate_ns : nullptr);
+    if (counters) WebSocketCounters::bump(counters->rx_compressed, in.len);
+
+    bool bad_utf8 = false;
+
+    // Validate and hand over one window; only the tail of the last fragment is final
+    auto emit = [&](size_t n, bool final) {
+        if (text && !utf8Validator.validateChunk(window_start, n)) {
+            bad_utf8 = true;
             return false;
-        } else if (ret != Z_OK && ret != Z_STREAM_END) {
-            // Failure (Z_DATA_ERROR, Z_MEM_ERROR)
-            log_error("inflate failed: %d", ret);
+        }
+        if (final && text && !utf8Validator.validateFinal()) {
+            bad_utf8 = true;
             return false;
         }
+        if (counters) WebSocketCounters::bump(counters->rx_uncompressed, n);
+        _sinks.onRxChunk(window_start, n, binary, final);
+        return true;
+    };
+
+    bool first_window = true;
+    const bool ok = inflateMessage(*zs, in, fin, [&]() {
+        if (!first_window && !emit(RX_CHUNK_SIZE, false)) return false;
+        first_window = false;
 
-        // Append produced bytes from this iteration
-        size_t produced = sizeof(tmp) - inflate_stream.avail_out;
-        
-        if (produced) {
-            const size_t old = out.size();
-            out.resize(old + produced);
-            std::memcpy(out.data() + old, tmp, produced);
+        zs->next_out  = window_start;
+        zs->avail_out = static_cast<uInt>(RX_CHUNK_SIZE);
+        return true;
+    });
+
+    if (ok) {
+        const size_t tail = static_cast<size_t>(reinterpret_cast<uint8_t*>(zs->next_out) - window_start);
+        // A non-final fragment that produced nothing new has nothing to report
+        if ((!fin && tail == 0) || emit(tail, fin)) {
+            if (fin && text) utf8Validator.reset();
+            return true;
         }
+    }
 
-        // Z_STREAM_END would indicate the deflate stream ended.
-        // With permessage-deflate + SYNC_FLUSH, we typically stop based on input/output state.
-        if (ret == Z_STREAM_END) {
-            break;
+    utf8Validator.reset();
+    if (bad_utf8) {
+        log_error("Invalid UTF-8 in compressed text");
+        _sinks.onRxProtocolError(1007, "Invalid UTF-8 in text message");
+    } else {
+        _sinks.onRxProtocolError(1007, "Decompression failed");
+    }
+    return false;
+}
+
+bool WebSocketReceiver::rxStreamFragment(const RxPayload& payload, bool first, bool fin) {
+    const int opcode = fragmented_opcode;
+    bool ok;
+
+    if (compressed_message_in_progress) {
+        ok = rxInflateChunks(payload, opcode, first, fin);
+        if (ok && fin) rxMaybeResetAfterMessage();
+
+    } else {
+        // Uncompressed fragments go out straight from the receive buffer,
+        // one chunk per segment; only the last one of the last fragment is final
+        ok = true;
+        if (opcode == 0x01 && first) utf8Validator.reset();
+        for (int i = 0; ok && i < payload.count; ++i) {
+            const bool final = fin && (i + 1 == payload.count);
+            if (opcode == 0x01 &&
+                (!utf8Validator.validateChunk(payload.data(i), payload.size(i)) ||
+                 (final && !utf8Validator.validateFinal()))) {
+                log_error("Invalid UTF-8 in streamed text fragment");
+                utf8Validator.reset();
+                _sinks.onRxProtocolError(1007, "Invalid UTF-8 in text message");
+                ok = false;
+                break;
+            }
+            _sinks.onRxChunk(payload.data(i), payload.size(i), opcode == 0x02, final);
         }
+    }
 
-        // If we consumed all input and did not fill the output buffer,
-        // there is no more data to produce.
-        if (inflate_stream.avail_in == 0 && inflate_stream.avail_out != 0) {
-            break;
+    if (!ok || fin) {
+        message_in_progress = false;
+        compressed_message_in_progress = false;
+        streaming_message_in_progress = false;
+        fragmented_opcode = 0;
+    }
+    return ok;
+}
+
+void WebSocketReceiver::rxDeliver(int opcode, const uint8_t* data, size_t len) {
+    if (_sinks.rxStreamChunks()) {
+        _sinks.onRxChunk(data, len, opcode == 0x02, true);
+    } else if (_sinks.rxTakesBuffers()) {
+        // In place in the receive buffer: the application gets a pooled copy
+        WebSocketBufferPool::Storage* msg = pool->acquire(len);
+        msg->assign(data, data + len);
+        _sinks.onRxBuffer(pool->wrap(msg), opcode == 0x02);
+    } else if (opcode == 0x01) {
+        _sinks.onRxText(data, len);
+    } else {
+        _sinks.onRxBinary(data, len);
+    }
+}
+
+void WebSocketReceiver::rxDeliver(int opcode, const RxPayload& payload) {
+    if (payload.contiguous()) {
+        rxDeliver(opcode, payload.data(), payload.len);
+        return;
+    }
+
+    if (_sinks.rxStreamChunks()) {
+        for (int i = 0; i < payload.count; ++i) {
+            _sinks.onRxChunk(payload.data(i), payload.size(i), opcode == 0x02, i + 1 == payload.count);
         }
+        return;
     }
 
+    // Callbacks want the message in one piece; join it in a pooled buffer
+    WebSocketBufferPool::Storage* msg = pool->acquire(payload.len);
+    appendPayload(*msg, payload);
+    rxDeliverOwned(opcode, msg);
+}
+
+bool WebSocketReceiver::rxValidateUtf8(const RxPayload& payload) {
+    for (int i = 0; i < payload.count; ++i) {
+        if (!utf8Validator.validateChunk(payload.data(i), payload.size(i))) return false;
+    }
     return true;
 }
 
+void WebSocketReceiver::rxDeliverOwned(int opcode, WebSocketBufferPool::Storage* msg) {
+    if (!_sinks.rxStreamChunks() && _sinks.rxTakesBuffers()) {
+        _sinks.onRxBuffer(pool->wrap(msg), opcode == 0x02);
+        return;
+    }
+    rxDeliver(opcode, msg->data(), msg->size());
+    pool->recycle(msg);
+}
+
 void WebSocketReceiver::rxMaybeResetAfterMessage() {
     if (_cfg.enabled && _cfg.server_no_context_takeover) {
         rxResetInflate();
     }
 }
 
+bool WebSocketReceiver::rxReadsSegments(int opcode, bool fin, bool rsv1) const {
+    if (opcode != 0x00 && opcode != 0x01 && opcode != 0x02) return false;
+    // Whole uncompressed messages for the view and binary callbacks are
+    // handed over in place, which needs them contiguous; everything else is
+    // streamed, inflated or copied into a message buffer anyway
+    const bool in_place = fin && opcode != 0x00 && !(rsv1 && _sinks.rxCompressionEnabled());
+    return !in_place || _sinks.rxStreamChunks() || _sinks.rxTakesBuffers();
+}
+
 void WebSocketReceiver::onData(evbuffer* buf) {
+    rx_frame_need = 0;
+
     for (;;) {
 
         if (_sinks.rxIsTerminating()) return;
@@ -360,35 +734,72 @@ void WebSocketReceiver::onData(evbuffer* buf) {
         }
 
         const size_t need = header_len + static_cast<size_t>(payload_len);
-        if (data_len < need) break; // wait for full frame
+        if (data_len < need) { // wait for full frame
+            rx_frame_need = need;
+            break;
+        }
 
-        unsigned char* frame = evbuffer_pullup(buf, need);
-        if (!frame) {
-            _sinks.onRxProtocolError(1002, "Failed to pullup frame buffer");
-            return;
+        // Handlers read the payload in place; it is drained once they return.
+        const size_t plen = static_cast<size_t>(payload_len);
+        const unsigned char* payload = nullptr;
+        evbuffer_iovec flat;
+        RxPayload segments;
+
+        if (plen < RX_PULLUP_MAX || !rxReadsSegments(opcode, fin, rsv1)) {
+            unsigned char* frame = evbuffer_pullup(buf, need);
+            if (!frame) {
+                _sinks.onRxProtocolError(1002, "Failed to pullup frame buffer");
+                return;
+            }
+            payload = frame + header_len;
+            flat.iov_base = const_cast<unsigned char*>(payload);
+            flat.iov_len = plen;
+            segments.seg = &flat;
+            segments.count = 1;
+        } else {
+            // Large data frame: walk the chains it spans rather than copying
+            // it into one block; the header is already in hdr
+            evbuffer_ptr start;
+            evbuffer_ptr_set(buf, &start, header_len, EVBUFFER_PTR_SET);
+            const int n = evbuffer_peek(buf, static_cast<ev_ssize_t>(plen), &start, nullptr, 0);
+            if (n <= 0) {
+                _sinks.onRxProtocolError(1002, "Failed to read frame buffer");
+                return;
+            }
+            if (rx_segments.size() < static_cast<size_t>(n)) rx_segments.resize(n);
+            evbuffer_peek(buf, static_cast<ev_ssize_t>(plen), &start, rx_segments.data(), n);
+
+            // The last chain may run on into the next frame
+            size_t total = 0;
+            for (int i = 0; i < n; ++i) total += rx_segments[i].iov_len;
+            rx_segments[n - 1].iov_len -= total - plen;
+
+            segments.seg = rx_segments.data();
+            segments.count = n;
         }
-        const unsigned char* payload_ptr = frame + header_len;
+        segments.len = plen;
 
-        std::vector<uint8_t> payload;
-        payload.reserve(static_cast<size_t>(payload_len));
-        payload.insert(payload.end(), payload_ptr, payload_ptr + static_cast<size_t>(payload_len));
+        if (counters) {
+            WebSocketCounters::bump(counters->frames_in);
+            WebSocketCounters::bump(counters->bytes_in, need);
+        }
 
         switch (opcode) {
             case 0x00:
-                handleContinuationFrame(payload.data(), payload.size(), fin);
+                handleContinuationFrame(segments, fin);
                 break;
             case 0x01:
             case 0x02:
-                handleDataFrame(payload.data(), payload.size(), fin, opcode, rsv1);
+                handleDataFrame(segments, fin, opcode, rsv1);
                 break;
             case 0x08:
-                handleCloseFrame(payload.data(), payload.size());
+                handleCloseFrame(payload, plen);
                 break;
             case 0x09:
-                handlePingFrame(payload.data(), payload.size());
+                handlePingFrame(payload, plen);
                 break;
             case 0x0A:
-                log_debug("Received pong frame");
+                _sinks.onRxPong(std::vector<uint8_t>(payload, payload + plen));
                 break;
             default:
                 log_error("Unknown opcode: %d", opcode);
@@ -400,20 +811,23 @@ void WebSocketReceiver::onData(evbuffer* buf) {
     }
 }
 
-void WebSocketReceiver::handleContinuationFrame(const unsigned char* payload, size_t payload_len, bool fin) {
+void WebSocketReceiver::handleContinuationFrame(const RxPayload& payload, bool fin) {
     if (!message_in_progress) {
         log_error("Received continuation frame without initial frame");
         _sinks.onRxProtocolError(1002, "continuation frame without initial frame");
         return;
     }
 
-    fragmented_message.insert(fragmented_message.end(),
-                              payload,
-                              payload + payload_len);
+    if (streaming_message_in_progress) {
+        rxStreamFragment(payload, false, fin);
+        return;
+    }
+
+    appendPayload(*fragmented_message, payload);
 
     // Only validate UTF-8 if this is an uncompressed text message
     if (!compressed_message_in_progress && fragmented_opcode == 0x01) {
-        if (!utf8Validator.validateChunk(payload, payload_len)) {
+        if (!rxValidateUtf8(payload)) {
             log_error("Invalid UTF-8 in continuation frame");
             utf8Validator.reset();
             _sinks.onRxProtocolError(1007, "Invalid UTF-8 in text message");
@@ -424,14 +838,16 @@ void WebSocketReceiver::handleContinuationFrame(const unsigned char* payload, si
     if (!fin) return;
 
     if (compressed_message_in_progress) {
-        std::vector<uint8_t> output;
-        bool ok = decompressMessage(fragmented_message.data(), fragmented_message.size(), output);
+        WebSocketBufferPool::Storage* output = pool->acquire(fragmented_message->size() * 2);
+        bool ok = decompressMessage(fragmented_message->data(), fragmented_message->size(), *output);
         if (!ok) {
+            pool->recycle(output);
             utf8Validator.reset();
             _sinks.onRxProtocolError(1007, "Decompression failed");
             return;
         }
-        fragmented_message.swap(output);
+        pool->recycle(fragmented_message);
+        fragmented_message = output;
 
         // takeover handling
         rxMaybeResetAfterMessage();
@@ -442,7 +858,7 @@ void WebSocketReceiver::handleContinuationFrame(const unsigned char* payload, si
             bool ok = true;
             if (compressed_message_in_progress) {
                 utf8Validator.reset();
-                ok = utf8Validator.validateChunk(fragmented_message.data(), fragmented_message.size())
+                ok = utf8Validator.validateChunk(fragmented_message->data(), fragmented_message->size())
                   && utf8Validator.validateFinal();
             } else {
                 ok = utf8Validator.validateFinal();
@@ -455,16 +871,12 @@ void WebSocketReceiver::handleContinuationFrame(const unsigned char* payload, si
                 return;
             }
 
-            std::string message(fragmented_message.begin(), fragmented_message.end());
             utf8Validator.reset();
-            _sinks.onRxText(std::move(message));
             break;
         }
 
-        case 0x02: {
-            _sinks.onRxBinary(std::move(fragmented_message));
+        case 0x02:
             break;
-        }
 
         default:
             log_error("Unknown fragmented opcode: %d", fragmented_opcode);
@@ -472,14 +884,18 @@ void WebSocketReceiver::handleContinuationFrame(const unsigned char* payload, si
             return;
     }
 
-    // Reset fragmentation state
+    // Reset fragmentation state before delivery hands the buffer on
+    const int opcode = fragmented_opcode;
+    WebSocketBufferPool::Storage* msg = fragmented_message;
+    fragmented_message = nullptr;
     message_in_progress = false;
     compressed_message_in_progress = false;
-    std::vector<uint8_t>().swap(fragmented_message);
     fragmented_opcode = 0;
+
+    rxDeliverOwned(opcode, msg);
 }
 
-void WebSocketReceiver::handleDataFrame(const unsigned char* payload, size_t payload_len, bool fin, int opcode, bool rsv1) {
+void WebSocketReceiver::handleDataFrame(const RxPayload& payload, bool fin, int opcode, bool rsv1) {
     if (message_in_progress) {
         log_error("Received new data frame (opcode %d) while expecting a continuation frame.", opcode);
         _sinks.onRxProtocolError(1002, "Received new data frame when expecting continuation frame");
@@ -491,13 +907,22 @@ void WebSocketReceiver::handleDataFrame(const unsigned char* payload, size_t pay
     if (!fin) {
         message_in_progress = true;
         fragmented_opcode = opcode;
-        fragmented_message.assign(payload, payload + payload_len);
-
         compressed_message_in_progress = compressed;
 
+        // Streaming: deliver fragment by fragment, memory bounded by frame size
+        if (_sinks.rxStreamChunks() && (opcode == 0x01 || opcode == 0x02)) {
+            streaming_message_in_progress = true;
+            rxStreamFragment(payload, true, false);
+            return;
+        }
+
+        if (!fragmented_message) fragmented_message = pool->acquire(payload.len);
+        fragmented_message->clear();
+        appendPayload(*fragmented_message, payload);
+
         if (opcode == 0x01 && !compressed_message_in_progress) {
             utf8Validator.reset();
-            if (!utf8Validator.validateChunk(payload, payload_len)) {
+            if (!rxValidateUtf8(payload)) {
                 log_error("Invalid UTF-8 in initial fragment");
                 utf8Validator.reset();
                 _sinks.onRxProtocolError(1007, "Invalid UTF-8 in text message");
@@ -508,43 +933,51 @@ void WebSocketReceiver::handleDataFrame(const unsigned char* payload, size_t pay
     }
 
     // Single unfragmented message
-    const uint8_t* msg_data = payload;
-    size_t msg_len = payload_len;
-    std::vector<uint8_t> decompressed;
+    if (compressed && _sinks.rxStreamChunks() && (opcode == 0x01 || opcode == 0x02)) {
+        if (rxInflateChunks(payload, opcode, true, true)) {
+            rxMaybeResetAfterMessage();
+        }
+        return;
+    }
+
+    if (opcode != 0x01 && opcode != 0x02) {
+        log_error("Unsupported data opcode: %d", opcode);
+        _sinks.onRxProtocolError(1002, "Unsupported opcode");
+        return;
+    }
+
+    WebSocketBufferPool::Storage* decompressed = nullptr;
 
     if (compressed) {
-        bool ok = decompressMessage(msg_data, msg_len, decompressed);
+        decompressed = pool->acquire(payload.len * 2);
+        bool ok = rxInflate(payload, *decompressed);
         if (!ok) {
+            pool->recycle(decompressed);
             _sinks.onRxProtocolError(1007, "Decompression failed");
             return;
         }
-        msg_data = decompressed.data();
-        msg_len  = decompressed.size();
 
         rxMaybeResetAfterMessage();
     }
 
     if (opcode == 0x01) {
         utf8Validator.reset();
-        if (!utf8Validator.validateChunk(msg_data, msg_len) ||
-            !utf8Validator.validateFinal()) {
+        const bool valid = decompressed
+            ? utf8Validator.validateChunk(decompressed->data(), decompressed->size())
+            : rxValidateUtf8(payload);
+        if (!valid || !utf8Validator.validateFinal()) {
             log_error("Invalid UTF-8 in unfragmented text");
             utf8Validator.reset();
+            pool->recycle(decompressed);
             _sinks.onRxProtocolError(1007, "Invalid UTF-8 in text message");
             return;
         }
+    }
 
-        std::string message(reinterpret_cast<const char*>(msg_data), msg_len);
-        _sinks.onRxText(std::move(message));
-
-    } else if (opcode == 0x02) {
-        std::vector<uint8_t> b(msg_data, msg_data + msg_len);
-        _sinks.onRxBinary(std::move(b));
-
+    if (decompressed) {
+        rxDeliverOwned(opcode, decompressed);
     } else {
-        log_error("Unsupported data opcode: %d", opcode);
-        _sinks.onRxProtocolError(1002, "Unsupported opcode");
-        return;
+        rxDeliver(opcode, payload);
     }
 }
 
@@ -610,64 +1043,5 @@ void WebSocketReceiver::handlePingFrame(const unsigned char* payload, size_t pay
 }
 
 bool WebSocketReceiver::isValidUtf8(const char* str, size_t len) {
-    const unsigned char* bytes = (const unsigned char*)str;
-    size_t i = 0;
-    
-    while (i < len) {
-        if (bytes[i] <= 0x7F) {
-            i++;
-            continue;
-        }
-        
-        if (bytes[i] >= 0xF5 || (bytes[i] >= 0xC0 && bytes[i] <= 0xC1)) {
-            return false;
-        }
-        
-        if ((bytes[i] & 0xE0) == 0xC0) {
-            if (i + 1 >= len || (bytes[i+1] & 0xC0) != 0x80) {
-                return false;
-            }
-            i += 2;
-        }
-        else if ((bytes[i] & 0xF0) == 0xE0) {
-            if (i + 2 >= len || 
-                (bytes[i+1] & 0xC0) != 0x80 || 
-                (bytes[i+2] & 0xC0) != 0x80) {
-                return false;
-            }
-            
-            if (bytes[i] == 0xE0 && (bytes[i+1] < 0xA0)) {
-                return false;
-            }
-            
-            if (bytes[i] == 0xED && (bytes[i+1] >= 0xA0)) {
-                return false;
-            }
-            
-            i += 3;
-        }
-        else if ((bytes[i] & 0xF8) == 0xF0) {
-            if (i + 3 >= len || 
-                (bytes[i+1] & 0xC0) != 0x80 || 
-                (bytes[i+2] & 0xC0) != 0x80 || 
-                (bytes[i+3] & 0xC0) != 0x80) {
-                return false;
-            }
-            
-            if (bytes[i] == 0xF0 && (bytes[i+1] < 0x90)) {
-                return false;
-            }
-            
-            if (bytes[i] == 0xF4 && (bytes[i+1] > 0x8F)) {
-                return false;
-            }
-            
-            i += 4;
-        }
-        else {
-            return false;
-        }
-    }
-    
-    return true;
-}
\ No newline at end of file
+    return Utf8Validator::validate(reinterpret_cast<const uint8_t*>(str), len);
+}
@@ -7,9 +7,14 @@
 #pragma once
 #include "IWebSocketSinks.h"
 #include "Utf8Validator.h"
+#include "ZStreamPool.h"
+#include "DeflateCodec.h"
+#include "WebSocketCounters.h"
+#include "WebSocketBufferPool.h"
 
 #include <event2/buffer.h>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -25,6 +30,25 @@ struct PerMessageDeflateConfig {
     int client_max_window_bits = 15;
     int server_max_window_bits = 15;
     int compression_level = Z_DEFAULT_COMPRESSION;
+    int mem_level = 8;
+    int strategy = Z_DEFAULT_STRATEGY;
+    size_t min_size = 0;                 // shorter payloads are sent raw
+    bool adaptive = false;               // back off while compression isn't paying off
+    double adaptive_max_ratio = 0.9;     // compressed/original average above which we back off
+    unsigned adaptive_probe_interval = 64;
+    bool shared_streams = false;         // borrow no-context-takeover streams from ZStreamPool
+};
+
+// Payload of one frame where it lies in the input buffer: a single segment
+// when contiguous, otherwise one per evbuffer chain it spans
+struct RxPayload {
+    const evbuffer_iovec* seg = nullptr;
+    int count = 0;
+    size_t len = 0;
+
+    bool contiguous() const { return count == 1; }
+    const uint8_t* data(int i = 0) const { return static_cast<const uint8_t*>(seg[i].iov_base); }
+    size_t size(int i) const { return seg[i].iov_len; }
 };
 
 class WebSocketReceiver {
@@ -32,50 +56,110 @@ public:
     explicit WebSocketReceiver(IWebSocketSinks& sinks);
     ~WebSocketReceiver();
 
+    // Streams from an earlier connection are reset and kept when the
+    // negotiated parameters match, instead of being freed and rebuilt
     bool initializeCompression(const PerMessageDeflateConfig& cfg);
     void shutdownCompression();
 
+    // Forget a partly received message before the next connection
+    void reset();
+
+    // Times an outgoing message outgrew its first deflate buffer
+    uint64_t txDeflateGrows() const { return tx_grow_count; }
+
+    // Frame, compression and timing counters; null counts nothing
+    void setCounters(WebSocketCounters* c) { counters = c; }
+
     bool txPrepare(const uint8_t* original_ptr, size_t original_len, bool request_compress,
                    const uint8_t*& payload_ptr, size_t& payload_len, bool& do_compress);
     
     bool rxInflate(const uint8_t* in, size_t in_len, std::vector<uint8_t>& out);
+    bool rxInflate(const RxPayload& in, std::vector<uint8_t>& out);
+    bool rxInflateChunks(const RxPayload& in, int opcode, bool first, bool fin);
     void rxMaybeResetAfterMessage();
 
     void onData(evbuffer* buf);
+
+    // Total size of the partly received frame at the head of the input (0 if none)
+    size_t rxIncompleteFrameSize() const { return rx_frame_need; }
     
     bool decompressMessage(const uint8_t* in, size_t in_len, std::vector<uint8_t>& out) {
         return rxInflate(in, in_len, out);
     }
 
-    void handleContinuationFrame(const unsigned char* payload, size_t payload_len, bool fin);
-    void handleDataFrame(const unsigned char* payload, size_t payload_len, bool fin, int opcode, bool rsv1);
+    void handleContinuationFrame(const RxPayload& payload, bool fin);
+    void handleDataFrame(const RxPayload& payload, bool fin, int opcode, bool rsv1);
     void handleCloseFrame(const unsigned char* payload, size_t payload_len);
     void handlePingFrame(const unsigned char* payload, size_t payload_len);
     
 private:
     bool txDeflate(const uint8_t* in, size_t in_len);
-    bool txReinitAfterNoContextTakeover();
     bool rxInitInflate();
     bool txInitDeflate();
     void rxResetInflate();
+    void rxDeliver(int opcode, const uint8_t* data, size_t len);
+    void rxDeliver(int opcode, const RxPayload& payload);
+    void rxDeliverOwned(int opcode, WebSocketBufferPool::Storage* msg);
+    void rxDropFragments();
+    bool rxStreamFragment(const RxPayload& payload, bool first, bool fin);
+    bool rxValidateUtf8(const RxPayload& payload);
+    bool rxReadsSegments(int opcode, bool fin, bool rsv1) const;
     void txResetDeflate();
+    static bool sameStreams(const PerMessageDeflateConfig& a, const PerMessageDeflateConfig& b);
+    z_stream* rxStream();
+    z_stream* txStream();
+    ZStreamPool::DeflateParams txPoolParams() const;
+    void txTrackRatio(size_t original_len, size_t compressed_len);
 
 private:
     IWebSocketSinks& _sinks;
     PerMessageDeflateConfig _cfg;
+    WebSocketCounters* counters = nullptr;
 
+    // Resident streams; rx_zs/tx_zs point here, or at a stream borrowed
+    // from ZStreamPool for the current message when the direction is pooled
     z_stream inflate_stream{};
     z_stream deflate_stream{};
+    z_stream* rx_zs = nullptr;
+    z_stream* tx_zs = nullptr;
+    bool rx_pooled = false;
+    bool tx_pooled = false;
     bool inflate_initialized = false;
     bool deflate_initialized = false;
+
+    // Alternative backend for whole messages in directions without context takeover
+    std::unique_ptr<DeflateCodec> codec;
+    bool codec_tx = false;
+    bool codec_rx = false;
     
     std::vector<uint8_t> tx_compressed_buf;
     size_t tx_payload_len = 0;
+    uint64_t tx_grow_count = 0;
+
+    // Adaptive mode: running compressed/original ratio and messages left to skip
+    double tx_ratio_avg = -1.0;          // < 0 until the first sample
+    unsigned tx_skip_remaining = 0;
+
+    size_t rx_frame_need = 0;
+
+    // Data frames at least this long are read where they lie in the input
+    // chains instead of being pulled up into one block, unless they are
+    // delivered in place
+    static const size_t RX_PULLUP_MAX = 64 * 1024;
+    std::vector<evbuffer_iovec> rx_segments;
 
     bool message_in_progress = false;
     bool compressed_message_in_progress = false;
+    bool streaming_message_in_progress = false;
     int  fragmented_opcode = 0;
-    std::vector<uint8_t> fragmented_message;
+    WebSocketBufferPool::Storage* fragmented_message = nullptr;   // from pool, while reassembling
+
+    // Recycled buffers for reassembled and inflated messages
+    std::shared_ptr<WebSocketBufferPool> pool;
+
+    // Scratch window for streaming (chunked) inflate
+    static const size_t RX_CHUNK_SIZE = 64 * 1024;
+    std::vector<uint8_t> rx_chunk_buf;
 
     Utf8Validator utf8Validator;
     bool isValidUtf8(const char *str, size_t len);
@@ -0,0 +1,39 @@
+/*
+ *  WebSocketReconnectOptions.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+
+/**
+ * \struct WebSocketReconnectOptions
+ * \brief Automatic reconnect after a lost or failed connection
+ *
+ * \details When enabled, a connection that fails, times out or is closed
+ * by the server is retried on the same client until disconnect() is
+ * called. Attempts are spaced by exponential backoff, and each delay is
+ * shortened by a random part of up to jitter times itself, so clients
+ * dropped together do not all return at the same moment.
+ *
+ * A retry keeps the event loop, TLS context and session, resolver cache
+ * and compression streams of the previous attempt. The open, close and
+ * error callbacks fire for every attempt as they would for a single one.
+ */
+struct WebSocketReconnectOptions {
+    bool enabled = false;
+    unsigned int initialDelayMs = 250;    ///< Delay before the first retry
+    unsigned int maxDelayMs = 30000;      ///< Upper bound for the delay
+    double multiplier = 2.0;              ///< Growth of the delay per failed attempt
+    double jitter = 0.5;                  ///< Fraction of each delay that is randomized (0..1)
+    unsigned int maxAttempts = 0;         ///< Consecutive failed retries before giving up; 0 = never
+
+    /**
+     * \brief Keep queued messages for the next connection
+     *
+     * Messages not yet written when a connection is lost, and those sent
+     * while reconnecting, go out once the next handshake completes. When
+     * false, what was queued at the time of the loss is dropped.
+     */
+    bool keepQueue = true;
+};
@@ -0,0 +1,39 @@
+/*
+ *  WebSocketSocketOptions.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+#include <cstddef>
+
+/**
+ * \struct WebSocketSocketOptions
+ * \brief TCP socket and read/write sizing for a WebSocket connection
+ *
+ * \details Socket options are applied to each socket before connect(),
+ * including every address raced by Happy Eyeballs, so SO_RCVBUF also
+ * sets the window scale offered in the SYN. Zero (or -1 for ipTos)
+ * leaves the system or libevent default in place. A failing setsockopt
+ * is logged and otherwise ignored.
+ */
+struct WebSocketSocketOptions {
+    bool tcpNoDelay = true;        ///< TCP_NODELAY: send small frames without Nagle delay
+    int sendBufferSize = 0;        ///< SO_SNDBUF in bytes (0 = system default)
+    int receiveBufferSize = 0;     ///< SO_RCVBUF in bytes, also bounds the window scale (0 = system default)
+    int busyPollUs = 0;            ///< SO_BUSY_POLL in microseconds, Linux only (0 = off)
+    int ipTos = -1;                ///< IP_TOS / DSCP byte (-1 = leave unset)
+
+    size_t maxSingleRead = 0;      ///< Largest single socket read by libevent (0 = libevent default, 16 KB)
+    size_t maxSingleWrite = 0;     ///< Largest single socket write by libevent (0 = libevent default, 16 KB)
+
+    /**
+     * \brief Adaptive read watermark step in bytes (0 = off)
+     *
+     * While a frame is only partly received, the read callback is held
+     * back until the whole frame, or this many more bytes, have arrived,
+     * so a large frame is parsed in a few wakeups instead of one per
+     * socket read. Small frames are unaffected.
+     */
+    size_t readWatermarkStep = 0;
+};
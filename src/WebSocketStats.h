@@ -0,0 +1,81 @@
+/*
+ *  WebSocketStats.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * \struct WebSocketLatencyStats
+ * \brief Summary of a latency histogram, in microseconds
+ *
+ * \details Percentiles come from log-linear buckets with 16 steps per
+ * power of two, so they are accurate to about 6%; min and max are exact.
+ */
+struct WebSocketLatencyStats {
+    uint64_t count = 0;   ///< Samples recorded
+    uint64_t minUs = 0;
+    uint64_t p50Us = 0;
+    uint64_t p90Us = 0;
+    uint64_t p99Us = 0;
+    uint64_t p999Us = 0;
+    uint64_t maxUs = 0;
+    double meanUs = 0.0;
+};
+
+/**
+ * \struct WebSocketStats
+ * \brief Snapshot of a connection's (or the whole process's) counters
+ *
+ * \details Counters are cumulative over the lifetime of a WebSocketClient,
+ * across reconnects. Gauges (marked below) describe the moment the
+ * snapshot was taken. Byte counts are WebSocket frame bytes, headers
+ * included, before TLS.
+ */
+struct WebSocketStats {
+    uint64_t messagesIn = 0;            ///< Data messages delivered
+    uint64_t messagesOut = 0;           ///< Data messages written to the output buffer
+    uint64_t framesIn = 0;              ///< Frames parsed, control frames included
+    uint64_t framesOut = 0;             ///< Frames written, control frames included
+    uint64_t bytesIn = 0;               ///< Frame bytes received
+    uint64_t bytesOut = 0;              ///< Frame bytes written
+
+    uint64_t txUncompressedBytes = 0;   ///< Payload bytes of messages sent compressed, before deflate
+    uint64_t txCompressedBytes = 0;     ///< The same messages after deflate
+    uint64_t rxCompressedBytes = 0;     ///< Payload bytes of compressed messages received
+    uint64_t rxUncompressedBytes = 0;   ///< The same messages after inflate
+    uint64_t deflateTimeUs = 0;         ///< Time spent compressing
+    uint64_t inflateTimeUs = 0;         ///< Time spent decompressing (chunk callbacks included when streaming)
+    uint64_t deflateBufferGrows = 0;    ///< Messages that outgrew their first deflate buffer
+
+    uint64_t sendsRejected = 0;         ///< Sends refused because the send queue or buffer was full
+    uint64_t sendQueueHighWater = 0;    ///< Most messages ever waiting in the send queue
+    size_t sendQueueDepth = 0;          ///< Gauge: messages waiting in the send queue
+    size_t bufferedAmount = 0;          ///< Gauge: bytes queued plus bytes in the output buffer
+    size_t outputBufferLength = 0;      ///< Gauge: bytes in the output buffer, as last seen by the event thread
+
+    uint64_t connects = 0;              ///< Connection attempts started
+    uint64_t reconnects = 0;            ///< Attempts after the first one
+    uint64_t opens = 0;                 ///< Attempts that completed the upgrade
+    uint64_t lastConnectUs = 0;         ///< DNS and TCP connect time of the last connection
+    uint64_t lastHandshakeUs = 0;       ///< connect() to upgrade completion (DNS, TCP, TLS, HTTP) of the last connection
+
+    uint64_t pingsSent = 0;             ///< Keepalive pings sent
+    uint64_t pongsReceived = 0;         ///< Pongs that answered one of them
+    uint64_t lastRttUs = 0;             ///< Round trip of the latest answered ping
+    WebSocketLatencyStats rtt;          ///< Ping round trips (needs setPingInterval())
+    WebSocketLatencyStats sendLatency;  ///< Send call until framed into the output buffer (needs setSendLatencyTracking())
+
+    /// Compressed / uncompressed size of sent compressed messages (0 if none)
+    double txCompressionRatio() const {
+        return txUncompressedBytes ? static_cast<double>(txCompressedBytes) / static_cast<double>(txUncompressedBytes) : 0.0;
+    }
+
+    /// Compressed / uncompressed size of received compressed messages (0 if none)
+    double rxCompressionRatio() const {
+        return rxUncompressedBytes ? static_cast<double>(rxCompressedBytes) / static_cast<double>(rxUncompressedBytes) : 0.0;
+    }
+};
@@ -9,18 +9,91 @@
 #include <openssl/sha.h>
 #include <openssl/err.h>
 
+#include <ctime>
+#include <map>
+#include <mutex>
+
+#include "Logger.h"
+
+// One SSL_CTX per distinct WebSocketTLSOptions, plus its client sessions
+struct WebSocketTLSContext::Shared {
+    SSL_CTX* ctx = nullptr;
+    bool resume = false;
+
+    static const size_t MAX_SESSIONS = 1024;
+
+    std::mutex mtx;
+    std::map<std::string, SSL_SESSION*> sessions;   // "host:port" -> latest ticket
+
+    ~Shared() {
+        for (auto& kv : sessions) SSL_SESSION_free(kv.second);
+        if (ctx) {
+            SSL_CTX_set_app_data(ctx, nullptr);   // SSLs still alive stop storing here
+            SSL_CTX_free(ctx);
+        }
+    }
+};
+
+const size_t WebSocketTLSContext::Shared::MAX_SESSIONS;
+
+namespace {
+
+std::mutex& cacheMutex() {
+    static std::mutex* m = new std::mutex;   // never destroyed: contexts may outlive static teardown
+    return *m;
+}
+
+std::map<std::string, std::shared_ptr<WebSocketTLSContext::Shared>>& cache() {
+    static auto* c = new std::map<std::string, std::shared_ptr<WebSocketTLSContext::Shared>>;
+    return *c;
+}
+
+// Everything that goes into the SSL_CTX, plus the hostname policy: a
+// resumed session skips verification, so sessions are only shared by
+// clients that would have checked the certificate the same way
+std::string cacheKey(const WebSocketTLSOptions& opt) {
+    std::string key;
+    for (const std::string* f : { &opt.certFile, &opt.keyFile, &opt.caFile, &opt.ciphers }) {
+        key += *f;
+        key += '\0';
+    }
+    key += opt.sessionResumption ? '1' : '0';
+    key += opt.kernelTls ? '1' : '0';
+    key += opt.disableHostnameValidation ? '1' : '0';
+    return key;
+}
+
+void freePeer(void* /*parent*/, void* ptr, CRYPTO_EX_DATA* /*ad*/, int /*idx*/, long /*argl*/, void* /*argp*/) {
+    delete static_cast<std::string*>(ptr);
+}
+
+// Per-SSL "host:port", so the new-session callback knows where a ticket belongs
+int peerIndex() {
+    static const int idx = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, freePeer);
+    return idx;
+}
+
+bool sessionUsable(SSL_SESSION* s) {
+    if (!SSL_SESSION_is_resumable(s)) return false;
+    const long expires = SSL_SESSION_get_time(s) + SSL_SESSION_get_timeout(s);
+    return expires > static_cast<long>(std::time(nullptr));
+}
+
+} // namespace
+
 WebSocketTLSContext::~WebSocketTLSContext() {
     reset();
 }
 
 WebSocketTLSContext::WebSocketTLSContext(WebSocketTLSContext&& other) noexcept
-    : _ctx(other._ctx) {
+    : _shared(std::move(other._shared)), _ctx(other._ctx) {
     other._ctx = nullptr;
 }
 
 WebSocketTLSContext& WebSocketTLSContext::operator=(WebSocketTLSContext&& other) noexcept {
     if (this != &other) {
         reset();
+        _shared = std::move(other._shared);
         _ctx = other._ctx;
         other._ctx = nullptr;
     }
@@ -28,10 +101,8 @@ WebSocketTLSContext& WebSocketTLSContext::operator=(WebSocketTLSContext&& other)
 }
 
 void WebSocketTLSContext::reset() noexcept {
-    if (_ctx) {
-        SSL_CTX_free(_ctx);
-        _ctx = nullptr;
-    }
+    _shared.reset();
+    _ctx = nullptr;
 }
 
 static std::string opensslLastErrorString() {
@@ -42,14 +113,31 @@ static std::string opensslLastErrorString() {
     return std::string(buf);
 }
 
-bool WebSocketTLSContext::init(const WebSocketTLSOptions& opt, std::string& err) {
-    err.clear();
-    reset();
+static int onNewSession(SSL* ssl, SSL_SESSION* sess) {
+    auto* sh = static_cast<WebSocketTLSContext::Shared*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+    const auto* peer = static_cast<const std::string*>(SSL_get_ex_data(ssl, peerIndex()));
+    if (!sh || !peer || !SSL_SESSION_is_resumable(sess)) return 0;
 
+    std::lock_guard<std::mutex> lk(sh->mtx);
+    auto it = sh->sessions.find(*peer);
+    if (it != sh->sessions.end()) {
+        SSL_SESSION_free(it->second);
+        it->second = sess;
+    } else {
+        if (sh->sessions.size() >= WebSocketTLSContext::Shared::MAX_SESSIONS) {
+            SSL_SESSION_free(sh->sessions.begin()->second);
+            sh->sessions.erase(sh->sessions.begin());
+        }
+        sh->sessions.emplace(*peer, sess);
+    }
+    return 1;   // we keep the reference
+}
+
+static SSL_CTX* buildCtx(const WebSocketTLSOptions& opt, std::string& err) {
     SSL_CTX* ctx = SSL_CTX_new(TLS_client_method());
     if (!ctx) {
         err = "SSL_CTX_new failed: " + opensslLastErrorString();
-        return false;
+        return nullptr;
     }
 
     SSL_CTX_set_options(ctx, SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3);
@@ -63,7 +151,7 @@ bool WebSocketTLSContext::init(const WebSocketTLSOptions& opt, std::string& err)
         if (SSL_CTX_set_cipher_list(ctx, cipherStr.c_str()) != 1) {
             err = "SSL_CTX_set_cipher_list failed: " + opensslLastErrorString();
             SSL_CTX_free(ctx);
-            return false;
+            return nullptr;
         }
     }
 
@@ -78,14 +166,14 @@ bool WebSocketTLSContext::init(const WebSocketTLSOptions& opt, std::string& err)
             if (SSL_CTX_set_default_verify_paths(ctx) != 1) {
                 err = "SSL_CTX_set_default_verify_paths failed: " + opensslLastErrorString();
                 SSL_CTX_free(ctx);
-                return false;
+                return nullptr;
             }
         } else if (opt.isUsingCustomCA()) {
             if (SSL_CTX_load_verify_locations(ctx, opt.caFile.c_str(), nullptr) != 1) {
                 err = "SSL_CTX_load_verify_locations failed for CA file '" + opt.caFile +
                       "': " + opensslLastErrorString();
                 SSL_CTX_free(ctx);
-                return false;
+                return nullptr;
             }
         }
     }
@@ -96,25 +184,72 @@ bool WebSocketTLSContext::init(const WebSocketTLSOptions& opt, std::string& err)
             err = "SSL_CTX_use_certificate_file failed for '" + opt.certFile +
                   "': " + opensslLastErrorString();
             SSL_CTX_free(ctx);
-            return false;
+            return nullptr;
         }
         if (SSL_CTX_use_PrivateKey_file(ctx, opt.keyFile.c_str(), SSL_FILETYPE_PEM) != 1) {
             err = "SSL_CTX_use_PrivateKey_file failed for '" + opt.keyFile +
                   "': " + opensslLastErrorString();
             SSL_CTX_free(ctx);
-            return false;
+            return nullptr;
         }
         if (SSL_CTX_check_private_key(ctx) != 1) {
             err = "SSL_CTX_check_private_key failed: " + opensslLastErrorString();
             SSL_CTX_free(ctx);
-            return false;
+            return nullptr;
         }
     }
 
-    _ctx = ctx;
+    if (opt.sessionResumption) {
+        // Sessions live in Shared, keyed by peer, not in OpenSSL's server-style cache
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(ctx, onNewSession);
+    } else {
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+        SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
+    }
+
+    if (opt.kernelTls) {
+#ifdef SSL_OP_ENABLE_KTLS
+        // Falls back to user-space TLS when the cipher or kernel cannot do it
+        SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS);
+#else
+        log_error("kTLS requested but not supported by this OpenSSL build");
+#endif
+    }
+
+    return ctx;
+}
+
+bool WebSocketTLSContext::init(const WebSocketTLSOptions& opt, std::string& err) {
+    err.clear();
+    reset();
+
+    const std::string key = cacheKey(opt);
+
+    // Built under the lock so a reconnect storm loads the CA store once
+    std::lock_guard<std::mutex> lk(cacheMutex());
+    auto it = cache().find(key);
+    if (it == cache().end()) {
+        SSL_CTX* ctx = buildCtx(opt, err);
+        if (!ctx) return false;
+
+        auto sh = std::make_shared<Shared>();
+        sh->ctx = ctx;
+        sh->resume = opt.sessionResumption;
+        SSL_CTX_set_app_data(ctx, sh.get());
+        it = cache().emplace(key, std::move(sh)).first;
+    }
+
+    _shared = it->second;
+    _ctx = _shared->ctx;
     return true;
 }
 
+void WebSocketTLSContext::clearCache() {
+    std::lock_guard<std::mutex> lk(cacheMutex());
+    cache().clear();
+}
+
 SSL* WebSocketTLSContext::createSsl(std::string& err) const {
     err.clear();
     if (!_ctx) {
@@ -128,4 +263,23 @@ SSL* WebSocketTLSContext::createSsl(std::string& err) const {
         return nullptr;
     }
     return ssl;
+}
+
+SSL* WebSocketTLSContext::createSsl(const std::string& peer, std::string& err) const {
+    SSL* ssl = createSsl(err);
+    if (!ssl || !_shared->resume || peer.empty()) return ssl;
+
+    SSL_set_ex_data(ssl, peerIndex(), new std::string(peer));
+
+    std::lock_guard<std::mutex> lk(_shared->mtx);
+    auto it = _shared->sessions.find(peer);
+    if (it != _shared->sessions.end()) {
+        if (sessionUsable(it->second)) {
+            SSL_set_session(ssl, it->second);
+        } else {
+            SSL_SESSION_free(it->second);
+            _shared->sessions.erase(it);
+        }
+    }
+    return ssl;
 }
\ No newline at end of file
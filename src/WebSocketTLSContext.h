@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include "WebSocketTLSOptions.h"
 
@@ -15,6 +16,15 @@ struct ssl_st;
 using SSL_CTX = ssl_ctx_st;
 using SSL     = ssl_st;
 
+/**
+ * \brief Handle to a process-wide, shared SSL_CTX.
+ *
+ * init() looks the options up in a cache and only builds a new SSL_CTX
+ * (loading CA bundle, certificate and key) the first time a set of
+ * options is seen. Cached contexts also keep the client sessions used
+ * to resume handshakes with the same host and port. SSL_CTX is safe to
+ * share between threads; the session store is locked.
+ */
 class WebSocketTLSContext {
 public:
     WebSocketTLSContext() = default;
@@ -31,7 +41,15 @@ public:
     SSL_CTX* get() const noexcept { return _ctx; }
     bool isInitialized() const noexcept { return _ctx != nullptr; }
     SSL* createSsl(std::string& err) const;
+    /// Same, offering a cached session for peer ("host:port") if there is one
+    SSL* createSsl(const std::string& peer, std::string& err) const;
+
+    /// Drop cached contexts and sessions; handles already held keep theirs
+    static void clearCache();
+
+    struct Shared;   // opaque; defined in WebSocketTLSContext.cpp
 
 private:
+    std::shared_ptr<Shared> _shared;
     SSL_CTX* _ctx {nullptr};
 };
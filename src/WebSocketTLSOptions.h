@@ -20,6 +20,8 @@ struct WebSocketTLSOptions {
     std::string caFile = "SYSTEM"; ///< CA bundle path ("SYSTEM" for OS trust store, "NONE" to disable verification)
     std::string ciphers = "DEFAULT"; ///< Custom cipher suite string or "DEFAULT" for secure defaults
     bool disableHostnameValidation = false; ///< If true, skips hostname verification
+    bool sessionResumption = true; ///< Resume TLS sessions (tickets / session IDs) when reconnecting to the same host and port
+    bool kernelTls = false; ///< Request kTLS offload (OpenSSL 3 built with kTLS, Linux tls module loaded)
 
     /**
      * \brief Get the default secure cipher suite list
@@ -0,0 +1,220 @@
+/*
+ *  WebSocketTimerWheel.cpp
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "WebSocketTimerWheel.h"
+#include "Logger.h"
+
+#include <random>
+
+const unsigned WebSocketTimerWheel::TICK_MS;
+const unsigned WebSocketTimerWheel::SLOT_BITS;
+const unsigned WebSocketTimerWheel::SLOTS;
+const unsigned WebSocketTimerWheel::LEVELS;
+
+WebSocketTimerWheel::WebSocketTimerWheel(event_base* base)
+    : origin(std::chrono::steady_clock::now()), rng(std::random_device{}()) {
+    for (auto& level : slots) {
+        for (auto& head : level) {
+            head.prev = head.next = &head;
+        }
+    }
+
+    tick_event = evtimer_new(base, &WebSocketTimerWheel::tickCallback, this);
+    if (!tick_event) {
+        log_error("Failed to create timer wheel event");
+    }
+}
+
+WebSocketTimerWheel::~WebSocketTimerWheel() {
+    if (tick_event) {
+        event_del(tick_event);
+        event_free(tick_event);
+        tick_event = nullptr;
+    }
+
+    // Leave any timer still linked disarmed, so a late cancel() is harmless
+    for (auto& level : slots) {
+        for (auto& head : level) {
+            WebSocketTimer* t = head.next;
+            while (t != &head) {
+                WebSocketTimer* next = t->next;
+                t->prev = t->next = nullptr;
+                t = next;
+            }
+        }
+    }
+}
+
+uint64_t WebSocketTimerWheel::elapsedUs() const {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - origin).count());
+}
+
+uint64_t WebSocketTimerWheel::nowTick() const {
+    return elapsedUs() / (TICK_MS * 1000);
+}
+
+uint64_t WebSocketTimerWheel::jitter(uint64_t range_ms) {
+    if (range_ms == 0) return 0;
+    std::uniform_int_distribution<uint64_t> dist(0, range_ms);
+    return dist(rng);
+}
+
+void WebSocketTimerWheel::schedule(WebSocketTimer& timer, uint64_t delay_ms) {
+    if (timer.armed()) unlink(timer);
+
+    // First tick starting at or after the deadline: up to a tick late, never early
+    const uint64_t tick_us = TICK_MS * 1000;
+    const uint64_t due = (elapsedUs() + delay_ms * 1000 + tick_us - 1) / tick_us;
+
+    // The wheel lags the clock while a wakeup is pending
+    timer.expires = due > current ? due : current + 1;
+
+    insert(timer);
+    ++count;
+
+    // From a callback tickCallback() re-arms once the tick is done
+    if (!advancing && (wake == 0 || timer.expires < wake)) arm();
+}
+
+void WebSocketTimerWheel::cancel(WebSocketTimer& timer) {
+    if (!timer.armed()) return;
+    unlink(timer);
+    --count;
+    // The pending wakeup is left alone; advancing over empty slots is cheap
+}
+
+void WebSocketTimerWheel::insert(WebSocketTimer& timer) {
+    const uint64_t delta = timer.expires - current;
+
+    unsigned level = 0;
+    while (level + 1 < LEVELS && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+
+    // Past the last level: park in the slot that comes round last
+    uint64_t at = timer.expires;
+    const uint64_t span = uint64_t(1) << (SLOT_BITS * LEVELS);
+    if (delta >= span) at = current + span - 1;
+
+    const unsigned index = static_cast<unsigned>((at >> (SLOT_BITS * level)) & (SLOTS - 1));
+    WebSocketTimer& head = slots[level][index];
+
+    timer.prev = head.prev;
+    timer.next = &head;
+    head.prev->next = &timer;
+    head.prev = &timer;
+}
+
+void WebSocketTimerWheel::unlink(WebSocketTimer& timer) {
+    timer.prev->next = timer.next;
+    timer.next->prev = timer.prev;
+    timer.prev = timer.next = nullptr;
+}
+
+void WebSocketTimerWheel::cascade(unsigned level, unsigned index) {
+    WebSocketTimer& head = slots[level][index];
+    if (head.next == &head) return;
+
+    // Detach the whole slot first; insert() may put timers back into it
+    WebSocketTimer* t = head.next;
+    head.prev->next = nullptr;
+    head.prev = head.next = &head;
+
+    while (t) {
+        WebSocketTimer* next = t->next;
+        insert(*t);
+        t = next;
+    }
+}
+
+void WebSocketTimerWheel::expire(unsigned index) {
+    WebSocketTimer& head = slots[0][index];
+    if (head.next == &head) return;
+
+    // Move the slot to a local list: callbacks may schedule or cancel
+    // any timer, including ones due in this same tick
+    WebSocketTimer due;
+    due.next = head.next;
+    due.prev = head.prev;
+    due.next->prev = &due;
+    due.prev->next = &due;
+    head.prev = head.next = &head;
+
+    while (due.next != &due) {
+        WebSocketTimer* t = due.next;
+        unlink(*t);
+        --count;
+        t->callback(t->arg);
+    }
+}
+
+void WebSocketTimerWheel::advance(uint64_t target) {
+    while (current < target) {
+        ++current;
+
+        // Higher levels first, so timers they hand down to a level
+        // that also turns over now are cascaded again in the same tick
+        unsigned top = 0;
+        while (top + 1 < LEVELS && (current & ((uint64_t(1) << (SLOT_BITS * (top + 1))) - 1)) == 0) {
+            ++top;
+        }
+        for (unsigned level = top; level > 0; --level) {
+            cascade(level, static_cast<unsigned>((current >> (SLOT_BITS * level)) & (SLOTS - 1)));
+        }
+
+        expire(static_cast<unsigned>(current & (SLOTS - 1)));
+
+        // Nothing left: jump instead of walking empty ticks
+        if (count == 0) {
+            current = target;
+            break;
+        }
+    }
+}
+
+uint64_t WebSocketTimerWheel::nextWake() const {
+    // Never sleep past the next cascade: it may bring timers due right after it
+    const uint64_t cascade_at = (current | (SLOTS - 1)) + 1;
+    for (uint64_t tick = current + 1; tick < cascade_at; ++tick) {
+        const WebSocketTimer& head = slots[0][tick & (SLOTS - 1)];
+        if (head.next != &head) return tick;
+    }
+    return cascade_at;
+}
+
+void WebSocketTimerWheel::arm() {
+    if (!tick_event) return;
+
+    if (count == 0) {
+        event_del(tick_event);
+        wake = 0;
+        return;
+    }
+
+    const uint64_t at = nextWake();
+    if (at == wake) return;
+    wake = at;
+
+    const auto due = origin + std::chrono::milliseconds(at * TICK_MS);
+    const auto now = std::chrono::steady_clock::now();
+    const int64_t us = due > now
+        ? std::chrono::duration_cast<std::chrono::microseconds>(due - now).count() : 0;
+
+    timeval tv;
+    tv.tv_sec = static_cast<long>(us / 1000000);
+    tv.tv_usec = static_cast<long>(us % 1000000);
+    evtimer_add(tick_event, &tv);
+}
+
+void WebSocketTimerWheel::tickCallback(evutil_socket_t /*fd*/, short /*events*/, void* arg) {
+    auto* self = static_cast<WebSocketTimerWheel*>(arg);
+    self->wake = 0;
+    self->advancing = true;
+    self->advance(self->nowTick());
+    self->advancing = false;
+    self->arm();
+}
@@ -0,0 +1,113 @@
+/*
+ *  WebSocketTimerWheel.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+#include <event2/event.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+class WebSocketTimerWheel;
+
+/**
+ * \brief A timer owned by its connection and driven by the loop's wheel.
+ *
+ * Nothing is allocated: the node links itself into a wheel slot while
+ * armed. The callback runs on the loop thread once per schedule().
+ */
+class WebSocketTimer {
+public:
+    using Callback = void (*)(void* arg);
+
+    WebSocketTimer() = default;
+    WebSocketTimer(Callback cb, void* arg) : callback(cb), arg(arg) {}
+
+    WebSocketTimer(const WebSocketTimer&) = delete;
+    WebSocketTimer& operator=(const WebSocketTimer&) = delete;
+
+    bool armed() const { return prev != nullptr; }
+
+private:
+    friend class WebSocketTimerWheel;
+
+    WebSocketTimer* prev = nullptr;   // null while not armed
+    WebSocketTimer* next = nullptr;
+    uint64_t expires = 0;             // wheel tick
+    Callback callback = nullptr;
+    void* arg = nullptr;
+};
+
+/**
+ * \brief Hierarchical timer wheel shared by every connection on a loop.
+ *
+ * Four levels of 64 slots at a 10 ms tick cover about 46 hours; longer
+ * timers wait in the last slot and are placed again as it comes round.
+ * Arming, re-arming and cancelling are O(1) list splices, so a ping
+ * interval or a connect timeout costs no libevent heap operation.
+ *
+ * One libevent timer drives the wheel, and only while something is armed.
+ * It wakes for the next occupied slot of the first level, or otherwise
+ * for the next cascade, so far-off timers alone cost a wakeup every 640 ms.
+ * Timers never fire early and at most one tick late; ticks missed while
+ * the loop was busy run on the next wakeup.
+ *
+ * Loop thread only.
+ */
+class WebSocketTimerWheel {
+public:
+    static const unsigned TICK_MS = 10;
+
+    explicit WebSocketTimerWheel(event_base* base);
+    ~WebSocketTimerWheel();
+
+    WebSocketTimerWheel(const WebSocketTimerWheel&) = delete;
+    WebSocketTimerWheel& operator=(const WebSocketTimerWheel&) = delete;
+
+    /**
+     * \brief Fire timer after delay_ms; an armed timer is moved.
+     */
+    void schedule(WebSocketTimer& timer, uint64_t delay_ms);
+
+    /**
+     * \brief Disarm timer; a no-op when it is not armed.
+     */
+    void cancel(WebSocketTimer& timer);
+
+    /// Uniform in [0, range_ms], to spread periodic timers of many connections
+    uint64_t jitter(uint64_t range_ms);
+
+    /// Timers currently armed
+    size_t size() const { return count; }
+
+private:
+    static const unsigned SLOT_BITS = 6;
+    static const unsigned SLOTS = 1u << SLOT_BITS;
+    static const unsigned LEVELS = 4;
+
+    static void tickCallback(evutil_socket_t fd, short events, void* arg);
+
+    uint64_t elapsedUs() const;
+    uint64_t nowTick() const;
+    void insert(WebSocketTimer& timer);
+    void unlink(WebSocketTimer& timer);
+    void advance(uint64_t target);
+    void cascade(unsigned level, unsigned index);
+    void expire(unsigned index);
+    uint64_t nextWake() const;
+    void arm();
+
+    event* tick_event = nullptr;
+    std::chrono::steady_clock::time_point origin;
+    uint64_t current = 0;     // last tick processed
+    uint64_t wake = 0;        // tick tick_event is set for, 0 when idle
+    size_t count = 0;
+    bool advancing = false;   // inside tickCallback()
+
+    WebSocketTimer slots[LEVELS][SLOTS];   // list heads
+    std::minstd_rand rng;
+};
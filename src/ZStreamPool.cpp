@@ -0,0 +1,173 @@
+/*
+ *  ZStreamPool.cpp
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "ZStreamPool.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+
+#include "Logger.h"
+
+namespace {
+
+// zlib asks for the same handful of sizes per parameter set (state, window,
+// hash chains, pending buffer), so exact size classes recycle well.
+class ZSlab {
+public:
+    static ZSlab& instance() {
+        static ZSlab* slab = new ZSlab;   // never destroyed: streams may outlive static teardown
+        return *slab;
+    }
+
+    void* alloc(size_t bytes) {
+        const size_t cls = (bytes + ALIGN - 1) & ~(ALIGN - 1);
+        void* block = nullptr;
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            auto it = free_lists.find(cls);
+            if (it != free_lists.end() && !it->second.empty()) {
+                block = it->second.back();
+                it->second.pop_back();
+                cached -= cls;
+            }
+        }
+        if (!block) {
+            block = std::malloc(HEADER + cls);
+            if (!block) return nullptr;
+        }
+        *static_cast<size_t*>(block) = cls;
+        return static_cast<char*>(block) + HEADER;
+    }
+
+    void release(void* ptr) {
+        void* block = static_cast<char*>(ptr) - HEADER;
+        const size_t cls = *static_cast<size_t*>(block);
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            if (cached + cls <= MAX_CACHED_BYTES) {
+                free_lists[cls].push_back(block);
+                cached += cls;
+                return;
+            }
+        }
+        std::free(block);
+    }
+
+private:
+    static const size_t ALIGN = 64;
+    static const size_t HEADER = 16;                     // keeps malloc's 16-byte alignment
+    static const size_t MAX_CACHED_BYTES = 32u << 20;
+
+    std::mutex mtx;
+    std::unordered_map<size_t, std::vector<void*>> free_lists;
+    size_t cached = 0;
+};
+
+voidpf slabAlloc(voidpf, uInt items, uInt size) {
+    void* p = ZSlab::instance().alloc(static_cast<size_t>(items) * size);
+    return p ? p : Z_NULL;
+}
+
+void slabFree(voidpf, voidpf address) {
+    if (address) ZSlab::instance().release(address);
+}
+
+z_stream* newStream() {
+    z_stream* zs = new z_stream;
+    std::memset(zs, 0, sizeof(*zs));
+    zs->zalloc = slabAlloc;
+    zs->zfree = slabFree;
+    zs->opaque = Z_NULL;
+    return zs;
+}
+
+} // namespace
+
+ZStreamPool& ZStreamPool::instance() {
+    static ZStreamPool* pool = new ZStreamPool;   // never destroyed, like the slab
+    return *pool;
+}
+
+z_stream* ZStreamPool::acquireDeflate(const DeflateParams& p) {
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        auto it = idle_deflate.find(p);
+        if (it != idle_deflate.end() && !it->second.empty()) {
+            z_stream* zs = it->second.back();
+            it->second.pop_back();
+            return zs;
+        }
+    }
+
+    z_stream* zs = newStream();
+    int ret = deflateInit2(zs, p.level, Z_DEFLATED, -p.window_bits, p.mem_level, p.strategy);
+    if (ret != Z_OK) {
+        log_error("Failed to initialize pooled deflate: %d", ret);
+        delete zs;
+        return nullptr;
+    }
+    return zs;
+}
+
+void ZStreamPool::releaseDeflate(const DeflateParams& p, z_stream* zs) {
+    if (!zs) return;
+    deflateReset(zs);
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        std::vector<z_stream*>& idle = idle_deflate[p];
+        if (idle.size() < MAX_IDLE_PER_KEY) {
+            idle.push_back(zs);
+            return;
+        }
+    }
+    deflateEnd(zs);
+    delete zs;
+}
+
+z_stream* ZStreamPool::acquireInflate(int window_bits) {
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        auto it = idle_inflate.find(window_bits);
+        if (it != idle_inflate.end() && !it->second.empty()) {
+            z_stream* zs = it->second.back();
+            it->second.pop_back();
+            return zs;
+        }
+    }
+
+    z_stream* zs = newStream();
+    int ret = inflateInit2(zs, -window_bits);
+    if (ret != Z_OK) {
+        log_error("Failed to initialize pooled inflate: %d", ret);
+        delete zs;
+        return nullptr;
+    }
+    return zs;
+}
+
+void ZStreamPool::releaseInflate(int window_bits, z_stream* zs) {
+    if (!zs) return;
+    inflateReset(zs);
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        std::vector<z_stream*>& idle = idle_inflate[window_bits];
+        if (idle.size() < MAX_IDLE_PER_KEY) {
+            idle.push_back(zs);
+            return;
+        }
+    }
+    inflateEnd(zs);
+    delete zs;
+}
+
+size_t ZStreamPool::idleStreams() const {
+    std::lock_guard<std::mutex> lk(mtx);
+    size_t n = 0;
+    for (const auto& kv : idle_deflate) n += kv.second.size();
+    for (const auto& kv : idle_inflate) n += kv.second.size();
+    return n;
+}
@@ -0,0 +1,71 @@
+/*
+ *  ZStreamPool.h
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+#include <zlib.h>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+/**
+ * \brief Process-wide cache of reset zlib streams.
+ *
+ * Connections that negotiated no_context_takeover for a direction don't
+ * need a stream between messages, so they borrow one per message and hand
+ * it back afterwards; thousands of idle sockets then hold no zlib state.
+ * Streams are keyed by their init parameters and always come out reset.
+ *
+ * Streams created here allocate through a size-class slab (zalloc/zfree
+ * hooks), so the window/hash buffers of retired streams are recycled
+ * instead of going back to malloc.
+ *
+ * Thread-safe; a stream itself belongs to one borrower at a time.
+ */
+class ZStreamPool {
+public:
+    struct DeflateParams {
+        int level;
+        int window_bits;
+        int mem_level;
+        int strategy;
+
+        bool operator<(const DeflateParams& o) const {
+            return std::tie(level, window_bits, mem_level, strategy) <
+                   std::tie(o.level, o.window_bits, o.mem_level, o.strategy);
+        }
+    };
+
+    static ZStreamPool& instance();
+
+    /**
+     * \brief Borrow a reset raw-deflate stream, creating one if none is idle.
+     * \return nullptr if zlib initialization fails.
+     */
+    z_stream* acquireDeflate(const DeflateParams& p);
+    void releaseDeflate(const DeflateParams& p, z_stream* zs);
+
+    /**
+     * \brief Borrow a reset raw-inflate stream for a window of 2^window_bits.
+     * \return nullptr if zlib initialization fails.
+     */
+    z_stream* acquireInflate(int window_bits);
+    void releaseInflate(int window_bits, z_stream* zs);
+
+    size_t idleStreams() const;
+
+private:
+    ZStreamPool() = default;
+    ZStreamPool(const ZStreamPool&) = delete;
+    ZStreamPool& operator=(const ZStreamPool&) = delete;
+
+    static const size_t MAX_IDLE_PER_KEY = 64;
+
+    mutable std::mutex mtx;
+    std::map<DeflateParams, std::vector<z_stream*>> idle_deflate;
+    std::map<int, std::vector<z_stream*>> idle_inflate;
+};
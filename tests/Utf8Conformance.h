@@ -0,0 +1,23 @@
+/*
+ *  Utf8Conformance.h
+ *  Autobahn 6.x UTF-8 vectors, shared by the ctest check and libwsc_bench
+ *
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * \brief Run every case against the active kernel and the scalar reference.
+ *
+ * Each case is padded across vector block boundaries and split at every
+ * byte; random mixes are compared with the reference. Failures are
+ * printed to stderr.
+ */
+bool utf8CheckConformance();
+
+/// Number of Autobahn cases checked
+size_t utf8ConformanceCases();
@@ -0,0 +1,21 @@
+/*
+ *  test_utf8.cpp
+ *  Fails when a UTF-8 kernel disagrees with Autobahn 6.x or the scalar path
+ *
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "Utf8Conformance.h"
+#include "Utf8Validator.h"
+
+#include <cstdio>
+
+int main() {
+    if (!utf8CheckConformance()) {
+        fprintf(stderr, "utf8 (%s): conformance check failed\n", Utf8Validator::implementation());
+        return 1;
+    }
+    fprintf(stderr, "utf8 (%s): %zu Autobahn 6.x cases ok\n", Utf8Validator::implementation(), utf8ConformanceCases());
+    return 0;
+}
@@ -0,0 +1,193 @@
+/*
+ *  utf8_conformance.cpp
+ *  Author: Milan M.
+ *  Copyright (c) 2025 AMSOFTSWITCH LTD. All rights reserved.
+ */
+
+#include "Utf8Conformance.h"
+#include "Utf8Validator.h"
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Utf8Case {
+    const char* id;      // Autobahn TestSuite case (section 6)
+    const char* bytes;
+    bool valid;
+};
+
+// Autobahn 6.x UTF-8 handling vectors
+const Utf8Case kCases[] = {
+    { "6.1.1",  "", true },
+    { "6.2.1",  "Hello-\xc2\xb5@\xc3\x9f\xc3\xb6\xc3\xa4\xc3\xbc\xc3\xa0\xc3\xa1-UTF-8!!", true },
+    { "6.3.1",  "\xce\xba\xe1\xbd\xb9\xcf\x83\xce\xbc\xce\xb5", true },
+    { "6.3.2",  "\xce\xba\xe1\xbd\xb9\xcf\x83\xce\xbc\xce\xb5\xed\xa0\x80\x65\x64\x69\x74\x65\x64", false },
+    { "6.4.1",  "\xce\xba\xe1\xbd\xb9\xcf\x83\xce\xbc\xce\xb5\xf4\x90\x80\x80\x65\x64\x69\x74\x65\x64", false },
+    { "6.4.2",  "\xce\xba\xe1\xbd\xb9\xcf\x83\xce\xbc\xce\xb5\xf4\x90\x80\x80", false },
+    { "6.6.2",  "\xce", false },
+    { "6.6.4",  "\xce\xba\xe1", false },
+    { "6.6.5",  "\xce\xba\xe1\xbd", false },
+    { "6.7.1",  "\x00", true },
+    { "6.7.2",  "\xc2\x80", true },
+    { "6.7.3",  "\xe0\xa0\x80", true },
+    { "6.7.4",  "\xf0\x90\x80\x80", true },
+    { "6.8.1",  "\xf8\x88\x80\x80\x80", false },
+    { "6.8.2",  "\xfc\x84\x80\x80\x80\x80", false },
+    { "6.9.1",  "\x7f", true },
+    { "6.9.2",  "\xdf\xbf", true },
+    { "6.9.3",  "\xef\xbf\xbf", true },
+    { "6.9.4",  "\xf4\x8f\xbf\xbf", true },
+    { "6.10.1", "\xf7\xbf\xbf\xbf", false },
+    { "6.10.2", "\xfb\xbf\xbf\xbf\xbf", false },
+    { "6.10.3", "\xfd\xbf\xbf\xbf\xbf\xbf", false },
+    { "6.11.1", "\xed\x9f\xbf", true },
+    { "6.11.2", "\xee\x80\x80", true },
+    { "6.11.3", "\xef\xbf\xbd", true },
+    { "6.11.4", "\xf4\x8f\xbf\xbf", true },
+    { "6.11.5", "\xf4\x90\x80\x80", false },
+    { "6.12.1", "\x80", false },
+    { "6.12.2", "\xbf", false },
+    { "6.12.3", "\x80\xbf", false },
+    { "6.12.4", "\x80\xbf\x80", false },
+    { "6.12.8", "\x80\x81\x82\x83\x84\x85\x86\x87\x88\x89\x8a\x8b\x8c\x8d\x8e\x8f"
+                "\x90\x91\x92\x93\x94\x95\x96\x97\x98\x99\x9a\x9b\x9c\x9d\x9e\x9f"
+                "\xa0\xa1\xa2\xa3\xa4\xa5\xa6\xa7\xa8\xa9\xaa\xab\xac\xad\xae\xaf"
+                "\xb0\xb1\xb2\xb3\xb4\xb5\xb6\xb7\xb8\xb9\xba\xbb\xbc\xbd\xbe", false },
+    { "6.13.1", "\xc0\x20\xc1\x20\xc2\x20\xc3\x20\xc4\x20\xc5\x20\xc6\x20\xc7\x20", false },
+    { "6.13.2", "\xe0\x20\xe1\x20\xe2\x20\xe3\x20\xe4\x20\xe5\x20\xe6\x20\xe7\x20", false },
+    { "6.13.3", "\xf0\x20\xf1\x20\xf2\x20\xf3\x20\xf4\x20\xf5\x20\xf6\x20", false },
+    { "6.13.4", "\xf8\x20\xf9\x20\xfa\x20\xfb\x20", false },
+    { "6.13.5", "\xfc\x20\xfd\x20", false },
+    { "6.14.1", "\xc0", false },
+    { "6.14.2", "\xe0\x80", false },
+    { "6.14.3", "\xf0\x80\x80", false },
+    { "6.14.4", "\xf8\x80\x80\x80", false },
+    { "6.14.5", "\xfc\x80\x80\x80\x80", false },
+    { "6.14.6", "\xdf", false },
+    { "6.14.7", "\xef\xbf", false },
+    { "6.14.8", "\xf7\xbf\xbf", false },
+    { "6.14.9", "\xfb\xbf\xbf\xbf", false },
+    { "6.14.10","\xfd\xbf\xbf\xbf\xbf", false },
+    { "6.15.1", "\xc0\xe0\x80\xf0\x80\x80\xf8\x80\x80\x80\xfc\x80\x80\x80\x80"
+                "\xdf\xef\xbf\xf7\xbf\xbf\xfb\xbf\xbf\xbf\xfd\xbf\xbf\xbf\xbf", false },
+    { "6.16.1", "\xfe", false },
+    { "6.16.2", "\xff", false },
+    { "6.16.3", "\xfe\xfe\xff\xff", false },
+    { "6.17.1", "\xc0\xaf", false },
+    { "6.17.2", "\xe0\x80\xaf", false },
+    { "6.17.3", "\xf0\x80\x80\xaf", false },
+    { "6.17.4", "\xf8\x80\x80\x80\xaf", false },
+    { "6.17.5", "\xfc\x80\x80\x80\x80\xaf", false },
+    { "6.18.1", "\xc1\xbf", false },
+    { "6.18.2", "\xe0\x9f\xbf", false },
+    { "6.18.3", "\xf0\x8f\xbf\xbf", false },
+    { "6.18.4", "\xf8\x87\xbf\xbf\xbf", false },
+    { "6.18.5", "\xfc\x83\xbf\xbf\xbf\xbf", false },
+    { "6.19.1", "\xc0\x80", false },
+    { "6.19.2", "\xe0\x80\x80", false },
+    { "6.19.3", "\xf0\x80\x80\x80", false },
+    { "6.19.4", "\xf8\x80\x80\x80\x80", false },
+    { "6.19.5", "\xfc\x80\x80\x80\x80\x80", false },
+    { "6.20.1", "\xed\xa0\x80", false },
+    { "6.20.2", "\xed\xad\xbf", false },
+    { "6.20.3", "\xed\xae\x80", false },
+    { "6.20.4", "\xed\xaf\xbf", false },
+    { "6.20.5", "\xed\xb0\x80", false },
+    { "6.20.6", "\xed\xbe\x80", false },
+    { "6.20.7", "\xed\xbf\xbf", false },
+    { "6.21.1", "\xed\xa0\x80\xed\xb0\x80", false },
+    { "6.21.8", "\xed\xaf\xbf\xed\xbf\xbf", false },
+    { "6.22.1", "\xef\xbf\xbe", true },
+    { "6.22.2", "\xef\xbf\xbf", true },
+    { "6.22.3", "\xef\xb7\x90", true },
+    { "6.22.5", "\xf0\x9f\xbf\xbe", true },
+    { "6.22.34","\xf4\x8f\xbf\xbf", true },
+    { "6.23.1", "\xef\xbf\xbd", true },
+};
+
+size_t caseLength(const Utf8Case& c) {
+    // 6.7.1 is a single NUL byte
+    return std::strcmp(c.id, "6.7.1") == 0 ? 1 : std::strlen(c.bytes);
+}
+
+bool validateWhole(const std::vector<uint8_t>& v) {
+    Utf8Validator u;
+    return u.validateChunk(v.data(), v.size()) && u.validateFinal();
+}
+
+bool validateSplit(const std::vector<uint8_t>& v, size_t cut) {
+    Utf8Validator u;
+    return u.validateChunk(v.data(), cut) &&
+           u.validateChunk(v.data() + cut, v.size() - cut) &&
+           u.validateFinal();
+}
+
+bool validateReference(const std::vector<uint8_t>& v) {
+    Utf8Validator u;
+    return u.validateChunkScalar(v.data(), v.size()) && u.validateFinal();
+}
+
+} // namespace
+
+// Every case, padded with ASCII to cross vector block boundaries, and split
+// at every byte into two chunks to exercise the carried-over state.
+bool utf8CheckConformance() {
+    size_t failures = 0;
+
+    for (const Utf8Case& c : kCases) {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(c.bytes);
+        const size_t len = caseLength(c);
+
+        for (size_t pad = 0; pad <= 70; ++pad) {
+            std::vector<uint8_t> v(pad, 'a');
+            v.insert(v.end(), p, p + len);
+            v.insert(v.end(), pad % 7, 'z');
+
+            bool ok = validateWhole(v) == c.valid && validateReference(v) == c.valid;
+            for (size_t cut = 0; ok && cut <= v.size(); ++cut) {
+                ok = validateSplit(v, cut) == c.valid;
+            }
+            if (!ok) {
+                fprintf(stderr, "utf8: case %s failed (pad %zu, expected %s)\n",
+                        c.id, pad, c.valid ? "valid" : "invalid");
+                ++failures;
+                break;
+            }
+        }
+    }
+
+    // Random mixes of valid sequences and garbage, checked against the reference
+    std::mt19937 rng(12345);
+    const char* pieces[] = { "a", "{\"k\":1}", "\xc2\xb5", "\xe2\x82\xac", "\xf0\x9f\x98\x80",
+                             "\xed\x9f\xbf", "\xf4\x8f\xbf\xbf" };
+    for (int iter = 0; iter < 20000; ++iter) {
+        std::vector<uint8_t> v;
+        const size_t n = rng() % 200;
+        while (v.size() < n) {
+            if (rng() % 50 == 0) {
+                v.push_back(static_cast<uint8_t>(rng()));
+            } else {
+                const char* s = pieces[rng() % (sizeof(pieces) / sizeof(pieces[0]))];
+                v.insert(v.end(), s, s + std::strlen(s));
+            }
+        }
+        const bool expect = validateReference(v);
+        const size_t cut = v.empty() ? 0 : rng() % (v.size() + 1);
+        if (validateWhole(v) != expect || validateSplit(v, cut) != expect ||
+            Utf8Validator::validate(v.data(), v.size()) != expect) {
+            fprintf(stderr, "utf8: random case %d disagrees with reference\n", iter);
+            ++failures;
+            break;
+        }
+    }
+
+    return failures == 0;
+}
+
+size_t utf8ConformanceCases() {
+    return sizeof(kCases) / sizeof(kCases[0]);
+}